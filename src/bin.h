@@ -0,0 +1,286 @@
+#pragma once
+
+/**
+* @file bin.h
+* @brief Compact binary format of inference results, which is an alternative to JSON outputs.
+* @details
+*   A binary output is a sequence of length-prefixed records following a file-header.
+*   All integers and floating point numbers are little-endian regardless of the host byte order.
+*
+*       FILE    := "DAVB" VERSION:u32 RECORD*
+*       RECORD  := TAG:u32 LENGTH:u64 PAYLOAD[LENGTH]
+*       COLUMN  := SIZE:u32 VALUE[SIZE]
+*
+*   The records are following:
+*     - "HEAD" : VERSION-OF-DAVID:str EXECUTED:str KERNEL:str
+*                where KERNEL is JSON text of the kernel and the knowledge-base,
+*                the same as the header of JSON outputs.
+*     - "PROB" : The result of a problem. Its payload consists of scalar fields and tables,
+*                each of which is a record whose payload is a sequence of COLUMNs.
+*     - "END " : NUM-PROBLEMS:u32
+*
+*   Readers must skip records and tables with unknown tags,
+*   so that new tables can be added without breaking old readers.
+*   Strings are referred by the index in the string table of each problem.
+*   Sets of variable length, such as arguments of atoms, are stored
+*   as a column of offsets (whose size is the number of rows plus one) and a column of values.
+*
+*   Names of ILP variables and constraints are stored as descriptors of ilp::name_t,
+*   which are made into strings by name2str() on reading.
+*   Only names given as strings are stored in the string table.
+*/
+
+#include <cstdint>
+#include <algorithm>
+
+#include "./util.h"
+
+
+namespace dav
+{
+
+namespace bin
+{
+
+/** Makes the tag of a record from four characters. */
+constexpr uint32_t make_tag(const char *s)
+{
+    return
+        static_cast<uint32_t>(static_cast<unsigned char>(s[0])) |
+        static_cast<uint32_t>(static_cast<unsigned char>(s[1])) << 8 |
+        static_cast<uint32_t>(static_cast<unsigned char>(s[2])) << 16 |
+        static_cast<uint32_t>(static_cast<unsigned char>(s[3])) << 24;
+}
+
+/** Returns whether the host stores numbers in little-endian. */
+inline bool is_little_endian_host()
+{
+    const uint16_t x = 1;
+    return *reinterpret_cast<const uint8_t*>(&x) == 1;
+}
+
+/**
+* @brief Converts a value between the host byte order and little-endian in place.
+* @details This does nothing on little-endian hosts.
+*/
+template <class T> void convert_endian(T *x)
+{
+    if (is_little_endian_host()) return;
+
+    char *p = reinterpret_cast<char*>(x);
+    std::reverse(p, p + sizeof(T));
+}
+
+
+const char MAGIC[] = "DAVB";
+const uint32_t VERSION = 2;
+
+/** String-ID which refers to no string. */
+const uint32_t NO_STRING = 0xffffffff;
+
+const uint32_t TAG_HEADER = make_tag("HEAD");
+const uint32_t TAG_PROBLEM = make_tag("PROB");
+const uint32_t TAG_END = make_tag("END ");
+
+const uint32_t TAG_STRINGS = make_tag("STR ");
+const uint32_t TAG_NODES = make_tag("NODE");
+const uint32_t TAG_HYPERNODES = make_tag("HYPN");
+const uint32_t TAG_EDGES = make_tag("EDGE");
+const uint32_t TAG_EXCLUSIONS = make_tag("EXCL");
+const uint32_t TAG_VARIABLES = make_tag("VARS");
+const uint32_t TAG_CONSTRAINTS = make_tag("CONS");
+const uint32_t TAG_SOLUTIONS = make_tag("SOLS");
+
+
+/** Columnar table of atoms. */
+struct atoms_t
+{
+    size_t size() const { return predicates.size(); }
+
+    std::vector<uint32_t> predicates; /// String-IDs of predicates, such as "foo/2".
+    std::vector<uint8_t>  nafs;       /// Whether each atom is negated with NAF.
+    std::vector<uint32_t> offsets;    /// Arguments of the i-th atom are terms[offsets[i]] ~ terms[offsets[i+1] - 1].
+    std::vector<uint32_t> terms;      /// String-IDs of arguments.
+};
+
+
+/** Columnar table of names of ILP variables or constraints. */
+struct names_t
+{
+    size_t size() const { return kinds.size(); }
+
+    std::vector<uint8_t>  kinds;   /// Values of ilp::name_kind_e.
+    std::vector<uint32_t> strings; /// String-IDs of names given as strings, otherwise NO_STRING.
+
+    /**
+    * References of the i-th name are refs[3i] ~ refs[3i + 2], which are indices in the tables of this problem.
+    * For names referring to terms, such as ilp::NAME_TRANSITIVITY, these are String-IDs of the terms.
+    */
+    std::vector<int32_t> refs;
+};
+
+
+/** The result of inference on a problem, which is stored in "PROB" records. */
+struct result_t
+{
+    struct nodes_t
+    {
+        size_t size() const { return types.size(); }
+
+        atoms_t atoms;
+        std::vector<uint8_t> types; /// Values of pg::node_type_e.
+        std::vector<int32_t> depths;
+        std::vector<int32_t> masters;
+        std::vector<uint32_t> params; /// String-IDs of parameters.
+    };
+
+    struct hypernodes_t
+    {
+        size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+        std::vector<uint32_t> offsets;
+        std::vector<int32_t> nodes;
+    };
+
+    struct edges_t
+    {
+        size_t size() const { return types.size(); }
+
+        std::vector<uint8_t> types; /// Values of pg::edge_type_e.
+        std::vector<int32_t> tails;
+        std::vector<int32_t> heads;
+        std::vector<uint64_t> rules; /// Rule-IDs. Zero means no rule.
+        std::vector<uint32_t> offsets;
+        atoms_t conditions;
+    };
+
+    struct exclusions_t
+    {
+        size_t size() const { return types.size(); }
+
+        std::vector<uint8_t> types; /// Values of pg::exclusion_type_e.
+        std::vector<uint64_t> rules; /// Rule-IDs. Zero means no rule.
+        std::vector<uint32_t> offsets;
+        atoms_t atoms;
+    };
+
+    struct variables_t
+    {
+        size_t size() const { return names.size(); }
+
+        names_t names;
+        std::vector<double> coefficients;
+        std::vector<double> perturbations;
+        std::vector<uint8_t> is_const;
+        std::vector<double> const_values;
+    };
+
+    struct constraints_t
+    {
+        size_t size() const { return names.size(); }
+
+        names_t names;
+        std::vector<uint8_t> operators; /// Values of ilp::constraint_operator_e.
+        std::vector<double> lower_bounds;
+        std::vector<double> upper_bounds;
+        std::vector<uint8_t> lazy;
+        std::vector<uint32_t> offsets;
+        std::vector<int32_t> variables;
+        std::vector<double> coefficients;
+    };
+
+    struct solutions_t
+    {
+        size_t size() const { return types.size(); }
+
+        std::vector<uint8_t> types; /// Values of ilp::solution_type_e.
+        std::vector<double> objectives;
+        std::vector<double> values; /// Values of the i-th solution are values[i * num-variables] ~.
+    };
+
+    void clear();
+
+    int32_t index;
+    string_t name;
+
+    float time_lhs, time_exclusion, time_cnv, time_sol, time_all;
+    uint8_t do_maximize, do_economize;
+
+    std::vector<string_t> strings;
+
+    nodes_t nodes;
+    hypernodes_t hypernodes;
+    edges_t edges;
+    exclusions_t exclusions;
+    variables_t variables;
+    constraints_t constraints;
+    solutions_t solutions;
+};
+
+
+/** Class to write the results of the kernel in the binary format. */
+class writer_t
+{
+public:
+    writer_t(const filepath_t &path);
+
+    writer_t(const writer_t&) = delete;
+    writer_t& operator=(const writer_t&) = delete;
+
+    void write_header();
+    void write_content();
+    void write_footer();
+
+private:
+    void write_record(uint32_t tag, const std::string &payload);
+
+    /** Writes a "PROB" record, whose tables are streamed into m_os without buffering. */
+    void write_problem(const result_t &r);
+
+    std::unique_ptr<std::ostream> m_os;
+    uint32_t m_num; /// The number of problems written.
+};
+
+
+/** Class to read binary outputs by streaming. */
+class reader_t
+{
+public:
+    /** Reads the file-header and "HEAD" record from given stream. */
+    reader_t(std::istream *is);
+
+    /**
+    * @brief Reads the next result.
+    * @return False if there is no more result, otherwise true.
+    */
+    bool next(result_t *out);
+
+    const string_t& version() const { return m_version; }
+    const string_t& executed() const { return m_executed; }
+
+    /** JSON text of the kernel and the knowledge-base. */
+    const string_t& kernel() const { return m_kernel; }
+
+private:
+    bool read_record(uint32_t *tag, std::vector<char> *payload);
+
+    std::istream *m_is;
+    uint32_t m_format; /// Version of the format of the input.
+    string_t m_version, m_executed, m_kernel;
+    std::vector<char> m_payload;
+};
+
+
+/** Returns the string-expression of the i-th atom in given table, such as "foo(x, y)". */
+string_t atom2str(const result_t &r, const atoms_t &atoms, size_t i);
+
+/** Returns the i-th name in given table, which is the same as ilp::name_t::string(). */
+string_t name2str(const result_t &r, const names_t &names, size_t i);
+
+/** Converts a binary output read from `in` into JSON and writes it to `os`. */
+void convert_to_json(reader_t *in, std::ostream *os);
+
+
+}
+
+}
@@ -0,0 +1,189 @@
+#include "./bin.h"
+#include "./json.h"
+
+namespace dav
+{
+
+namespace bin
+{
+
+
+namespace
+{
+/** Converter to write JSON text as it is. */
+class raw2json_t : public json::converter_t<string_t>
+{
+public:
+    virtual void operator()(const string_t &x, std::ostream *os) const override
+    {
+        (*os) << x;
+    }
+};
+
+
+void write_result(const result_t &r, json::object_writer_t &wr)
+{
+    wr.write_field<int>("index", r.index);
+    wr.write_field<string_t>("name", r.name);
+
+    {
+        auto &&wr2 = wr.make_object_field_writer("elapsed-time", false);
+        wr2.write_field<time_t>("lhs", r.time_lhs);
+        wr2.write_field<time_t>("lhs-exclusion", r.time_exclusion);
+        wr2.write_field<time_t>("cnv", r.time_cnv);
+        wr2.write_field<time_t>("sol", r.time_sol);
+        wr2.write_field<time_t>("all", r.time_all);
+    }
+
+    wr.begin_object_array_field("nodes");
+    for (size_t i = 0; i < r.nodes.size(); ++i)
+    {
+        auto &&wr2 = wr.make_object_array_element_writer(true);
+        wr2.write_field<int>("index", i);
+        wr2.write_field<string_t>("type", pg::type2str(static_cast<pg::node_type_e>(r.nodes.types[i])));
+        wr2.write_field<string_t>("atom", atom2str(r, r.nodes.atoms, i));
+        wr2.write_field<int>("depth", r.nodes.depths[i]);
+        wr2.write_field<int>("master", r.nodes.masters[i]);
+    }
+    wr.end_object_array_field();
+
+    wr.begin_object_array_field("hypernodes");
+    for (size_t i = 0; i < r.hypernodes.size(); ++i)
+    {
+        const auto &hns = r.hypernodes;
+        auto &&wr2 = wr.make_object_array_element_writer(true);
+        wr2.write_field<int>("index", i);
+        wr2.write_array_field<int>(
+            "nodes", hns.nodes.begin() + hns.offsets[i], hns.nodes.begin() + hns.offsets[i + 1], true);
+    }
+    wr.end_object_array_field();
+
+    wr.begin_object_array_field("edges");
+    for (size_t i = 0; i < r.edges.size(); ++i)
+    {
+        const auto &edges = r.edges;
+        auto &&wr2 = wr.make_object_array_element_writer(true);
+        wr2.write_field<int>("index", i);
+        wr2.write_field<string_t>("type", pg::type2str(static_cast<pg::edge_type_e>(edges.types[i])));
+        if (edges.rules[i] != INVALID_RULE_ID)
+            wr2.write_field<int>("rule", static_cast<int>(edges.rules[i]));
+        wr2.write_field<int>("tail", edges.tails[i]);
+        wr2.write_field<int>("head", edges.heads[i]);
+
+        std::vector<string_t> conds;
+        for (uint32_t j = edges.offsets[i]; j < edges.offsets[i + 1]; ++j)
+            conds.push_back(atom2str(r, edges.conditions, j));
+        wr2.write_array_field<string_t>("conds", conds.begin(), conds.end(), true);
+    }
+    wr.end_object_array_field();
+
+    wr.begin_object_array_field("exclusions");
+    for (size_t i = 0; i < r.exclusions.size(); ++i)
+    {
+        const auto &excs = r.exclusions;
+        auto &&wr2 = wr.make_object_array_element_writer(true);
+        wr2.write_field<int>("index", i);
+        wr2.write_field<string_t>("type", pg::type2str(static_cast<pg::exclusion_type_e>(excs.types[i])));
+
+        std::vector<string_t> atoms;
+        for (uint32_t j = excs.offsets[i]; j < excs.offsets[i + 1]; ++j)
+            atoms.push_back(atom2str(r, excs.atoms, j));
+        wr2.write_array_field<string_t>("atoms", atoms.begin(), atoms.end(), true);
+
+        if (excs.rules[i] != INVALID_RULE_ID)
+            wr2.write_field<int>("rid", static_cast<int>(excs.rules[i]));
+    }
+    wr.end_object_array_field();
+
+    wr.write_field<bool>("maximize", r.do_maximize != 0);
+    wr.write_field<bool>("economize", r.do_economize != 0);
+
+    wr.begin_object_array_field("variables");
+    for (size_t i = 0; i < r.variables.size(); ++i)
+    {
+        const auto &vars = r.variables;
+        auto &&wr2 = wr.make_object_array_element_writer(true);
+        wr2.write_field<int>("index", i);
+        wr2.write_field<string_t>("name", name2str(r, vars.names, i));
+        wr2.write_field<double>("coefficient", vars.coefficients[i]);
+        wr2.write_field<double>("perturbation", vars.perturbations[i]);
+        if (vars.is_const[i])
+            wr2.write_field<double>("fixed", vars.const_values[i]);
+    }
+    wr.end_object_array_field();
+
+    wr.begin_object_array_field("constraints");
+    for (size_t i = 0; i < r.constraints.size(); ++i)
+    {
+        const auto &cons = r.constraints;
+        auto &&wr2 = wr.make_object_array_element_writer(true);
+        wr2.write_field<int>("index", i);
+        wr2.write_field<string_t>("name", name2str(r, cons.names, i));
+
+        std::vector<string_t> terms;
+        for (uint32_t j = cons.offsets[i]; j < cons.offsets[i + 1]; ++j)
+            terms.push_back(format("%lf*[%d]", cons.coefficients[j], cons.variables[j]));
+        wr2.write_array_field<string_t>("terms", terms.begin(), terms.end(), true);
+
+        char range[128] = "";
+        switch (static_cast<ilp::constraint_operator_e>(cons.operators[i]))
+        {
+        case ilp::OPR_EQUAL:
+            std::snprintf(range, sizeof(range), "= %g", cons.lower_bounds[i]); break;
+        case ilp::OPR_LESS_EQ:
+            std::snprintf(range, sizeof(range), "<= %g", cons.lower_bounds[i]); break;
+        case ilp::OPR_GREATER_EQ:
+            std::snprintf(range, sizeof(range), ">= %g", cons.lower_bounds[i]); break;
+        case ilp::OPR_RANGE:
+            std::snprintf(range, sizeof(range), "%g ~ %g", cons.lower_bounds[i], cons.upper_bounds[i]); break;
+        default: break;
+        }
+        wr2.write_field<string_t>("range", range);
+        wr2.write_field<bool>("lazy", cons.lazy[i] != 0);
+    }
+    wr.end_object_array_field();
+
+    wr.begin_object_array_field("solutions");
+    for (size_t i = 0; i < r.solutions.size(); ++i)
+    {
+        const auto &sols = r.solutions;
+        size_t n = r.variables.size();
+        auto &&wr2 = wr.make_object_array_element_writer(false);
+        wr2.write_field<string_t>("state", ilp::type2str(static_cast<ilp::solution_type_e>(sols.types[i])));
+        wr2.write_field<double>("objective", sols.objectives[i]);
+
+        std::vector<int> positives;
+        for (size_t j = 0; j < n; ++j)
+            if (sols.values.at(i * n + j) > 0.0)
+                positives.push_back(static_cast<int>(j));
+        wr2.write_array_field<int>("positive", positives.begin(), positives.end(), true);
+    }
+    wr.end_object_array_field();
+}
+}
+
+
+void convert_to_json(reader_t *in, std::ostream *os)
+{
+    raw2json_t raw;
+    json::object_writer_t wr(os, false);
+
+    wr.write_field<string_t>("output-type", "bin");
+    wr.write_field<string_t>("version", in->version());
+    wr.write_field<string_t>("executed", in->executed());
+    wr.write_field_with_converter<string_t>("header", in->kernel(), raw);
+
+    result_t r;
+    wr.begin_object_array_field("results");
+    while (in->next(&r))
+    {
+        auto &&wr2 = wr.make_object_array_element_writer(false);
+        write_result(r, wr2);
+    }
+    wr.end_object_array_field();
+}
+
+
+}
+
+}
@@ -0,0 +1,564 @@
+#include "./bin.h"
+#include "./ilp.h"
+
+namespace dav
+{
+
+namespace bin
+{
+
+
+namespace
+{
+/** Class to read values from the payload of a record, with checking its boundary. */
+class cursor_t
+{
+public:
+    cursor_t(const char *ptr, size_t len) : m_ptr(ptr), m_len(len), m_pos(0) {}
+
+    template <class T> T get()
+    {
+        T x;
+        read(&x, sizeof(T));
+        convert_endian(&x);
+        return x;
+    }
+
+    string_t get_string()
+    {
+        uint32_t n = get<uint32_t>();
+        assertion(n);
+        string_t out(std::string(m_ptr + m_pos, n));
+        m_pos += n;
+        return out;
+    }
+
+    template <class T> void get_column(std::vector<T> *out)
+    {
+        uint32_t n = get<uint32_t>();
+        assertion(sizeof(T) * n);
+        out->resize(n);
+        read(out->data(), sizeof(T) * n);
+
+        if (not is_little_endian_host())
+            for (auto &x : *out) convert_endian(&x);
+    }
+
+    void get_atoms(atoms_t *out)
+    {
+        get_column(&out->predicates);
+        get_column(&out->nafs);
+        get_column(&out->offsets);
+        get_column(&out->terms);
+    }
+
+    /**
+    * Reads names of ILP variables or constraints.
+    * In the format of version 1, names are only String-IDs.
+    */
+    void get_names(names_t *out, uint32_t format)
+    {
+        if (format < 2)
+        {
+            get_column(&out->strings);
+            out->kinds.assign(out->strings.size(), static_cast<uint8_t>(ilp::NAME_STRING));
+            out->refs.assign(3 * out->strings.size(), -1);
+            return;
+        }
+
+        get_column(&out->kinds);
+        get_column(&out->strings);
+        get_column(&out->refs);
+
+        if (out->strings.size() != out->kinds.size() or out->refs.size() != 3 * out->kinds.size())
+            throw exception_t("bin::reader_t: Broken table of names");
+    }
+
+    /** Returns the cursor for the payload of the next table and skips it. */
+    cursor_t get_table(uint32_t *tag)
+    {
+        *tag = get<uint32_t>();
+        uint64_t n = get<uint64_t>();
+        assertion(n);
+
+        cursor_t out(m_ptr + m_pos, n);
+        m_pos += n;
+        return out;
+    }
+
+    bool end() const { return m_pos >= m_len; }
+
+private:
+    void read(void *out, size_t n)
+    {
+        assertion(n);
+        std::memcpy(out, m_ptr + m_pos, n);
+        m_pos += n;
+    }
+
+    void assertion(size_t n) const
+    {
+        if (m_pos + n > m_len)
+            throw exception_t("bin::reader_t: Broken record");
+    }
+
+    const char *m_ptr;
+    size_t m_len, m_pos;
+};
+
+
+/** Throws an exception telling that given table of a record is broken. */
+void broken(const char *table)
+{
+    throw exception_t(format("bin::reader_t: Broken %s", table));
+}
+
+
+/** Checks that given column has `n` rows. */
+template <class T> void check_rows(const std::vector<T> &column, size_t n, const char *table)
+{
+    if (column.size() != n) broken(table);
+}
+
+
+/**
+* Checks a column of offsets of a table with `n` rows, which refers to a column with `m` values.
+* The column may be empty only if the table is empty, such as a table which was not written.
+*/
+void check_offsets(const std::vector<uint32_t> &offsets, size_t n, size_t m, const char *table)
+{
+    if (offsets.empty() and n == 0 and m == 0) return;
+    if (offsets.size() != n + 1 or offsets.back() != m) broken(table);
+
+    for (size_t i = 0; i + 1 < offsets.size(); ++i)
+        if (offsets[i] > offsets[i + 1]) broken(table);
+}
+
+
+/** Checks that every value in given column is an index in [lower, upper). */
+template <class T> void check_indices(
+    const std::vector<T> &column, int64_t lower, size_t upper, const char *table)
+{
+    for (const auto &x : column)
+        if (static_cast<int64_t>(x) < lower or static_cast<int64_t>(x) >= static_cast<int64_t>(upper))
+            broken(table);
+}
+
+
+void check_atoms(const atoms_t &atoms, const char *table)
+{
+    check_rows(atoms.nafs, atoms.size(), table);
+    check_offsets(atoms.offsets, atoms.size(), atoms.terms.size(), table);
+}
+
+
+/** Checks indices in names of ILP variables or constraints, in the same way as name2str(). */
+void check_names(const result_t &r, const names_t &names, const char *table)
+{
+    const int64_t n_str = r.strings.size();
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        const int32_t *refs = names.refs.data() + 3 * i;
+
+        // REFERENCES WHICH ARE DEREFERENCED BY name2str() MUST NOT BE -1.
+        auto check = [&](int64_t lower, size_t upper)
+        {
+            if (refs[0] < lower or refs[0] >= static_cast<int64_t>(upper)) broken(table);
+        };
+
+        switch (static_cast<ilp::name_kind_e>(names.kinds[i]))
+        {
+        case ilp::NAME_STRING:
+            if (names.strings[i] != NO_STRING and names.strings[i] >= n_str) broken(table);
+            break;
+        case ilp::NAME_ATOM:
+        case ilp::NAME_CWA:
+        case ilp::NAME_CLOSED:
+        case ilp::NAME_SATISFIED:
+        case ilp::NAME_NODE_COST:
+        case ilp::NAME_COST_PAYMENT_ATOM:
+            check(-1, r.nodes.size()); break;
+        case ilp::NAME_NODE:
+        case ilp::NAME_COST_PAYMENT:
+            check(0, r.nodes.size()); break;
+        case ilp::NAME_HYPERNODE:
+        case ilp::NAME_HYPERNODE_MEMBER:
+            check(-1, r.hypernodes.size()); break;
+        case ilp::NAME_EDGE:
+            check(0, r.edges.size()); break;
+        case ilp::NAME_EDGE_TAIL:
+        case ilp::NAME_EDGE_HEAD:
+        case ilp::NAME_EDGE_COND:
+        case ilp::NAME_EDGE_COST:
+            check(-1, r.edges.size()); break;
+        case ilp::NAME_EXCLUSION:
+        case ilp::NAME_VIOLATE_EXCLUSION:
+            check(-1, r.exclusions.size()); break;
+        case ilp::NAME_TRANSITIVITY:
+        case ilp::NAME_TRANSITIVITY_A:
+        case ilp::NAME_TRANSITIVITY_B:
+        case ilp::NAME_TRANSITIVITY_EXCLUSION:
+            for (int j = 0; j < 3; ++j)
+                if (refs[j] < 0 or refs[j] >= n_str) broken(table);
+            break;
+        default: break;
+        }
+    }
+}
+
+
+/**
+* Checks indices between tables of a result.
+* This is done after reading all the tables, because tables may be written in any order.
+*/
+void check_references(const result_t &r)
+{
+    const size_t n_str = r.strings.size();
+
+    check_indices(r.nodes.atoms.predicates, 0, n_str, "table of nodes");
+    check_indices(r.nodes.atoms.terms, 0, n_str, "table of nodes");
+    check_indices(r.nodes.params, 0, n_str, "table of nodes");
+    check_indices(r.nodes.masters, -1, r.hypernodes.size(), "table of nodes");
+
+    check_indices(r.hypernodes.nodes, 0, r.nodes.size(), "table of hypernodes");
+
+    check_indices(r.edges.tails, -1, r.hypernodes.size(), "table of edges");
+    check_indices(r.edges.heads, -1, r.hypernodes.size(), "table of edges");
+    check_indices(r.edges.conditions.predicates, 0, n_str, "table of edges");
+    check_indices(r.edges.conditions.terms, 0, n_str, "table of edges");
+
+    check_indices(r.exclusions.atoms.predicates, 0, n_str, "table of exclusions");
+    check_indices(r.exclusions.atoms.terms, 0, n_str, "table of exclusions");
+
+    check_names(r, r.variables.names, "table of variables");
+    check_names(r, r.constraints.names, "table of constraints");
+    check_indices(r.constraints.variables, 0, r.variables.size(), "table of constraints");
+
+    if (r.solutions.values.size() != r.solutions.size() * r.variables.size())
+        broken("table of solutions");
+}
+
+
+void deserialize(cursor_t &c, uint32_t format, result_t *r)
+{
+    r->clear();
+
+    r->index = c.get<int32_t>();
+    r->name = c.get_string();
+    r->time_lhs = c.get<float>();
+    r->time_exclusion = c.get<float>();
+    r->time_cnv = c.get<float>();
+    r->time_sol = c.get<float>();
+    r->time_all = c.get<float>();
+    r->do_maximize = c.get<uint8_t>();
+    r->do_economize = c.get<uint8_t>();
+
+    while (not c.end())
+    {
+        uint32_t tag;
+        cursor_t t = c.get_table(&tag);
+
+        if (tag == TAG_STRINGS)
+        {
+            std::vector<uint32_t> offsets;
+            std::vector<char> chars;
+            t.get_column(&offsets);
+            t.get_column(&chars);
+
+            if (offsets.empty())
+                broken("string table");
+            check_offsets(offsets, offsets.size() - 1, chars.size(), "string table");
+
+            for (size_t i = 0; i + 1 < offsets.size(); ++i)
+                r->strings.push_back(std::string(
+                    chars.data() + offsets[i], chars.data() + offsets[i + 1]));
+        }
+        else if (tag == TAG_NODES)
+        {
+            t.get_atoms(&r->nodes.atoms);
+            t.get_column(&r->nodes.types);
+            t.get_column(&r->nodes.depths);
+            t.get_column(&r->nodes.masters);
+            if (format >= 2)
+                t.get_column(&r->nodes.params);
+
+            const auto &nodes = r->nodes;
+            check_atoms(nodes.atoms, "table of nodes");
+            check_rows(nodes.types, nodes.atoms.size(), "table of nodes");
+            check_rows(nodes.depths, nodes.size(), "table of nodes");
+            check_rows(nodes.masters, nodes.size(), "table of nodes");
+            if (format >= 2)
+                check_rows(nodes.params, nodes.size(), "table of nodes");
+        }
+        else if (tag == TAG_HYPERNODES)
+        {
+            t.get_column(&r->hypernodes.offsets);
+            t.get_column(&r->hypernodes.nodes);
+
+            const auto &hns = r->hypernodes;
+            check_offsets(hns.offsets, hns.size(), hns.nodes.size(), "table of hypernodes");
+        }
+        else if (tag == TAG_EDGES)
+        {
+            t.get_column(&r->edges.types);
+            t.get_column(&r->edges.tails);
+            t.get_column(&r->edges.heads);
+            t.get_column(&r->edges.rules);
+            t.get_column(&r->edges.offsets);
+            t.get_atoms(&r->edges.conditions);
+
+            const auto &edges = r->edges;
+            check_rows(edges.tails, edges.size(), "table of edges");
+            check_rows(edges.heads, edges.size(), "table of edges");
+            check_rows(edges.rules, edges.size(), "table of edges");
+            check_offsets(edges.offsets, edges.size(), edges.conditions.size(), "table of edges");
+            check_atoms(edges.conditions, "table of edges");
+        }
+        else if (tag == TAG_EXCLUSIONS)
+        {
+            t.get_column(&r->exclusions.types);
+            t.get_column(&r->exclusions.rules);
+            t.get_column(&r->exclusions.offsets);
+            t.get_atoms(&r->exclusions.atoms);
+
+            const auto &excs = r->exclusions;
+            check_rows(excs.rules, excs.size(), "table of exclusions");
+            check_indices(excs.types, 0, pg::EXCLUSION_FORALL + 1, "table of exclusions");
+            check_offsets(excs.offsets, excs.size(), excs.atoms.size(), "table of exclusions");
+            check_atoms(excs.atoms, "table of exclusions");
+        }
+        else if (tag == TAG_VARIABLES)
+        {
+            t.get_names(&r->variables.names, format);
+            t.get_column(&r->variables.coefficients);
+            t.get_column(&r->variables.perturbations);
+            t.get_column(&r->variables.is_const);
+            t.get_column(&r->variables.const_values);
+
+            const auto &vars = r->variables;
+            check_rows(vars.coefficients, vars.size(), "table of variables");
+            check_rows(vars.perturbations, vars.size(), "table of variables");
+            check_rows(vars.is_const, vars.size(), "table of variables");
+            check_rows(vars.const_values, vars.size(), "table of variables");
+        }
+        else if (tag == TAG_CONSTRAINTS)
+        {
+            t.get_names(&r->constraints.names, format);
+            t.get_column(&r->constraints.operators);
+            t.get_column(&r->constraints.lower_bounds);
+            t.get_column(&r->constraints.upper_bounds);
+            t.get_column(&r->constraints.lazy);
+            t.get_column(&r->constraints.offsets);
+            t.get_column(&r->constraints.variables);
+            t.get_column(&r->constraints.coefficients);
+
+            const auto &cons = r->constraints;
+            check_rows(cons.operators, cons.size(), "table of constraints");
+            check_rows(cons.lower_bounds, cons.size(), "table of constraints");
+            check_rows(cons.upper_bounds, cons.size(), "table of constraints");
+            check_rows(cons.lazy, cons.size(), "table of constraints");
+            check_offsets(cons.offsets, cons.size(), cons.variables.size(), "table of constraints");
+            check_rows(cons.coefficients, cons.variables.size(), "table of constraints");
+        }
+        else if (tag == TAG_SOLUTIONS)
+        {
+            t.get_column(&r->solutions.types);
+            t.get_column(&r->solutions.objectives);
+            t.get_column(&r->solutions.values);
+            check_rows(r->solutions.objectives, r->solutions.size(), "table of solutions");
+        }
+        // TABLES WITH UNKNOWN TAGS ARE IGNORED.
+    }
+
+    check_references(*r);
+}
+}
+
+
+void result_t::clear()
+{
+    index = -1;
+    name.clear();
+    time_lhs = time_exclusion = time_cnv = time_sol = time_all = 0.0f;
+    do_maximize = do_economize = 0;
+    strings.clear();
+
+    nodes = nodes_t();
+    hypernodes = hypernodes_t();
+    edges = edges_t();
+    exclusions = exclusions_t();
+    variables = variables_t();
+    constraints = constraints_t();
+    solutions = solutions_t();
+}
+
+
+reader_t::reader_t(std::istream *is)
+    : m_is(is), m_format(0)
+{
+    char magic[4];
+
+    m_is->read(magic, 4);
+    m_is->read(reinterpret_cast<char*>(&m_format), sizeof(m_format));
+    convert_endian(&m_format);
+
+    if (m_is->fail() or std::memcmp(magic, MAGIC, 4) != 0)
+        throw exception_t("bin::reader_t: The input is not a binary output of David");
+    if (m_format > VERSION)
+        throw exception_t(format(
+            "bin::reader_t: Unsupported version %u (supported up to %u)", m_format, VERSION));
+
+    uint32_t tag;
+    if (not read_record(&tag, &m_payload) or tag != TAG_HEADER)
+        throw exception_t("bin::reader_t: The header is missing");
+
+    cursor_t c(m_payload.data(), m_payload.size());
+    m_version = c.get_string();
+    m_executed = c.get_string();
+    m_kernel = c.get_string();
+}
+
+
+bool reader_t::next(result_t *out)
+{
+    uint32_t tag;
+
+    while (read_record(&tag, &m_payload))
+    {
+        if (tag == TAG_END)
+            return false;
+
+        if (tag == TAG_PROBLEM)
+        {
+            cursor_t c(m_payload.data(), m_payload.size());
+            deserialize(c, m_format, out);
+            return true;
+        }
+        // RECORDS WITH UNKNOWN TAGS ARE IGNORED.
+    }
+
+    return false;
+}
+
+
+bool reader_t::read_record(uint32_t *tag, std::vector<char> *payload)
+{
+    uint64_t len;
+
+    m_is->read(reinterpret_cast<char*>(tag), sizeof(uint32_t));
+    if (m_is->gcount() == 0 and m_is->eof())
+        return false;
+
+    m_is->read(reinterpret_cast<char*>(&len), sizeof(len));
+    if (m_is->fail())
+        throw exception_t("bin::reader_t: Unexpected end of input");
+
+    convert_endian(tag);
+    convert_endian(&len);
+
+    payload->resize(len);
+    m_is->read(payload->data(), len);
+    if (m_is->fail())
+        throw exception_t("bin::reader_t: Unexpected end of input");
+
+    return true;
+}
+
+
+string_t atom2str(const result_t &r, const atoms_t &atoms, size_t i)
+{
+    // INDICES ARE CHECKED WITH at(), SINCE GIVEN RESULT MAY NOT BE ONE READ BY reader_t.
+    try
+    {
+        const string_t &pred = r.strings.at(atoms.predicates.at(i));
+        string_t name = pred.substr(0, pred.rfind('/'));
+        string_t out = atoms.nafs.at(i) ? "not " : "";
+
+        uint32_t begin = atoms.offsets.at(i), end = atoms.offsets.at(i + 1);
+
+        // EQUALITIES ARE WRITTEN IN THE SAME FORM AS atom_t::string().
+        if ((name == "=" or name == "!=") and end - begin == 2)
+            return out + "(" + r.strings.at(atoms.terms.at(begin)) + " " + name + " " +
+                r.strings.at(atoms.terms.at(begin + 1)) + ")";
+
+        out += name + "(";
+        for (uint32_t j = begin; j < end; ++j)
+        {
+            if (j != begin) out += ", ";
+            out += r.strings.at(atoms.terms.at(j));
+        }
+        return out + ")";
+    }
+    catch (const std::out_of_range&)
+    {
+        throw exception_t(format("bin::reader_t: Broken references of the %zu-th atom", i));
+    }
+}
+
+
+string_t name2str(const result_t &r, const names_t &names, size_t i)
+{
+    if (i >= names.size() or 3 * i + 2 >= names.refs.size())
+        throw exception_t(format("bin::reader_t: Broken table of names at %zu", i));
+
+    // INDICES ARE CHECKED WITH at(), SINCE GIVEN RESULT MAY NOT BE ONE READ BY reader_t.
+    try
+    {
+        const int32_t *refs = names.refs.data() + 3 * i;
+
+        auto atom = [&]() -> string_t
+        {
+            return (refs[0] >= 0) ? atom2str(r, r.nodes.atoms, refs[0]) : string_t();
+        };
+        auto node = [&]() -> string_t
+        {
+            // THE SAME AS pg::node_t::string().
+            const string_t &param = r.strings.at(r.nodes.params.at(refs[0]));
+            return format("[%d]", refs[0]) + atom2str(r, r.nodes.atoms, refs[0]) +
+                (param.empty() ? string_t() : ":" + param);
+        };
+        auto terms = [&]() -> string_t
+        {
+            return "(" + r.strings.at(refs[0]) + "," + r.strings.at(refs[1]) + "," + r.strings.at(refs[2]) + ")";
+        };
+
+        switch (static_cast<ilp::name_kind_e>(names.kinds.at(i)))
+        {
+        case ilp::NAME_STRING:
+            return (names.strings.at(i) == NO_STRING) ? string_t() : r.strings.at(names.strings.at(i));
+        case ilp::NAME_ATOM:              return "atom:" + atom();
+        case ilp::NAME_CWA:               return "cwa:" + atom();
+        case ilp::NAME_CLOSED:            return "closed:" + atom();
+        case ilp::NAME_SATISFIED:         return "satisfied:" + atom();
+        case ilp::NAME_NODE:              return "node:" + node();
+        case ilp::NAME_HYPERNODE:         return format("hypernode[%d]", refs[0]);
+        case ilp::NAME_HYPERNODE_MEMBER:  return format("hypernode_member:hn(%d)", refs[0]);
+        case ilp::NAME_EDGE:
+            return format("edge(%d):hn(%d,%d)", refs[0], r.edges.tails.at(refs[0]), r.edges.heads.at(refs[0]));
+        case ilp::NAME_EDGE_TAIL:         return format("edge-tail:e(%d)", refs[0]);
+        case ilp::NAME_EDGE_HEAD:         return format("edge-head:e(%d)", refs[0]);
+        case ilp::NAME_EDGE_COND:         return format("edge-cond:e(%d)", refs[0]);
+        case ilp::NAME_EXCLUSION:         return format("exclusion(%d)", refs[0]);
+        case ilp::NAME_VIOLATE_EXCLUSION: return format("violate-exclusion[%d]", refs[0]);
+        case ilp::NAME_TRANSITIVITY:      return "transitivity" + terms();
+        case ilp::NAME_TRANSITIVITY_A:    return "transitivity_a" + terms();
+        case ilp::NAME_TRANSITIVITY_B:    return "transitivity_b" + terms();
+        case ilp::NAME_TRANSITIVITY_EXCLUSION: return "transitivity-exclusion" + terms();
+        case ilp::NAME_NODE_COST:         return format("cost(n:%d)", refs[0]);
+        case ilp::NAME_EDGE_COST:         return format("cost(e:%d)", refs[0]);
+        case ilp::NAME_COST_PAYMENT:      return "cost-payment:" + node();
+        case ilp::NAME_COST_PAYMENT_ATOM: return "cost-payment:" + atom();
+        default:                          return string_t();
+        }
+    }
+    catch (const std::out_of_range&)
+    {
+        throw exception_t(format("bin::reader_t: Broken references of the %zu-th name", i));
+    }
+}
+
+
+}
+
+}
@@ -0,0 +1,494 @@
+#include "./bin.h"
+#include "./kernel.h"
+#include "./json.h"
+#include "./lhs.h"
+#include "./cnv.h"
+#include "./sol.h"
+#include "./kb.h"
+
+namespace dav
+{
+
+namespace bin
+{
+
+
+namespace
+{
+/**
+* @brief Base class of outputs of payloads, which writes numbers in little-endian.
+* @details `Derived` must have write(const char*, size_t).
+*/
+template <class Derived> class output_t
+{
+public:
+    template <class T> void put(T x)
+    {
+        convert_endian(&x);
+        derived()->write(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+
+    void put_string(const string_t &s)
+    {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        derived()->write(s.data(), s.size());
+    }
+
+    template <class T> void put_column(const std::vector<T> &v)
+    {
+        put<uint32_t>(static_cast<uint32_t>(v.size()));
+
+        // ON LITTLE-ENDIAN HOSTS, COLUMNS ARE WRITTEN AS THEY ARE.
+        if (is_little_endian_host())
+            derived()->write(reinterpret_cast<const char*>(v.data()), sizeof(T) * v.size());
+        else
+            for (const auto &x : v) put<T>(x);
+    }
+
+    void put_atoms(const atoms_t &a)
+    {
+        put_column(a.predicates);
+        put_column(a.nafs);
+        put_column(a.offsets);
+        put_column(a.terms);
+    }
+
+    void put_names(const names_t &n)
+    {
+        put_column(n.kinds);
+        put_column(n.strings);
+        put_column(n.refs);
+    }
+
+private:
+    Derived* derived() { return static_cast<Derived*>(this); }
+};
+
+
+/** Builder of a payload on memory, which is used for small records. */
+class payload_t : public output_t<payload_t>
+{
+public:
+    void write(const char *s, size_t n) { m_str.append(s, n); }
+    const std::string& str() const { return m_str; }
+
+private:
+    std::string m_str;
+};
+
+
+/** Output which only counts bytes, to get the length of a table before writing it. */
+class counter_t : public output_t<counter_t>
+{
+public:
+    counter_t() : m_size(0) {}
+
+    void write(const char*, size_t n) { m_size += n; }
+    uint64_t size() const { return m_size; }
+
+private:
+    uint64_t m_size;
+};
+
+
+/** Output which writes a payload directly into a stream. */
+class stream_output_t : public output_t<stream_output_t>
+{
+public:
+    stream_output_t(std::ostream *os) : m_os(os) {}
+
+    void write(const char *s, size_t n) { m_os->write(s, n); }
+
+private:
+    std::ostream *m_os;
+};
+
+
+/** Builder of the string table of a problem. */
+class string_table_t
+{
+public:
+    string_table_t(std::vector<string_t> *strs) : m_strings(strs) {}
+
+    uint32_t term(const term_t &t)
+    {
+        auto it = m_terms.find(t.get_hash());
+        if (it != m_terms.end()) return it->second;
+        return (m_terms[t.get_hash()] = add(t.string()));
+    }
+
+    /** Adds a term from its hash, such as ones referred by ilp::name_t. */
+    uint32_t term(unsigned hash)
+    {
+        auto it = m_terms.find(hash);
+        if (it != m_terms.end()) return it->second;
+        return (m_terms[hash] = add(term_t(hash).string()));
+    }
+
+    /** Adds a string which is shared, such as a parameter of nodes. */
+    uint32_t intern(const string_t &s)
+    {
+        auto it = m_interned.find(s);
+        if (it != m_interned.end()) return it->second;
+        return (m_interned[s] = add(s));
+    }
+
+    uint32_t predicate(const predicate_t &p)
+    {
+        auto it = m_preds.find(p.pid());
+        if (it != m_preds.end()) return it->second;
+        return (m_preds[p.pid()] = add(p.string()));
+    }
+
+    /** Adds a string which is not shared, such as the name of an ILP variable. */
+    uint32_t add(const string_t &s)
+    {
+        m_strings->push_back(s);
+        return static_cast<uint32_t>(m_strings->size() - 1);
+    }
+
+    void add_atom(const atom_t &a, atoms_t *out)
+    {
+        if (out->offsets.empty())
+            out->offsets.push_back(0);
+
+        out->predicates.push_back(predicate(a.predicate()));
+        out->nafs.push_back(a.naf() ? 1 : 0);
+        for (const auto &t : a.terms())
+            out->terms.push_back(term(t));
+        out->offsets.push_back(static_cast<uint32_t>(out->terms.size()));
+    }
+
+    /**
+    * @brief Adds the name of an ILP variable or an ILP constraint.
+    * @details
+    *   Names are written as descriptors, so that they are not made into strings on writing.
+    *   Only names which have been given as strings are added to the string table.
+    */
+    void add_name(const ilp::name_t &n, const pg::proof_graph_t *g, names_t *out)
+    {
+        // NAMES REFERRING TO ANOTHER PROOF-GRAPH CANNOT BE MADE FROM THE TABLES.
+        if (n.kind() == ilp::NAME_STRING or (n.graph() != nullptr and n.graph() != g))
+        {
+            out->kinds.push_back(static_cast<uint8_t>(ilp::NAME_STRING));
+            out->strings.push_back(add(n.string()));
+            out->refs.insert(out->refs.end(), 3, -1);
+            return;
+        }
+
+        bool is_term =
+            n.kind() == ilp::NAME_TRANSITIVITY or n.kind() == ilp::NAME_TRANSITIVITY_A or
+            n.kind() == ilp::NAME_TRANSITIVITY_B or n.kind() == ilp::NAME_TRANSITIVITY_EXCLUSION;
+
+        out->kinds.push_back(static_cast<uint8_t>(n.kind()));
+        out->strings.push_back(NO_STRING);
+        for (int r : n.refs())
+            out->refs.push_back(is_term ? static_cast<int32_t>(term(static_cast<unsigned>(r))) : r);
+    }
+
+private:
+    std::vector<string_t> *m_strings;
+    std::unordered_map<unsigned, uint32_t> m_terms;
+    std::unordered_map<predicate_id_t, uint32_t> m_preds;
+    std::unordered_map<string_t, uint32_t> m_interned;
+};
+
+
+void make_result(result_t *r)
+{
+    r->clear();
+    string_table_t st(&r->strings);
+
+    r->index = kernel()->problem().index;
+    r->name = kernel()->problem().name;
+
+    r->time_lhs = kernel()->lhs->timer->duration();
+    r->time_exclusion = kernel()->lhs->out ? kernel()->lhs->out->exclusion_time() : 0.0f;
+    r->time_cnv = kernel()->cnv->timer->duration();
+    r->time_sol = kernel()->sol->timer->duration();
+    r->time_all = kernel()->timer->duration();
+
+    if (const pg::proof_graph_t *g = kernel()->lhs->out.get())
+    {
+        auto &nodes = r->nodes;
+        for (const auto &n : g->nodes)
+        {
+            st.add_atom(n, &nodes.atoms);
+            nodes.types.push_back(static_cast<uint8_t>(n.type()));
+            nodes.depths.push_back(n.depth());
+            nodes.masters.push_back(n.master());
+            nodes.params.push_back(st.intern(n.param()));
+        }
+
+        auto &hns = r->hypernodes;
+        hns.offsets.push_back(0);
+        for (const auto &hn : g->hypernodes)
+        {
+            hns.nodes.insert(hns.nodes.end(), hn.begin(), hn.end());
+            hns.offsets.push_back(static_cast<uint32_t>(hns.nodes.size()));
+        }
+
+        auto &edges = r->edges;
+        edges.offsets.push_back(0);
+        for (const auto &e : g->edges)
+        {
+            edges.types.push_back(static_cast<uint8_t>(e.type()));
+            edges.tails.push_back(e.tail());
+            edges.heads.push_back(e.head());
+            edges.rules.push_back(e.rid());
+            for (const auto &a : e.conditions())
+                st.add_atom(a, &edges.conditions);
+            edges.offsets.push_back(static_cast<uint32_t>(edges.conditions.size()));
+        }
+
+        // EXCLUSIONS ARE WRITTEN IN ORDER OF THEIR INDICES.
+        auto &excs = r->exclusions;
+        excs.offsets.push_back(0);
+        for (size_t i = 0; i < g->excs.size(); ++i)
+        {
+            const auto &e = g->excs.at(i);
+            excs.types.push_back(static_cast<uint8_t>(e.type()));
+            excs.rules.push_back(e.rid());
+            for (const auto &a : e)
+                st.add_atom(a, &excs.atoms);
+            excs.offsets.push_back(static_cast<uint32_t>(excs.atoms.size()));
+        }
+    }
+
+    if (const ilp::problem_t *prob = kernel()->cnv->out.get())
+    {
+        r->do_maximize = prob->do_maximize() ? 1 : 0;
+        r->do_economize = prob->do_economize() ? 1 : 0;
+
+        auto &vars = r->variables;
+        for (const auto &v : prob->vars)
+        {
+            st.add_name(v.name_descriptor(), kernel()->lhs->out.get(), &vars.names);
+            vars.coefficients.push_back(v.coefficient());
+            vars.perturbations.push_back(v.perturbation());
+            vars.is_const.push_back(v.is_const() ? 1 : 0);
+            vars.const_values.push_back(v.is_const() ? v.const_value() : 0.0);
+        }
+
+        auto &cons = r->constraints;
+        cons.offsets.push_back(0);
+        for (const auto &c : prob->cons)
+        {
+            const auto &terms = c.terms();
+            st.add_name(c.name_descriptor(), kernel()->lhs->out.get(), &cons.names);
+            cons.operators.push_back(static_cast<uint8_t>(c.operator_type()));
+            cons.lower_bounds.push_back(c.lower_bound());
+            cons.upper_bounds.push_back(c.upper_bound());
+            cons.lazy.push_back(c.lazy() ? 1 : 0);
+            cons.variables.insert(cons.variables.end(), terms.variables(), terms.variables() + terms.size());
+            cons.coefficients.insert(cons.coefficients.end(), terms.coefficients(), terms.coefficients() + terms.size());
+            cons.offsets.push_back(static_cast<uint32_t>(cons.variables.size()));
+        }
+
+        auto &sols = r->solutions;
+        for (const auto &s : kernel()->sol->out)
+        {
+            sols.types.push_back(static_cast<uint8_t>(s->type()));
+            sols.objectives.push_back(s->problem()->objective_value(*s, false));
+            for (size_t i = 0; i < prob->vars.size(); ++i)
+                sols.values.push_back((i < s->size()) ? s->at(i) : 0.0);
+        }
+    }
+}
+
+
+/** Tables of "PROB" records in the order to write. */
+const uint32_t TABLES[] = {
+    TAG_STRINGS, TAG_NODES, TAG_HYPERNODES, TAG_EDGES,
+    TAG_EXCLUSIONS, TAG_VARIABLES, TAG_CONSTRAINTS, TAG_SOLUTIONS };
+
+
+/** Writes scalar fields of a "PROB" record, which precede its tables. */
+template <class Out> void put_fields(const result_t &r, Out *out)
+{
+    out->template put<int32_t>(r.index);
+    out->put_string(r.name);
+    out->template put<float>(r.time_lhs);
+    out->template put<float>(r.time_exclusion);
+    out->template put<float>(r.time_cnv);
+    out->template put<float>(r.time_sol);
+    out->template put<float>(r.time_all);
+    out->template put<uint8_t>(r.do_maximize);
+    out->template put<uint8_t>(r.do_economize);
+}
+
+
+/** Writes the payload of the table of given tag. */
+template <class Out> void put_table(uint32_t tag, const result_t &r, Out *out)
+{
+    if (tag == TAG_STRINGS)
+    {
+        std::vector<uint32_t> offsets(1, 0);
+        offsets.reserve(r.strings.size() + 1);
+        for (const auto &s : r.strings)
+            offsets.push_back(offsets.back() + static_cast<uint32_t>(s.size()));
+
+        // CHARACTERS ARE WRITTEN STRING BY STRING, WITHOUT BEING CONCATENATED.
+        out->put_column(offsets);
+        out->template put<uint32_t>(offsets.back());
+        for (const auto &s : r.strings)
+            out->write(s.data(), s.size());
+    }
+    else if (tag == TAG_NODES)
+    {
+        out->put_atoms(r.nodes.atoms);
+        out->put_column(r.nodes.types);
+        out->put_column(r.nodes.depths);
+        out->put_column(r.nodes.masters);
+        out->put_column(r.nodes.params);
+    }
+    else if (tag == TAG_HYPERNODES)
+    {
+        out->put_column(r.hypernodes.offsets);
+        out->put_column(r.hypernodes.nodes);
+    }
+    else if (tag == TAG_EDGES)
+    {
+        out->put_column(r.edges.types);
+        out->put_column(r.edges.tails);
+        out->put_column(r.edges.heads);
+        out->put_column(r.edges.rules);
+        out->put_column(r.edges.offsets);
+        out->put_atoms(r.edges.conditions);
+    }
+    else if (tag == TAG_EXCLUSIONS)
+    {
+        out->put_column(r.exclusions.types);
+        out->put_column(r.exclusions.rules);
+        out->put_column(r.exclusions.offsets);
+        out->put_atoms(r.exclusions.atoms);
+    }
+    else if (tag == TAG_VARIABLES)
+    {
+        out->put_names(r.variables.names);
+        out->put_column(r.variables.coefficients);
+        out->put_column(r.variables.perturbations);
+        out->put_column(r.variables.is_const);
+        out->put_column(r.variables.const_values);
+    }
+    else if (tag == TAG_CONSTRAINTS)
+    {
+        out->put_names(r.constraints.names);
+        out->put_column(r.constraints.operators);
+        out->put_column(r.constraints.lower_bounds);
+        out->put_column(r.constraints.upper_bounds);
+        out->put_column(r.constraints.lazy);
+        out->put_column(r.constraints.offsets);
+        out->put_column(r.constraints.variables);
+        out->put_column(r.constraints.coefficients);
+    }
+    else if (tag == TAG_SOLUTIONS)
+    {
+        out->put_column(r.solutions.types);
+        out->put_column(r.solutions.objectives);
+        out->put_column(r.solutions.values);
+    }
+}
+}
+
+
+writer_t::writer_t(const filepath_t &path)
+    : m_os(new json::file_stream_t(path)), m_num(0)
+{
+    if (m_os->fail())
+        throw exception_t(format("bin::writer_t cannot open \"%s\"", path.c_str()));
+
+    payload_t p;
+    p.put<uint32_t>(VERSION);
+
+    m_os->write(MAGIC, 4);
+    m_os->write(p.str().data(), p.str().size());
+}
+
+
+void writer_t::write_header()
+{
+    std::ostringstream oss;
+    {
+        json::kb2json_t kb2js;
+        json::object_writer_t wr(&oss, false);
+        json::kernel2json_t::write_kernel(wr, kb2js);
+    }
+
+    payload_t p;
+    p.put_string(kernel_t::VERSION);
+    p.put_string(INIT_TIME.string());
+    p.put_string(oss.str());
+    write_record(TAG_HEADER, p.str());
+}
+
+
+void writer_t::write_content()
+{
+    if (kernel()->cmd.mode != MODE_INFER) return;
+
+    result_t r;
+
+    make_result(&r);
+    write_problem(r);
+    ++m_num;
+
+    m_os->flush();
+}
+
+
+void writer_t::write_footer()
+{
+    payload_t p;
+    p.put<uint32_t>(m_num);
+    write_record(TAG_END, p.str());
+    m_os->flush();
+}
+
+
+void writer_t::write_problem(const result_t &r)
+{
+    // LENGTHS OF THE RECORD AND TABLES ARE COUNTED BEFOREHAND,
+    // SO THAT TABLES ARE WRITTEN INTO THE STREAM WITHOUT BEING BUFFERED.
+    counter_t fields;
+    put_fields(r, &fields);
+
+    uint64_t len = fields.size();
+    std::vector<uint64_t> lens;
+
+    for (auto tag : TABLES)
+    {
+        counter_t c;
+        put_table(tag, r, &c);
+        lens.push_back(c.size());
+        len += sizeof(uint32_t) + sizeof(uint64_t) + c.size();
+    }
+
+    stream_output_t out(m_os.get());
+    out.put<uint32_t>(TAG_PROBLEM);
+    out.put<uint64_t>(len);
+    put_fields(r, &out);
+
+    for (size_t i = 0; i < lens.size(); ++i)
+    {
+        out.put<uint32_t>(TABLES[i]);
+        out.put<uint64_t>(lens[i]);
+        put_table(TABLES[i], r, &out);
+    }
+}
+
+
+void writer_t::write_record(uint32_t tag, const std::string &payload)
+{
+    payload_t p;
+    p.put<uint32_t>(tag);
+    p.put<uint64_t>(payload.size());
+
+    m_os->write(p.str().data(), p.str().size());
+    m_os->write(payload.data(), payload.size());
+}
+
+
+}
+
+}
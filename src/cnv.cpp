@@ -69,103 +69,127 @@ void ilp_converter_t::process()
 
     out.reset(new ilp::problem_t(master()->lhs->out, do_maximize(), true, do_make_cwa()));
 
-    // ADDS VARIABLES OF HYPERNODES
-    LOG_MIDDLE(format("converting hypernodes to ILP-variables ... (%d hypernodes)",
-        out->graph()->hypernodes.size()));
-    for (const auto &hn : out->graph()->hypernodes)
-        out->vars.add(hn);
-    ABORT;
-
-    // ADDS VARIABLES OF NODES
-    LOG_MIDDLE(format("converting nodes to ILP-variables ... (%d nodes)",
-        out->graph()->nodes.size()));
-    for (const auto &n : out->graph()->nodes)
-        out->vars.add(n);
-    ABORT;
-
-    // ENUMERATE ATOMS IN THE PROOF-GRAPH
-    hash_set_t<atom_t> atoms;
-    for (const auto &p : out->graph()->nodes.atom2nodes)
-        atoms.insert(p.first);
-
-    // ADDS VARIABLES OF ATOMS
-    LOG_MIDDLE(format("converting atoms to ILP-variables ... (%d atoms)",
-        out->graph()->nodes.atom2nodes.size()));
-    for (const auto &p : out->graph()->nodes.atom2nodes)
-        out->vars.add(p.first);
-
-    term_cluster_t tc;
-    for (const auto &p : out->graph()->nodes.atom2nodes)
-        if (p.first.pid() == PID_EQ)
-            tc.add(p.first);
-
-    for (const auto &cluster : tc.clusters())
     {
-        if (cluster.size() < 2) continue;
+        tracer_t::span_t span("cnv-variables");
+
+        // ADDS VARIABLES OF HYPERNODES
+        LOG_MIDDLE(format("converting hypernodes to ILP-variables ... (%d hypernodes)",
+            out->graph()->hypernodes.size()));
+        for (const auto &hn : out->graph()->hypernodes)
+            out->vars.add(hn);
+        ABORT;
+
+        // ADDS VARIABLES OF NODES
+        LOG_MIDDLE(format("converting nodes to ILP-variables ... (%d nodes)",
+            out->graph()->nodes.size()));
+        for (const auto &n : out->graph()->nodes)
+            out->vars.add(n);
+        ABORT;
+
+        // ENUMERATE ATOMS IN THE PROOF-GRAPH
+        hash_set_t<atom_t> atoms;
+        for (const auto &p : out->graph()->nodes.atom2nodes)
+            atoms.insert(p.first);
+
+        // ADDS VARIABLES OF ATOMS
+        LOG_MIDDLE(format("converting atoms to ILP-variables ... (%d atoms)",
+            out->graph()->nodes.atom2nodes.size()));
+        for (const auto &p : out->graph()->nodes.atom2nodes)
+            out->vars.add(p.first);
+
+        term_cluster_t tc;
+        for (const auto &p : out->graph()->nodes.atom2nodes)
+            if (p.first.pid() == PID_EQ)
+                tc.add(p.first);
+
+        for (const auto &cluster : tc.clusters())
+        {
+            if (cluster.size() < 2) continue;
 
-        for (auto it1 = ++cluster.begin(); it1 != cluster.end(); ++it1)
-            for (auto it2 = cluster.begin(); it2 != it1; ++it2)
-                if (it1->is_unifiable_with(*it2))
-                    out->vars.add(atom_t::equal(*it1, *it2));
+            for (auto it1 = ++cluster.begin(); it1 != cluster.end(); ++it1)
+                for (auto it2 = cluster.begin(); it2 != it1; ++it2)
+                    if (it1->is_unifiable_with(*it2))
+                        out->vars.add(atom_t::equal(*it1, *it2));
+        }
+        ABORT;
+
+        // ADDS VARIABLES OF EDGES
+        LOG_MIDDLE(format("converting edges to ILP-variables ... (%d edges)", out->graph()->edges.size()));
+        for (const auto &e : out->graph()->edges)
+            out->vars.add(e);
+        ABORT;
+
+        // ADDS VARIABLES OF ATOMS
+        LOG_MIDDLE(format("making ILP-variables for exclusions ... (%d exclusions)", out->graph()->excs.size()));
+        make_variables_for_exclusions();
+        ABORT;
     }
-    ABORT;
 
-    // ADDS VARIABLES OF EDGES
-    LOG_MIDDLE(format("converting edges to ILP-variables ... (%d edges)", out->graph()->edges.size()));
-    for (const auto &e : out->graph()->edges)
-        out->vars.add(e);
-    ABORT;
+    {
+        tracer_t::span_t span("cnv-transitivity");
 
-    // ADDS VARIABLES OF ATOMS
-    LOG_MIDDLE(format("making ILP-variables for exclusions ... (%d exclusions)", out->graph()->excs.size()));
-    make_variables_for_exclusions();
-    ABORT;
+        LOG_MIDDLE("converting transitivity of equality to ILP-constraints ...");
 
-    LOG_MIDDLE("converting transitivity of equality to ILP-constraints ...");
+        out->make_constraints_for_transitivity();
+        ABORT;
+    }
 
-    out->make_constraints_for_transitivity();
-    ABORT;
+    {
+        tracer_t::span_t span("cnv-structure");
 
-    LOG_MIDDLE("converting graph-structure to ILP-constraints ...");
-    
-    out->make_constraints_for_atom_and_node();
-    ABORT;
-    out->make_constraints_for_hypernode_and_node();
-    ABORT;
-    out->make_constraints_for_edge();
-    ABORT;
-    
-    LOG_MIDDLE("making other ILP-constraints ...");
-    
-    out->make_constraints_for_closed_predicate();
-    ABORT;
+        LOG_MIDDLE("converting graph-structure to ILP-constraints ...");
 
-    ilp::pseudo_sample_type_e sample_type = ilp::NOT_PSEUDO_SAMPLE;
+        out->make_constraints_for_atom_and_node();
+        ABORT;
+        out->make_constraints_for_hypernode_and_node();
+        ABORT;
+        out->make_constraints_for_edge();
+        ABORT;
+    }
+    
     {
-        bool is_pseudo_positive = param()->has("pseudo-positive");
-        bool is_pseudo_negative = param()->has("pseudo-negative");
-        bool is_hard_sampling = param()->has("hard-sampling");
+        tracer_t::span_t span("cnv-others");
 
-        if (is_pseudo_positive and is_pseudo_negative)
-            throw exception_t("invalid options: \"--pseudo-positive\" and \"--pseudo-negative\"");
+        LOG_MIDDLE("making other ILP-constraints ...");
 
-        if (is_pseudo_positive)
-        {
-            sample_type = is_hard_sampling ?
-                ilp::PSEUDO_POSITIVE_SAMPLE_HARD : ilp::PSEUDO_POSITIVE_SAMPLE;
-        }
-        else if (is_pseudo_negative)
+        out->make_constraints_for_closed_predicate();
+        ABORT;
+
+        ilp::pseudo_sample_type_e sample_type = ilp::NOT_PSEUDO_SAMPLE;
         {
-            sample_type = is_hard_sampling ?
-                ilp::PSEUDO_NEGATIVE_SAMPLE_HARD : ilp::PSEUDO_NEGATIVE_SAMPLE;
+            bool is_pseudo_positive = param()->has("pseudo-positive");
+            bool is_pseudo_negative = param()->has("pseudo-negative");
+            bool is_hard_sampling = param()->has("hard-sampling");
+
+            if (is_pseudo_positive and is_pseudo_negative)
+                throw exception_t("invalid options: \"--pseudo-positive\" and \"--pseudo-negative\"");
+
+            if (is_pseudo_positive)
+            {
+                sample_type = is_hard_sampling ?
+                    ilp::PSEUDO_POSITIVE_SAMPLE_HARD : ilp::PSEUDO_POSITIVE_SAMPLE;
+            }
+            else if (is_pseudo_negative)
+            {
+                sample_type = is_hard_sampling ?
+                    ilp::PSEUDO_NEGATIVE_SAMPLE_HARD : ilp::PSEUDO_NEGATIVE_SAMPLE;
+            }
         }
+
+        out->make_constraints_for_requirement(sample_type);
     }
 
-    out->make_constraints_for_requirement(sample_type);
+    {
+        tracer_t::span_t span("cnv-exclusions");
+
+        LOG_MIDDLE("converting exclusions to ILP-constraints ...");
+        for (const auto &e : out->graph()->excs)
+            out->cons.add(e);
+    }
 
-    LOG_MIDDLE("converting exclusions to ILP-constraints ...");
-    for (const auto &e : out->graph()->excs)
-        out->cons.add(e);
+    const auto &mat = out->cons.matrix();
+    LOG_DETAIL(format("ILP-constraints: %d rows, %d nonzeros, %.1f bytes per nonzero",
+        (int)mat.rows(), (int)mat.nonzeros(), mat.bytes_per_nonzero()));
 #undef ABORT
 }
 
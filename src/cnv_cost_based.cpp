@@ -82,10 +82,9 @@ void cost_based_converter_t::process()
         {
             for (const auto &p2 : p1.second)
             {
-                const auto &n = out->graph()->nodes.at(p2.first);
                 auto vi = out->vars.node2var.get(p2.first);
                 out->make_constraint(
-                    format("cost-payment:%s", n.string().c_str()),
+                    ilp::name_t(ilp::NAME_COST_PAYMENT, out->graph(), p2.first),
                     ilp::CON_IF_ALL_THEN, { p2.second, vi });
             }
         }
@@ -141,7 +140,7 @@ void cost_based_converter_t::process()
         }
 
         out->make_constraint(
-            format("cost-payment:%s", p1.first.string().c_str()),
+            ilp::name_t(ilp::NAME_COST_PAYMENT_ATOM, out->graph(), p1.second.front().first),
             ilp::CON_IF_THEN_ANY, vars);
     }
 
@@ -13,12 +13,8 @@ struct __hasher_t
 {
     size_t operator()(const edge_direction_t &x) const
     {
-        static const uint8_t _true = 1;
-        static const uint8_t _false = 0;
-        dav::fnv_1::hash_t<size_t> hasher;
-        
-        hasher.read((uint8_t*)&x.first, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
-        hasher.read(x.second ? &_true : &_false, 1);
+        dav::word_hash_t hasher;
+        hasher.read(static_cast<uint64_t>(x.first) << 1 | (x.second ? 1u : 0u));
         return hasher.hash();
     }
 };
@@ -320,17 +320,21 @@ void directed_graph_t::delete_vertex(pg::node_idx_t vid)
 }
 
 
-johnson_t::johnson_t()
-    : m_pout(NULL), m_multithread(true)
+std::vector<pg::node_idx_t> directed_graph_t::vertices() const
 {
-    set_multithread();
+    std::vector<pg::node_idx_t> out;
+    out.reserve(m_adj.size());
+    for (const auto &p : m_adj)
+        out.push_back(p.first);
+    std::sort(out.begin(), out.end());
+    return out;
 }
 
 
-johnson_t::~johnson_t()
+johnson_t::johnson_t()
+    : m_multithread(true), m_thread_num(1), m_max_circuits(0), m_circuits_per_second(0.0)
 {
-    if (m_pout != NULL)
-        delete m_pout;
+    set_multithread();
 }
 
 
@@ -345,111 +349,99 @@ void johnson_t::set_multithread()
     set_multithread(
         (param()->thread_num() > 1) and
         not param()->has("disable-parallel-johnson"));
+    set_thread_num(param()->thread_num());
 }
 
 
-void johnson_t::mt_johnson(directed_graph_t *sccg)
-{
-    if (m_stop)
-        return;
-	pg::node_idx_t i = sccg->get_min_vid();
-	pg::node_idx_t n = sccg->get_max_vid();
-    if (i <= n)
-    {
-        do_johnson(i, *sccg);
-        if (i + 1 < n)
-        {
-            sccg->delete_vertex(i);
-            std::vector<directed_graph_t*> sccgs;
-            sccg->get_all_strong_components(sccgs);
-            int gi, gn = sccgs.size();
-            std::vector<std::thread> threads(gn);
-            for (gi = 0; gi < gn; gi++)
-            {
-                threads[gi] = std::thread([this, sccgs, gi] { mt_johnson(sccgs[gi]); });
-            }
-            for (gi = 0; gi < gn; gi++)
-            {
-                threads[gi].join();
-                delete sccgs[gi];
-            }
-        }
-    }
-}
-
 std::list<std::unordered_set<pg::node_idx_t>>* johnson_t::find_all_circuits(std::unordered_map<pg::node_idx_t, std::unordered_map<pg::node_idx_t, pg::edge_idx_t>>& input, int* max_circuits)
 {
     m_max_circuits = *max_circuits;
-    m_stop = false;
-
-    if (m_pout != NULL)
-        delete m_pout;
-    m_pout = new std::list<std::unordered_set<pg::node_idx_t>>();
-    if (input.size() == 0)
+    m_circuits_per_second = 0.0;
+    m_works.clear();
+
+    std::unique_ptr<circuits_t> out(new circuits_t());
+    if (input.size() == 0 || m_max_circuits == 0)
+        return out.release();
+
+    time_watcher_t timer;
+    directed_graph_t graph;
+    graph.set(input);
+
+    std::vector<directed_graph_t*> sccgs;
+    graph.get_all_strong_components(sccgs);
+    std::vector<std::unique_ptr<directed_graph_t>> sccgs_holder(sccgs.begin(), sccgs.end());
+
+    // UNITS OF WORK ARE ORDERED BY THEIR SCC AND THEIR START VERTEX,
+    // WHICH IS THE ORDER TO MERGE THE CIRCUITS FOUND.
+    std::sort(sccgs.begin(), sccgs.end(),
+        [](const directed_graph_t *x, const directed_graph_t *y) { return x->get_min_vid() < y->get_min_vid(); });
+    for (auto g = sccgs.begin(); g != sccgs.end(); ++g)
     {
-        std::list<std::unordered_set<pg::node_idx_t>> *ret = m_pout;
-        m_pout = NULL;
-        return ret;
+        std::vector<pg::node_idx_t> vs = (*g)->vertices();
+        for (auto v = vs.begin(); v != vs.end(); ++v)
+            m_works.emplace_back(m_works.size(), *g, *v);
     }
-    if (m_max_circuits == 0)
-    {
-        std::list<std::unordered_set<pg::node_idx_t>> *ret = m_pout;
-        m_pout = NULL;
-        return ret;
-    }
-
-    std::unique_ptr<directed_graph_t> graph(new directed_graph_t());
-    graph->set(input);
-    m_pinput = &input;
 
-    if (m_multithread)
+    int num_threads = std::min<int>(m_thread_num, static_cast<int>(m_works.size()));
+    if (m_multithread && num_threads > 1)
     {
-        std::vector<directed_graph_t*> sccgs;
-        graph->get_all_strong_components(sccgs);
-        int gi, gn = sccgs.size();
-        std::vector<std::thread> threads(gn);
-        for (gi = 0; gi < gn; gi++)
+        task_pool_t pool(num_threads);
+        for (auto &w : m_works)
         {
-            threads[gi] = std::thread([this, sccgs, gi] { mt_johnson(sccgs[gi]); });
-        }
-        for (gi = 0; gi < gn; gi++)
-        {
-            threads[gi].join();
-            delete sccgs[gi];
+            work_t *pw = &w;
+            pool.push([this, pw] { do_johnson(pw); });
         }
+        pool.wait();
     }
     else
     {
-        int i = graph->get_min_vid();
-        int n = graph->get_max_vid();
-        while (i <= n)
-        {
-            if (m_stop)
-                break;
-            directed_graph_t sccg;
-            int k = graph->get_least_strong_component(sccg);
-            if (k < 0)
-                break;
-            do_johnson(k, sccg);
-            i = k + 1;
-            if (k <= n)
-            {
-                graph->delete_vertex(k);
-            }
-        }
+        num_threads = 1;
+        for (auto &w : m_works)
+            do_johnson(&w);
     }
-    std::list<std::unordered_set<pg::node_idx_t>> *ret = m_pout;
-    m_pout = NULL;
-    if (m_stop)
+
+    for (auto &w : m_works)
+        out->splice(out->end(), w.circuits);
+    m_works.clear();
+
+    bool is_saturated = (m_max_circuits > 0 && static_cast<int>(out->size()) >= m_max_circuits);
+    if (is_saturated)
+        out->resize(m_max_circuits);
+
+    time_t duration = timer.duration();
+    if (duration > 0.0f)
+        m_circuits_per_second = out->size() / duration;
+    LOG_DETAIL(format(
+        "found %d circuits in %.3f seconds (%.1f circuits/sec. with %d threads)",
+        (int)out->size(), duration, m_circuits_per_second, num_threads));
+
+    if (is_saturated)
         *max_circuits = -1;
-    return ret;
+    return out.release();
+}
+
+
+bool johnson_t::is_saturated_before(size_t i) const
+{
+    if (m_max_circuits <= 0)
+        return false;
+
+    // COUNTS ONLY INCREASE, SO THE RESULT NEVER TURNS FALSE ONCE IT IS TRUE.
+    int n = 0;
+    for (size_t j = 0; j < i && n < m_max_circuits; ++j)
+        n += m_works[j].num.load(std::memory_order_relaxed);
+    return n >= m_max_circuits;
 }
 
-void johnson_t::do_johnson(pg::node_idx_t vid, directed_graph_t& sccg)
+
+void johnson_t::do_johnson(work_t *w)
 {
-    if (m_stop)
+    if (is_saturated_before(w->index))
         return;
-	pg::node_idx_t i, n = sccg.get_max_vid() - vid + 1;
+
+    // THE SEARCH RUNS ON THE WHOLE SCC, SKIPPING VERTICES LESS THAN THE START VERTEX.
+    pg::node_idx_t vid = w->start;
+	pg::node_idx_t i, n = w->scc->get_max_vid() - vid + 1;
     char *blocked = new char[n];
     for (i = 0; i < n; i++)
     {
@@ -457,7 +449,7 @@ void johnson_t::do_johnson(pg::node_idx_t vid, directed_graph_t& sccg)
     }
     std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>> *blockmap = new std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>>();
     std::deque<pg::node_idx_t> *vstack = new std::deque<pg::node_idx_t>();
-    circuit(vid, vid, sccg, blocked, *blockmap, *vstack);
+    circuit(vid, vid, *w->scc, blocked, *blockmap, *vstack, w);
     delete[] blocked;
     delete blockmap;
     delete vstack;
@@ -465,10 +457,10 @@ void johnson_t::do_johnson(pg::node_idx_t vid, directed_graph_t& sccg)
 
 
 bool johnson_t::circuit(
-	pg::node_idx_t vid, pg::node_idx_t sid, directed_graph_t& sccg, char *blocked,
-    std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>>& blockmap, std::deque<pg::node_idx_t>& vstack)
+	pg::node_idx_t vid, pg::node_idx_t sid, const directed_graph_t& sccg, char *blocked,
+    std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>>& blockmap, std::deque<pg::node_idx_t>& vstack, work_t *w)
 {
-    if (m_stop)
+    if (w->is_stopped)
         return false;
     bool found = false;
     blocked[vid - sid] = 1;
@@ -478,16 +470,18 @@ bool johnson_t::circuit(
     vstack.push_back(vid);
     for (auto v = nexts->begin(); v != nexts->end(); ++v)
     {
+        if (*v < sid)
+            continue;
         if (*v == sid) // found cycle!!
         {
             vstack.push_back(*v);
-            add_cycle(vstack);
+            add_cycle(vstack, w);
             vstack.pop_back();
             found = true;
         }
         else if (!blocked[*v - sid])
         {
-            if (circuit(*v, sid, sccg, blocked, blockmap, vstack))
+            if (circuit(*v, sid, sccg, blocked, blockmap, vstack, w))
                 found = true;
         }
     }
@@ -497,6 +491,8 @@ bool johnson_t::circuit(
     {
         for (auto v = nexts->begin(); v != nexts->end(); ++v)
         {
+            if (*v < sid)
+                continue;
             auto x = blockmap.find(*v);
             if (x != blockmap.end())
             {
@@ -535,7 +531,7 @@ void johnson_t::unblock(pg::node_idx_t vid, pg::node_idx_t sid, char *blocked, s
     }
 }
 
-void johnson_t::add_cycle(std::deque<pg::node_idx_t>& vstack)
+void johnson_t::add_cycle(std::deque<pg::node_idx_t>& vstack, work_t *w)
 {
     std::unordered_set<pg::node_idx_t> cycle;
     for (auto it = vstack.begin(); it != vstack.end(); ++it)
@@ -561,22 +557,16 @@ void johnson_t::add_cycle(std::deque<pg::node_idx_t>& vstack)
         */
         cycle.insert(*it); // vertex id
     }
-    if (m_stop)
-        return;
-    int n;
-    if (m_multithread)
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_pout->push_back(cycle);
-        n = (int)m_pout->size();
-    }
-    else
+    w->circuits.push_back(cycle);
+    int n = w->num.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // EACH WORK STOPS WHEN IT OR THE PRECEDING WORKS HAVE FOUND ENOUGH CIRCUITS.
+    // THE LATTER IS CHECKED AT INTERVALS, SINCE IT READS COUNTS OF ALL THE PRECEDING WORKS.
+    if (m_max_circuits > 0)
     {
-        m_pout->push_back(cycle);
-        n = (int)m_pout->size();
+        if (n >= m_max_circuits || (n % 64 == 0 && is_saturated_before(w->index)))
+            w->is_stopped = true;
     }
-    if (m_max_circuits > 0 && n >= m_max_circuits)
-        m_stop = true;
 }
 
 
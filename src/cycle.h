@@ -7,6 +7,7 @@
 #include <deque>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <vector>
 
 #include "./util.h"
@@ -44,6 +45,9 @@ public:
     int get_all_strong_components(std::vector<directed_graph_t*>& sccgs);
     void delete_vertex(pg::node_idx_t vid);
 
+    /** Gets vertices in this graph in ascending order. */
+    std::vector<pg::node_idx_t> vertices() const;
+
 private:
     void dfs_trav(pg::node_idx_t vid, std::unordered_set<pg::node_idx_t>& visited, std::stack<pg::node_idx_t>& vstack) const;
     void rev_trav(pg::node_idx_t vid, std::unordered_set<pg::node_idx_t>& visited, std::unordered_set<pg::node_idx_t>& vset) const;
@@ -59,33 +63,61 @@ private:
 * @details
 *     The algorithm has been proposed in
 *     "Finding All the Elementary Circuits of a Directed Graph" by Donald B. Johnson in 1975.
+*
+*     The enumeration is split into units of work, each of which is a pair of
+*     a strongly connected component and a vertex from which circuits are searched.
+*     On multi-threading, these units are executed on task_pool_t with work-stealing.
+*     Circuits are merged in the order of the units before being truncated to the limit,
+*     so that the result does not depend on thread scheduling.
 */
 class johnson_t
 {
 public:
     johnson_t();
-    ~johnson_t();
 
     std::list<std::unordered_set<dav::pg::node_idx_t>>* find_all_circuits(
         std::unordered_map<pg::node_idx_t, std::unordered_map<pg::node_idx_t, pg::edge_idx_t>>& input, int* max_circuits);
     void set_multithread(bool multithread);
     void set_multithread();
 
+    /** Sets the number of threads used on multi-threading. */
+    void set_thread_num(int num) { m_thread_num = num; }
+
+    /** Gets the number of circuits found per second in the last call of find_all_circuits(). */
+    double circuits_per_second() const { return m_circuits_per_second; }
+
 private:
-    std::mutex m_mutex;
-    std::unordered_map<pg::node_idx_t, std::unordered_map<pg::node_idx_t, pg::edge_idx_t>> *m_pinput;
-    std::list<std::unordered_set<pg::node_idx_t>> *m_pout;
+    typedef std::list<std::unordered_set<pg::node_idx_t>> circuits_t;
+
+    /** A unit of work, which is a pair of a SCC and a start vertex, with the circuits found from it. */
+    struct work_t
+    {
+        work_t(size_t i, const directed_graph_t *g, pg::node_idx_t v)
+            : index(i), scc(g), start(v), num(0), is_stopped(false) {}
+
+        size_t index;
+        const directed_graph_t *scc; /// The component, which is shared by the works of its vertices.
+        pg::node_idx_t start;
+        circuits_t circuits;
+        std::atomic<int> num; /// The number of circuits found, which is read by the following works.
+        bool is_stopped;
+    };
+
     bool m_multithread;
+    int  m_thread_num;
     int  m_max_circuits;
-    bool m_stop;
-    void do_johnson(pg::node_idx_t vid, directed_graph_t& sccg);
-    void mt_johnson(directed_graph_t *sccg);
-    bool circuit(pg::node_idx_t vid, pg::node_idx_t sid, directed_graph_t& sccg, char *blocked, std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>>& blockmap, std::deque<pg::node_idx_t>& vstack);
+    double m_circuits_per_second;
+    std::deque<work_t> m_works;
+
+    /** Returns whether the works preceding the i-th one have found circuits as many as the limit. */
+    bool is_saturated_before(size_t i) const;
+
+    void do_johnson(work_t *w);
+    bool circuit(pg::node_idx_t vid, pg::node_idx_t sid, const directed_graph_t& sccg, char *blocked, std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>>& blockmap, std::deque<pg::node_idx_t>& vstack, work_t *w);
     void unblock(pg::node_idx_t vid, pg::node_idx_t sid, char *blocked, std::unordered_map<pg::node_idx_t, std::unordered_set<pg::node_idx_t>>& blockmap);
-    void add_cycle(std::deque<pg::node_idx_t>& vstack);
+    void add_cycle(std::deque<pg::node_idx_t>& vstack, work_t *w);
 };
 
-
 }
 
 }
\ No newline at end of file
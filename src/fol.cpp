@@ -89,6 +89,33 @@ string_t rule_t::string() const
 }
 
 
+rule_side_t::rule_side_t(const rule_t &r, is_backward_t backward)
+    : hypothesis(r.hypothesis(backward)), layout(r.evidence(backward))
+{
+    for (const auto &a : layout.fol())
+    {
+        // ATOMS NEGATED AS FAILURE IN EVIDENCE SIDE ARE MOVED TO HYPOTHESIS SIDE
+        if (a.naf())
+            hypothesis.push_back(a);
+
+        // EQUALITIES IN EVIDENCE SIDE ARE INTERPRETED AS CONDITIONS
+        else if (a.is_equality())
+            equalities.push_back(a);
+
+        else
+            evidence.push_back(a);
+    }
+
+    for (auto &a : hypothesis)
+    {
+        // CONVERT NAF ATOMS INTO TYPICAL NEGATED ATOMS
+        if (a.naf())
+            a = a.negate().negate();
+    }
+    hypothesis.sort();
+}
+
+
 template <> void binary_writer_t::write<rule_t>(const rule_t &x)
 {
 	write<std::string>(x.name());
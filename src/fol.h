@@ -131,9 +131,9 @@ public:
 
     /**
     * @brief Constructor only for predicate_library_t.
-    * @param[in] fi File stream of predicate_library_t.
+    * @param[in] br Reader of the data of predicate_library_t.
     */
-    predicate_t(std::ifstream *fi);
+    predicate_t(binary_reader_t &br);
 
     predicate_t(const predicate_t&) = default;
     predicate_t& operator=(const predicate_t&) = default;
@@ -211,6 +211,67 @@ private:
 };
 
 
+/**
+* @brief Array of arguments of an atom.
+* @details
+*   Arguments are stored in the instance itself unless the arity exceeds INLINE_CAPACITY,
+*   which holds for almost all predicates, so that atoms are made without heap allocation.
+*/
+class term_array_t
+{
+public:
+    static const size_t INLINE_CAPACITY = 4; //!< The number of arguments which are stored inline.
+
+    typedef term_t* iterator;
+    typedef const term_t* const_iterator;
+
+    /** @brief Default constructor, that makes empty array. */
+    term_array_t() : m_size(0) {}
+
+    /** @brief Constructs an array of `n` default terms. */
+    explicit term_array_t(size_t n);
+
+    /** @brief Constructs an array which has the same terms as `terms`. */
+    term_array_t(const std::vector<term_t> &terms);
+
+    term_array_t(const term_array_t &x);
+    term_array_t& operator=(const term_array_t &x);
+
+    term_array_t(term_array_t &&x);
+    term_array_t& operator=(term_array_t &&x);
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+
+    inline       term_t* data()       { return (m_size > INLINE_CAPACITY) ? m_overflow.get() : m_inline; }
+    inline const term_t* data() const { return (m_size > INLINE_CAPACITY) ? m_overflow.get() : m_inline; }
+
+    inline       iterator begin()       { return data(); }
+    inline const_iterator begin() const { return data(); }
+    inline       iterator end()       { return data() + m_size; }
+    inline const_iterator end() const { return data() + m_size; }
+
+    inline       term_t& operator[](size_t i)       { return data()[i]; }
+    inline const term_t& operator[](size_t i) const { return data()[i]; }
+
+    /** @brief Gets `i`-th term with bounds checking. */
+    const term_t& at(size_t i) const;
+    term_t& at(size_t i);
+
+    inline       term_t& front()       { return data()[0]; }
+    inline const term_t& front() const { return data()[0]; }
+    inline       term_t& back()       { return data()[m_size - 1]; }
+    inline const term_t& back() const { return data()[m_size - 1]; }
+
+private:
+    void resize(size_t n);
+
+    small_size_t m_size;
+    term_t m_inline[INLINE_CAPACITY];
+    std::unique_ptr<term_t[]> m_overflow;
+};
+
+
 /**
 * @brief Atomic formulae with negation in First-Order Logic with equality.
 * @details
@@ -258,7 +319,7 @@ public:
     static atom_t not_equal(const string_t &s1, const string_t &s2, bool naf = false);
 
     /** @brief Default constructor. */
-    atom_t() {}
+    atom_t() : m_pid(PID_INVALID), m_param(0), m_flags(0) {}
 
     /**
     * @brief Constructor for unit test.
@@ -274,6 +335,14 @@ public:
     */
     atom_t(predicate_id_t pid, const std::vector<term_t> &args, bool naf);
 
+    /**
+    * @brief General constructor.
+    * @param[in] pid ID number of the predicate which an atom constructed will have.
+    * @param[in] args Arguments which an atom constructed will have.
+    * @param[in] naf Whether an atom constructed is negated with NAF.
+    */
+    atom_t(predicate_id_t pid, const term_array_t &args, bool naf);
+
     /**
     * @brief General constructor.
     * @param[in] s String expression of the predicate which an atom constructed will have.
@@ -309,17 +378,17 @@ public:
 
     inline operator std::string() const { return string(); }
 
-    /** @brief Gets predicate_t instance which this owns. */
-    inline const predicate_t& predicate() const { return m_predicate; }
-
-    /** @brief Refers predicate_t instance which this owns. */
-    inline       predicate_t& predicate() { return m_predicate; }
+    /**
+    * @brief Gets the predicate of this formulae.
+    * @details This refers to predicate_library_t, so use pid(), arity() or neg() in hot paths.
+    */
+    const predicate_t& predicate() const;
 
     /** @brief Gets arguments of this formulae. */
-    inline const std::vector<term_t>& terms() const { return m_terms; }
+    inline const term_array_t& terms() const { return m_terms; }
 
     /** @brief Refers arguments of this formulae. */
-    inline       std::vector<term_t>& terms() { return m_terms; }
+    inline       term_array_t& terms() { return m_terms; }
 
     /**
     * @brief Gets `i`-th argument.
@@ -345,31 +414,37 @@ public:
     * @brief Checks whether negated with NAF.
     * @return True if negated with NAF, otherwise false.
     */
-    inline bool naf() const { return m_naf; }
+    inline bool naf() const { return (m_flags & FLAG_NAF) != 0; }
 
     /**
     * @brief Checks whether negated with typical negation.
     * @return True if negated with typical negation, otherwise false.
     */
-    inline bool neg() const { return m_predicate.neg(); }
+    inline bool neg() const { return (m_flags & FLAG_NEG) != 0; }
 
     /** @brief Gets the string of parameters. */
-    inline const string_t& param() const { return m_param; }
+    const string_t& param() const;
 
-    /** @brief Refers the string of parameters. */
-    inline string_t& param() { return m_param; }
+    /** @brief Sets the string of parameters. */
+    void set_param(const string_t &p);
 
     /** @brief Gets ID number of predicate. */
-    inline const predicate_id_t& pid() const { return predicate().pid(); }
+    inline predicate_id_t pid() const { return m_pid; }
+
+    /**
+    * @brief Replaces ID number of predicate.
+    * @details This is only for renumbering predicates, so the predicate itself must not change.
+    */
+    inline void set_pid(predicate_id_t pid) { m_pid = static_cast<uint32_t>(pid); }
 
     /** @brief Gets arity, the number of arguments. */
-    inline const arity_t& arity() const { return predicate().arity(); }
+    inline arity_t arity() const { return static_cast<arity_t>(m_terms.size()); }
 
     /**
     * @brief Checks whether this is any of equality and negated equality.
     * @return True if pid() is equal to PID_EQ or PID_NEQ, otherwise false.
     */
-    inline bool is_equality() const { return predicate().is_equality(); }
+    inline bool is_equality() const { return m_pid == PID_EQ or m_pid == PID_NEQ; }
 
     /**
     * @brief Generates atom to negate this with typical negation.
@@ -398,7 +473,7 @@ public:
     * @brief Checks validity.
     * @return True if predicate is valid and the number of arguments is equal to arity, otherwise false.
     */
-    inline bool good() const { return m_predicate.good() and (arity() == m_terms.size()); }
+    bool good() const;
 
     /**
     * @brief Checks this is universally quantified.
@@ -422,14 +497,31 @@ public:
     void regularize();
 
 private:
+    /** @brief Bits of m_flags. */
+    enum flag_e : uint8_t
+    {
+        FLAG_NAF = 0b0001, //!< Negated with NAF.
+        FLAG_NEG = 0b0010  //!< Negated with typical negation, which is cached from the predicate.
+    };
+
+    /** Gets the ID of `p` among strings of parameters, with assigning one if needed. */
+    static uint32_t param2id(const string_t &p);
+
     int cmp(const atom_t &x) const;
+    void set_predicate(const predicate_t &p);
 
-    predicate_t m_predicate;
-    std::vector<term_t> m_terms;
+    /** Sets the predicate from its ID, which looks up predicate_library_t without lock. */
+    void set_predicate(predicate_id_t pid);
 
-    bool m_naf;
+    /** Mutex for param2id(). Strings of parameters are read without lock. */
+    static std::mutex ms_mutex_param;
+    static std::unordered_map<std::string, uint32_t> ms_param2id;
+    static concurrent_array_t<string_t> ms_params;
 
-    string_t m_param;
+    uint32_t m_pid;
+    uint32_t m_param; /// Index of the string of parameters in ms_params.
+    term_array_t m_terms;
+    uint8_t m_flags;
 };
 
 /** @brief Prints atom_t instance to output stream. */
@@ -477,9 +569,9 @@ public:
 
     /**
     * @brief Constructor for binary data.
-    * @param[in] fi Input stream from which constructor reads data.
+    * @param[in] br Reader from which constructor reads data.
     */
-    predicate_property_t(std::ifstream *fi);
+    predicate_property_t(binary_reader_t &br);
 
     /**
     * @brief Writes predicate-property as binary data to file stream.
@@ -561,6 +653,9 @@ public:
     /** Loads data from filepath(). */
     void load();
 
+    /** Loads data from given memory, such as a section of the image of KB, instead of filepath(). */
+    void load(const char *data, size_t size);
+
     /** Writes data to filepath(). */
     void write() const;
 
@@ -591,6 +686,24 @@ public:
     */
     void add_property(const predicate_property_t &prp);
 
+    /**
+    * @brief Makes add() called in the current thread record IDs of predicates in `log`.
+    * @param[out] log List to which IDs are appended, or nullptr to stop recording.
+    * @details IDs are recorded on every call, regardless of whether the predicate is new.
+    */
+    static void record(std::vector<predicate_id_t> *log);
+
+    /**
+    * @brief Renumbers predicates whose IDs are `n` or more.
+    * @param[in] n The number of predicates which keep their IDs.
+    * @param[in] order Current IDs of the predicates to renumber, in the new order.
+    * @return Map from current IDs to new IDs.
+    * @details
+    *   This is used to number predicates added from multiple threads deterministically.
+    *   Every predicate whose ID is `n` or more must be in `order` exactly once.
+    */
+    std::vector<predicate_id_t> reorder(predicate_id_t n, const std::vector<predicate_id_t> &order);
+
     /**
     * @brief Gets the list of predicates.
     * @details The order of the list follows the order of IDs of predicates.
@@ -614,6 +727,27 @@ public:
     */
     const predicate_t& id2pred(predicate_id_t pid) const;
 
+    /** ID, arity and negation of a predicate. */
+    struct signature_t
+    {
+        signature_t() : pid(PID_INVALID), arity(0), neg(false) {}
+        signature_t(const predicate_t &p) : pid(p.pid()), arity(p.arity()), neg(p.neg()) {}
+
+        predicate_id_t pid;
+        arity_t arity;
+        bool neg;
+    };
+
+    /**
+    * @brief Gets arity and negation of the predicate of given Id number without lock.
+    * @param[in] pid Id number of the predicate.
+    * @return Signature of the predicate if exists, otherwise one of invalid predicate.
+    */
+    inline signature_t signature(predicate_id_t pid) const
+    {
+        return (pid < m_signatures.size()) ? m_signatures[pid] : m_signatures[PID_INVALID];
+    }
+
     /**
     * @brief Get property of the predicate of given Id number.
     * @param[in] pid Id number of the target predicate.
@@ -624,6 +758,9 @@ public:
 private:
     predicate_library_t(const filepath_t &p) : m_filename(p) {}
 
+    /** Reads data written by write() from given reader. */
+    void read(binary_reader_t &br);
+
     static std::unique_ptr<predicate_library_t> ms_instance; /// For singleton pattern.
 
     /** Mutex for add(), pred2id() and id2pred(). */
@@ -634,6 +771,9 @@ private:
     std::deque<predicate_t> m_predicates;
     hash_map_t<string_t, predicate_id_t> m_pred2id;
 
+    /** Signatures of predicates indexed by their IDs, which are read without ms_mutex. */
+    concurrent_array_t<signature_t> m_signatures;
+
     hash_map_t<predicate_id_t, predicate_property_t> m_properties;
 };
 
@@ -796,11 +936,17 @@ template <> struct hash<dav::atom_t>
 {
     size_t operator() (const dav::atom_t &x) const
     {
-        dav::fnv_1::hash_t<size_t> hasher;
-        hasher.read((uint8_t*)&x.predicate().pid(), sizeof(dav::predicate_id_t) / sizeof(uint8_t));
-        hasher.read((uint8_t*)&x.predicate().arity(), sizeof(dav::arity_t) / sizeof(uint8_t));
-        for (const auto &t : x.terms())
-            hasher.read((uint8_t*)&t.get_hash(), sizeof(unsigned) / sizeof(uint8_t));
+        dav::word_hash_t hasher;
+        const auto &terms = x.terms();
+        hasher.read(x.pid(), x.arity());
+
+        // HASHES OF TERMS ARE READ TWO AT A TIME.
+        size_t i = 0;
+        for (; i + 1 < terms.size(); i += 2)
+            hasher.read(terms[i].get_hash(), terms[i + 1].get_hash());
+        if (i < terms.size())
+            hasher.read(terms[i].get_hash());
+
         return hasher.hash();
     }
 };
@@ -810,12 +956,18 @@ template <> struct hash<dav::conjunction_t>
 {
     size_t operator() (const dav::conjunction_t &x) const
     {
-        dav::fnv_1::hash_t<size_t> hasher;
+        dav::word_hash_t hasher;
         for (const auto &a : x)
         {
-            hasher.read((uint8_t*)&a.pid(), sizeof(dav::predicate_id_t) / sizeof(uint8_t));
-            for (const auto &t : a.terms())
-                hasher.read((uint8_t*)&t.get_hash(), sizeof(unsigned) / sizeof(uint8_t));
+            // THE PREDICATE IS READ WITH THE FIRST TERM, AND THE OTHERS TWO AT A TIME.
+            const auto &terms = a.terms();
+            hasher.read(a.pid(), terms.empty() ? 0u : terms[0].get_hash());
+
+            size_t i = 1;
+            for (; i + 1 < terms.size(); i += 2)
+                hasher.read(terms[i].get_hash(), terms[i + 1].get_hash());
+            if (i < terms.size())
+                hasher.read(terms[i].get_hash());
         }
         return hasher.hash();
     }
@@ -910,6 +1062,48 @@ public:
 class grounder_t
 {
 public:
+    /**
+    * @brief Conjunction in rules compiled for grounding.
+    * @details
+    *   Each variable is given a slot, so that grounding assigns terms to an array of slots.
+    *   Whether each argument is abstract is also looked up in advance.
+    */
+    class layout_t
+    {
+    public:
+        /** @param fol The conjunction in rules. */
+        layout_t(const conjunction_t &fol);
+
+        /** Returns the conjunction in rules. */
+        inline const conjunction_t& fol() const { return m_fol; }
+
+        /** Returns the number of slots, which is the number of distinct variables. */
+        inline size_t num_slots() const { return m_variables.size(); }
+
+    private:
+        friend class grounder_t;
+
+        struct argument_t
+        {
+            index_t slot; //!< Index of the slot, or -1 for constants.
+            bool is_abstract;
+        };
+
+        /** Numerical variable such as `x+1`, whose base is assigned by grounding. */
+        struct numerical_t
+        {
+            index_t slot;
+            int margin;
+            term_t base;
+        };
+
+        conjunction_t m_fol;
+        std::vector<size_t> m_offsets;     //!< Offset of arguments of each atom in m_args.
+        std::vector<argument_t> m_args;    //!< Arguments of all atoms.
+        std::vector<term_t> m_variables;   //!< Variable of each slot.
+        std::vector<numerical_t> m_numericals;
+    };
+
     /**
     * @brief Constructor.
     * @param evd The conjunction in proof-graph.
@@ -917,6 +1111,13 @@ public:
     */
     grounder_t(const conjunction_t &evd, const conjunction_t &fol);
 
+    /**
+    * @brief Constructor with a conjunction compiled in advance.
+    * @param evd The conjunction in proof-graph.
+    * @param fol The conjunction in rules, which is not referred to after construction.
+    */
+    grounder_t(const conjunction_t &evd, const layout_t &fol);
+
     /** Returns the substitution-map for this grounding. */
     const substitution_map_t& substitution() const { return m_subs; }
 
@@ -930,10 +1131,7 @@ public:
     bool good() const { return m_good; }
 
 private:
-    void init();
-
-    conjunction_t m_fol;
-    conjunction_t m_evd;
+    void init(const conjunction_t &evd, const layout_t &fol);
 
     bool m_good;
     substitution_map_t m_subs;
@@ -942,6 +1140,25 @@ private:
 };
 
 
+/**
+* @brief A side of a rule preprocessed for chaining in one direction.
+* @details
+*   This depends only on the rule and the direction,
+*   so that it is shared among chainers via kb::rule_library_t::side().
+*/
+class rule_side_t
+{
+public:
+    rule_side_t(const rule_t &r, is_backward_t backward);
+
+    conjunction_t evidence;   //!< Atoms to be grounded to target nodes.
+    conjunction_t hypothesis; //!< Atoms to be hypothesized, including NAF-atoms in evidence as negated atoms, sorted.
+    conjunction_t equalities; //!< Equalities in evidence, which are conditions if all of their terms are bound.
+
+    grounder_t::layout_t layout; //!< The layout of the evidence on grounding.
+};
+
+
 /** Sets of arguments that are unifiable each other. */
 class term_cluster_t
 {
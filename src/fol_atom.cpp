@@ -3,9 +3,108 @@
 namespace dav
 {
 
+
+term_array_t::term_array_t(size_t n)
+    : m_size(0)
+{
+    resize(n);
+}
+
+
+term_array_t::term_array_t(const std::vector<term_t> &terms)
+    : m_size(0)
+{
+    resize(terms.size());
+    std::copy(terms.begin(), terms.end(), begin());
+}
+
+
+term_array_t::term_array_t(const term_array_t &x)
+    : m_size(0)
+{
+    resize(x.size());
+    std::copy(x.begin(), x.end(), begin());
+}
+
+
+term_array_t& term_array_t::operator=(const term_array_t &x)
+{
+    if (this != &x)
+    {
+        resize(x.size());
+        std::copy(x.begin(), x.end(), begin());
+    }
+    return *this;
+}
+
+
+term_array_t::term_array_t(term_array_t &&x)
+    : m_size(x.m_size), m_overflow(std::move(x.m_overflow))
+{
+    if (m_size <= INLINE_CAPACITY)
+        std::copy(x.m_inline, x.m_inline + m_size, m_inline);
+    x.m_size = 0;
+}
+
+
+term_array_t& term_array_t::operator=(term_array_t &&x)
+{
+    if (this != &x)
+    {
+        m_size = x.m_size;
+        m_overflow = std::move(x.m_overflow);
+        if (m_size <= INLINE_CAPACITY)
+            std::copy(x.m_inline, x.m_inline + m_size, m_inline);
+        x.m_size = 0;
+    }
+    return *this;
+}
+
+
+const term_t& term_array_t::at(size_t i) const
+{
+    if (i >= m_size)
+        throw std::out_of_range(format("term_array_t::at: %d >= %d", (int)i, (int)m_size));
+    return data()[i];
+}
+
+
+term_t& term_array_t::at(size_t i)
+{
+    if (i >= m_size)
+        throw std::out_of_range(format("term_array_t::at: %d >= %d", (int)i, (int)m_size));
+    return data()[i];
+}
+
+
+void term_array_t::resize(size_t n)
+{
+    assert(n < 256);
+
+    // THE CONTENTS ARE NOT KEPT, SINCE THEY ARE OVERWRITTEN BY CALLERS.
+    if (n > INLINE_CAPACITY)
+    {
+        if (m_size < n or not m_overflow)
+            m_overflow.reset(new term_t[n]);
+    }
+    else
+        m_overflow.reset();
+
+    m_size = static_cast<small_size_t>(n);
+}
+
+
+std::mutex atom_t::ms_mutex_param;
+std::unordered_map<std::string, uint32_t> atom_t::ms_param2id{ { "", 0 } };
+concurrent_array_t<string_t> atom_t::ms_params(1);
+
+
 atom_t atom_t::equal(const term_t &t1, const term_t &t2, bool naf)
 {
-    return atom_t(PID_EQ, std::vector<term_t>{t1, t2}, naf);
+    term_array_t terms(2);
+    terms[0] = t1;
+    terms[1] = t2;
+    return atom_t(PID_EQ, terms, naf);
 }
 
 
@@ -17,7 +116,10 @@ atom_t atom_t::equal(const string_t &t1, const string_t &t2, bool naf)
 
 atom_t atom_t::not_equal(const term_t &t1, const term_t &t2, bool naf)
 {
-    return atom_t(PID_NEQ, std::vector<term_t>{t1, t2}, naf);
+    term_array_t terms(2);
+    terms[0] = t1;
+    terms[1] = t2;
+    return atom_t(PID_NEQ, terms, naf);
 }
 
 
@@ -29,18 +131,28 @@ atom_t atom_t::not_equal(const string_t &t1, const string_t &t2, bool naf)
 
 atom_t::atom_t(
     predicate_id_t pid, const std::vector<term_t> &terms, bool naf)
-    : m_predicate(pid), m_terms(terms), m_naf(naf)
+    : m_pid(pid), m_param(0), m_terms(terms), m_flags(naf ? FLAG_NAF : 0)
 {
+    set_predicate(pid);
+    regularize();
+}
+
+
+atom_t::atom_t(
+    predicate_id_t pid, const term_array_t &terms, bool naf)
+    : m_pid(pid), m_param(0), m_terms(terms), m_flags(naf ? FLAG_NAF : 0)
+{
+    set_predicate(pid);
     regularize();
 }
 
 
 atom_t::atom_t(string_t str)
-    : m_naf(false)
+    : m_param(0), m_flags(0)
 {
     if (str.startswith("not "))
     {
-        m_naf = true;
+        m_flags |= FLAG_NAF;
         str = str.slice(4).strip(" ");
     }
 
@@ -62,9 +174,10 @@ atom_t::atom_t(string_t str)
     else if (not str.parse_as_function(&pred, &args))
         throw exception_t(format("Cannot parse as an atom: \"%s\"", str.c_str()));
 
-    m_predicate = predicate_t(pred, static_cast<arity_t>(args.size()));
-    for (const auto &a : args)
-        m_terms.push_back(term_t(a));
+    m_terms = term_array_t(args.size());
+    for (size_t i = 0; i < args.size(); ++i)
+        m_terms[i] = term_t(args[i]);
+    set_predicate(predicate_t(pred, static_cast<arity_t>(args.size())));
 
     regularize();
 }
@@ -72,9 +185,9 @@ atom_t::atom_t(string_t str)
 
 atom_t::atom_t(
     const string_t &pred, const std::vector<term_t> &terms, bool naf)
-    : m_predicate(pred, static_cast<arity_t>(terms.size())),
-	m_terms(terms), m_naf(naf)
+    : m_param(0), m_terms(terms), m_flags(naf ? FLAG_NAF : 0)
 {
+    set_predicate(predicate_t(pred, static_cast<arity_t>(terms.size())));
     regularize();
 }
 
@@ -82,40 +195,82 @@ atom_t::atom_t(
 atom_t::atom_t(
     const string_t &pred,
     const std::initializer_list<std::string> &terms, bool naf)
-    : m_predicate(pred, static_cast<arity_t>(terms.size())), m_naf(naf)
+    : m_param(0), m_terms(terms.size()), m_flags(naf ? FLAG_NAF : 0)
 {
-    for (auto t : terms)
-        m_terms.push_back(term_t(t));
+    size_t i = 0;
+    for (const auto &t : terms)
+        m_terms[i++] = term_t(t);
+
+    set_predicate(predicate_t(pred, static_cast<arity_t>(terms.size())));
     regularize();
 }
 
 
 atom_t::atom_t(binary_reader_t &r)
+    : m_param(0), m_flags(0)
 {
 	predicate_id_t pid = r.get<predicate_id_t>();
 	assert(pid != PID_INVALID);
-	m_predicate = predicate_t(pid);
+	const predicate_t &p = plib()->id2pred(pid);
 
 	// READ ARGUMENTS
-	m_terms.assign(m_predicate.arity(), term_t());
-	for (int i = 0; i<m_predicate.arity(); ++i)
-		m_terms[i] = term_t(r.get<std::string>());
+	m_terms = term_array_t(p.arity());
+	for (auto &t : m_terms)
+		t = term_t(r.get<std::string>());
+	set_predicate(p);
 
 	// READ NEGATION
 	char flag = r.get<char>();
-	m_naf = ((flag & 0b0001) != 0);
+	if ((flag & 0b0001) != 0) m_flags |= FLAG_NAF;
 
 	// READ PARAMETER
-	r.read<std::string>(&m_param);
+	set_param(r.get<std::string>());
 
     regularize();
 }
 
 
+const predicate_t& atom_t::predicate() const
+{
+    return plib()->id2pred(m_pid);
+}
+
+
+const string_t& atom_t::param() const
+{
+    return ms_params[m_param];
+}
+
+
+void atom_t::set_param(const string_t &p)
+{
+    m_param = param2id(p);
+}
+
+
+uint32_t atom_t::param2id(const string_t &p)
+{
+    if (p.empty()) return 0;
+
+    std::lock_guard<std::mutex> lock(ms_mutex_param);
+    auto found = ms_param2id.find(p);
+
+    if (found != ms_param2id.end())
+        return found->second;
+    else
+    {
+        uint32_t id = static_cast<uint32_t>(ms_params.size());
+        ms_params.push_back(p);
+        ms_param2id[p] = id;
+        return id;
+    }
+}
+
+
 int atom_t::cmp(const atom_t &x) const
 {
-    if (m_naf != x.m_naf) return m_naf ? -1 : 1;
-    if (m_predicate != x.m_predicate) return (m_predicate > x.m_predicate) ? 1 : -1;
+    if (naf() != x.naf()) return naf() ? -1 : 1;
+    if (m_pid != x.m_pid) return (m_pid > x.m_pid) ? 1 : -1;
 
     for (size_t i = 0; i < m_terms.size(); i++)
     {
@@ -127,14 +282,52 @@ int atom_t::cmp(const atom_t &x) const
 }
 
 
+void atom_t::set_predicate(predicate_id_t pid)
+{
+    auto sig = plib()->signature(pid);
+
+    if (sig.arity != arity())
+    {
+        throw exception_t(format(
+            "Inconsistency between arity and arguments size: \"%s\"",
+            plib()->id2pred(pid).string().c_str()));
+    }
+
+    m_pid = static_cast<uint32_t>(sig.pid);
+
+    if (sig.neg)
+        m_flags |= FLAG_NEG;
+    else
+        m_flags &= ~FLAG_NEG;
+}
+
+
+void atom_t::set_predicate(const predicate_t &p)
+{
+    if (p.arity() != arity())
+    {
+        throw exception_t(format(
+            "Inconsistency between arity and arguments size: \"%s\"",
+            p.string().c_str()));
+    }
+
+    m_pid = static_cast<uint32_t>(p.pid());
+
+    if (p.neg())
+        m_flags |= FLAG_NEG;
+    else
+        m_flags &= ~FLAG_NEG;
+}
+
+
 atom_t atom_t::negate() const
 {
     atom_t out(*this);
 
     if (naf())
-        out.m_naf = false; // not !p = p
+        out.m_flags &= ~FLAG_NAF; // not !p = p
     else
-        out.m_predicate = predicate().negate();
+        out.set_predicate(predicate().negate());
 
     return out;
 }
@@ -145,8 +338,8 @@ atom_t atom_t::remove_negation() const
     atom_t out(*this);
 
     if (neg())
-        out.m_predicate = predicate().negate();
-    out.m_naf = false;
+        out.set_predicate(predicate().negate());
+    out.m_flags &= ~FLAG_NAF;
 
     return out;
 }
@@ -176,6 +369,13 @@ void atom_t::substitute(const substitution_map_t &sub, bool do_throw_exception)
 }
 
 
+bool atom_t::good() const
+{
+    const predicate_t &p = predicate();
+    return p.good() and p.arity() == arity();
+}
+
+
 bool atom_t::is_universally_quantified() const
 {
     for (const auto &t : m_terms)
@@ -201,7 +401,7 @@ string_t atom_t::string(bool do_print_param) const
     {
         if (neg()) out += "!";
 
-        out += m_predicate.predicate() + '(';
+        out += predicate().predicate() + '(';
         for (auto it = terms().begin(); it != terms().end(); it++)
         {
             out += it->string();
@@ -220,14 +420,7 @@ string_t atom_t::string(bool do_print_param) const
 
 void atom_t::regularize()
 {
-    if (arity() != terms().size())
-    {
-        throw exception_t(format(
-            "Inconsistency between arity and arguments size: \"%s\"",
-            string().c_str()));
-    }
-
-	auto prp = predicate_library_t::instance()->find_property(predicate().pid());
+	auto prp = predicate_library_t::instance()->find_property(pid());
 	if (prp == nullptr) return;
 
     for (const auto &p : prp->properties())
@@ -249,8 +442,8 @@ std::ostream& operator<<(std::ostream& os, const atom_t& lit)
 
 template <> void binary_writer_t::write<atom_t>(const atom_t &x)
 {
-	assert(x.predicate().pid() != PID_INVALID);
-	write<predicate_id_t>(x.predicate().pid());
+	assert(x.pid() != PID_INVALID);
+	write<predicate_id_t>(x.pid());
 
 	// WRITE ARGUMENTS
 	for (term_idx_t i = 0; i < static_cast<term_idx_t>(x.terms().size()); ++i)
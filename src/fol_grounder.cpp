@@ -4,24 +4,75 @@ namespace dav
 {
 
 
+grounder_t::layout_t::layout_t(const conjunction_t &fol)
+    : m_fol(fol)
+{
+    for (const auto &a : m_fol)
+    {
+        auto *prp = plib()->find_property(a.pid());
+        m_offsets.push_back(m_args.size());
+
+        for (term_idx_t j = 0; j < a.arity(); ++j)
+        {
+            const term_t &t = a.term(j);
+            argument_t arg{ -1, (prp != nullptr and prp->has(PRP_ABSTRACT, j)) };
+
+            if (not t.is_constant())
+            {
+                // VARIABLES IN A RULE ARE SO FEW THAT LINEAR SEARCH IS ENOUGH.
+                auto found = std::find(m_variables.begin(), m_variables.end(), t);
+                arg.slot = static_cast<index_t>(found - m_variables.begin());
+
+                if (found == m_variables.end())
+                {
+                    m_variables.push_back(t);
+
+                    numerical_t num{ arg.slot, 0, term_t() };
+                    if (t.parse_as_numerical_variable(&num.margin, &num.base))
+                        m_numericals.push_back(num);
+                }
+            }
+
+            m_args.push_back(arg);
+        }
+    }
+}
+
+
 grounder_t::grounder_t(const conjunction_t &evd, const conjunction_t &fol)
-    : m_evd(evd), m_fol(fol), m_good(true)
+    : m_good(true)
+{
+    init(evd, layout_t(fol));
+}
+
+
+grounder_t::grounder_t(const conjunction_t &evd, const layout_t &fol)
+    : m_good(true)
 {
-    init();
+    init(evd, fol);
 }
 
 
-void grounder_t::init()
+void grounder_t::init(const conjunction_t &evd, const layout_t &layout)
 {
-    assert(m_fol.size() >= m_evd.size());
+    const conjunction_t &fol = layout.fol();
+    assert(fol.size() >= evd.size());
 
-    std::unordered_set<term_t> abstract_terms;
+    // TERMS ASSIGNED TO EACH SLOT OF VARIABLES, AND WHETHER THEY HAVE BEEN ASSIGNED.
+    std::vector<std::pair<term_t, bool>> slots(layout.num_slots(), std::make_pair(term_t(), false));
+
+    // ABSTRACT TERMS ARE SO FEW THAT LINEAR SEARCH IS ENOUGH.
+    std::vector<term_t> abstract_terms;
+    auto is_abstract = [&abstract_terms](const term_t &t)
+    {
+        return std::find(abstract_terms.begin(), abstract_terms.end(), t) != abstract_terms.end();
+    };
 
-    for (size_t i = 0; i < m_evd.size(); ++i)
+    for (size_t i = 0; i < evd.size(); ++i)
     {
-        const atom_t &a1(m_fol.at(i)), &a2(m_evd.at(i));
+        const atom_t &a1(fol.at(i)), &a2(evd.at(i));
 
-        if (a1.predicate() != a2.predicate())
+        if (a1.pid() != a2.pid())
 		{
 			throw exception_t(
 				format("grounder_t: disagreement of predicate, \"%s\" and \"%s\"",
@@ -34,13 +85,14 @@ void grounder_t::init()
 				"grounder_t: invalid atom \"%s\"", a1.string().c_str()));
 		}
 
+        const layout_t::argument_t *args = &layout.m_args.at(layout.m_offsets.at(i));
+
         for (term_idx_t j = 0; j < a1.arity(); ++j)
         {
             const term_t &t1(a1.term(j)), &t2(a2.term(j));
 
-            auto *prp = plib()->find_property(a1.pid());
-            if (prp != nullptr and prp->has(PRP_ABSTRACT, j))
-                abstract_terms.insert(t2);
+            if (args[j].is_abstract)
+                abstract_terms.push_back(t2);
 
             if (not t1.is_unifiable_with(t2))
             {
@@ -54,16 +106,16 @@ void grounder_t::init()
             }
             else
             {
-                auto found = m_subs.find(t1);
+                index_t slot = args[j].slot;
 
-                if (found == m_subs.end())
-                    m_subs[t1] = t2;
+                if (not slots[slot].second)
+                    slots[slot] = std::make_pair(t2, true);
 
                 else // [̕ϐɑ΂āA̕ϐΉꍇ
                 {
-                    const term_t &t3(found->second);
-                    bool is_abs2(abstract_terms.count(t2) > 0);
-                    bool is_abs3(abstract_terms.count(t3) > 0);
+                    const term_t t3(slots[slot].first);
+                    bool is_abs2(is_abstract(t2));
+                    bool is_abs3(is_abstract(t3));
 
                     if (not t3.is_unifiable_with(t2))
                     {
@@ -84,9 +136,9 @@ void grounder_t::init()
                             m_products.insert(atom_t::equal(t3, t2));
 
                         if (is_abs2 == is_abs3)
-                            m_subs[t1] = std::min(t2, t3);
+                            slots[slot].first = std::min(t2, t3);
                         else
-                            m_subs[t1] = (is_abs2 ? t3 : t2);
+                            slots[slot].first = (is_abs2 ? t3 : t2);
                     }
                 }
             }
@@ -95,28 +147,31 @@ void grounder_t::init()
         }
     }
 
-	// EXPAND MAP WITH NUMERICAL INFORMATION
-	{
-		std::list<std::pair<term_t, term_t>> added;
-		int x, m;
-		term_t b;
+    if (not m_good)
+    {
+        m_products.clear();
+        return;
+    }
 
-		for (const auto &p : m_subs)
-		{
-			if (p.first.parse_as_numerical_variable(&m, &b) and
-				p.second.parse_as_numerical_constant(&x))
-			{
-				added.push_back(std::make_pair(b, term_t(format("%d", (x - m)))));
-			}
-		}
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].second)
+            m_subs[layout.m_variables[i]] = slots[i].first;
+    }
 
-		m_subs.insert(added.begin(), added.end());
+	// EXPAND MAP WITH NUMERICAL INFORMATION
+	for (const auto &num : layout.m_numericals)
+	{
+		int x;
+		const auto &slot = slots[num.slot];
+		if (slot.second and slot.first.parse_as_numerical_constant(&x))
+			m_subs.insert(std::make_pair(num.base, term_t(format("%d", (x - num.margin)))));
 	}
 
     // CHECK VALIDITY OF CONDITIONS FOR EQUALITY
-    for (size_t i = m_evd.size(); i < m_fol.size(); ++i)
+    for (size_t i = evd.size(); i < fol.size(); ++i)
     {
-        atom_t a = m_fol.at(i);
+        atom_t a = fol.at(i);
         assert(a.is_equality() or a.naf());
 
         if (a.is_equality() and not a.naf())
@@ -46,15 +46,10 @@ predicate_t::predicate_t(predicate_id_t pid)
 }
 
 
-predicate_t::predicate_t(std::ifstream *fi)
+predicate_t::predicate_t(binary_reader_t &br)
 {
-    char line[256];
-    small_size_t num_char;
-
-    fi->read((char*)&num_char, sizeof(small_size_t));
-    fi->read(line, sizeof(char)* num_char);
-
-    line[num_char] = '\0';
+    string_t line;
+    br.read<string_t>(&line);
     parse(line, &m_pred, &m_arity);
     set_negation();
 
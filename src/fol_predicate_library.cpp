@@ -8,6 +8,13 @@ std::unique_ptr<predicate_library_t> predicate_library_t::ms_instance;
 std::mutex predicate_library_t::ms_mutex;
 
 
+namespace
+{
+/** The list to which predicate_library_t::add() in the current thread records IDs. */
+thread_local std::vector<predicate_id_t> *g_log = nullptr;
+}
+
+
 void predicate_library_t::initialize(const filepath_t &p)
 {
     console_t::auto_indent_t ai;
@@ -36,8 +43,10 @@ void predicate_library_t::init()
     m_predicates.clear();
     m_pred2id.clear();
     m_properties.clear();
+    m_signatures.clear();
 
     m_predicates.push_back(predicate_t());
+    m_signatures.push_back(signature_t(m_predicates.back()));
     m_pred2id[""] = PID_INVALID;
 
     predicate_t("=", 2);
@@ -54,28 +63,43 @@ void predicate_library_t::load()
 {
     LOG_MIDDLE(format("loading predicate-library: \"%s\"", m_filename.c_str()));
 
-    std::ifstream fi(m_filename.c_str(), std::ios::in | std::ios::binary);
-    init();
-
-    if (fi.fail())
+    if (not m_filename.find_file())
         throw exception_t("Failed to open " + m_filename);
 
+    binary_reader_t br(m_filename);
+    read(br);
+}
+
+
+void predicate_library_t::load(const char *data, size_t size)
+{
+    LOG_MIDDLE(format("loading predicate-library from the image: \"%s\"", m_filename.c_str()));
+
+    // THE SECTION IS READ IN PLACE, WITHOUT BEING COPIED INTO A STREAM.
+    binary_reader_t br(data, size);
+    read(br);
+}
+
+
+void predicate_library_t::read(binary_reader_t &br)
+{
+    init();
+
     {
         // READ PREDICATES LIST
-        size_t num;
-        fi.read((char*)&num, sizeof(size_t));
+        size_t num = br.get<size_t>();
+        m_pred2id.reserve(m_pred2id.size() + num);
 
         for (size_t i = 0; i < num; ++i)
-            add(predicate_t(&fi));
+            add(predicate_t(br));
     }
 
     {
         // READ PREDICATE PROPERTIES
-        size_t num;
-        fi.read((char*)&num, sizeof(size_t));
+        size_t num = br.get<size_t>();
 
         for (size_t i = 0; i < num; ++i)
-            add_property(predicate_property_t(&fi));
+            add_property(predicate_property_t(br));
     }
 }
 
@@ -116,7 +140,10 @@ predicate_id_t predicate_library_t::add(const predicate_t &p)
         return -1;
 
     if (found != m_pred2id.end())
+    {
+        if (g_log) g_log->push_back(found->second);
         return found->second;
+    }
     else
     {
         predicate_id_t pid = m_predicates.size();
@@ -124,9 +151,11 @@ predicate_id_t predicate_library_t::add(const predicate_t &p)
         m_pred2id.insert(std::make_pair(p.string(), pid));
         m_predicates.push_back(p);
         m_predicates.back().pid() = pid;
+        m_signatures.push_back(signature_t(m_predicates.back()));
 
         LOG_DEBUG(format("added predicate: \"%s\"", p.string().c_str()));
 
+        if (g_log) g_log->push_back(pid);
         return pid;
     }
 }
@@ -134,10 +163,10 @@ predicate_id_t predicate_library_t::add(const predicate_t &p)
 
 predicate_id_t predicate_library_t::add(const atom_t &a)
 {
-    if (a.predicate().pid() == PID_INVALID)
+    if (a.pid() == PID_INVALID)
         return add(a.predicate());
     else
-        return a.predicate().pid();
+        return a.pid();
 }
 
 
@@ -150,6 +179,40 @@ void predicate_library_t::add_property(const predicate_property_t &fp)
 }
 
 
+void predicate_library_t::record(std::vector<predicate_id_t> *log)
+{
+    g_log = log;
+}
+
+
+std::vector<predicate_id_t> predicate_library_t::reorder(
+    predicate_id_t n, const std::vector<predicate_id_t> &order)
+{
+    std::lock_guard<std::mutex> lock(ms_mutex);
+
+    assert(n + order.size() == m_predicates.size());
+
+    std::vector<predicate_id_t> out(m_predicates.size());
+    std::vector<predicate_t> moved(m_predicates.begin() + n, m_predicates.end());
+
+    for (predicate_id_t i = 0; i < n; ++i)
+        out[i] = i;
+
+    for (predicate_id_t i = 0; i < order.size(); ++i)
+    {
+        predicate_t &p = moved.at(order[i] - n);
+
+        out[order[i]] = n + i;
+        p.pid() = n + i;
+        m_pred2id[p.string()] = n + i;
+        m_predicates[n + i] = p;
+        m_signatures[n + i] = signature_t(p);
+    }
+
+    return out;
+}
+
+
 predicate_id_t predicate_library_t::pred2id(const string_t &pred) const
 {
     std::lock_guard<std::mutex> lock(ms_mutex);
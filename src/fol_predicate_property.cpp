@@ -18,20 +18,17 @@ predicate_property_t::predicate_property_t(predicate_id_t pid, const properties_
 }
 
 
-predicate_property_t::predicate_property_t(std::ifstream *fi)
+predicate_property_t::predicate_property_t(binary_reader_t &br)
 {
-    fi->read((char*)&m_pid, sizeof(predicate_id_t));
+    br.read<predicate_id_t>(&m_pid);
 
-    small_size_t n;
-    fi->read((char*)&n, sizeof(small_size_t));
+    small_size_t n = br.get<small_size_t>();
 
     for (small_size_t i = 0; i < n; ++i)
     {
-        char c;
-        term_idx_t t1, t2;
-        fi->read(&c, sizeof(char));
-        fi->read((char*)&t1, sizeof(term_idx_t));
-        fi->read((char*)&t2, sizeof(term_idx_t));
+        char c = br.get<char>();
+        term_idx_t t1 = br.get<term_idx_t>();
+        term_idx_t t2 = br.get<term_idx_t>();
 
         argument_property_t p(static_cast<predicate_property_type_e>(c), t1, t2);
         m_properties.push_back(p);
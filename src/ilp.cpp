@@ -7,7 +7,94 @@ namespace dav
 namespace ilp
 {
 
-variable_t::variable_t(const string_t &name)
+name_t::name_t()
+    : m_graph(nullptr), m_refs{ { -1, -1, -1 } }, m_kind(NAME_STRING)
+{}
+
+
+name_t::name_t(const char *str)
+    : m_str(std::make_shared<string_t>(str)), m_graph(nullptr), m_refs{ { -1, -1, -1 } }, m_kind(NAME_STRING)
+{}
+
+
+name_t::name_t(const std::string &str)
+    : m_str(std::make_shared<string_t>(str)), m_graph(nullptr), m_refs{ { -1, -1, -1 } }, m_kind(NAME_STRING)
+{}
+
+
+name_t::name_t(name_kind_e kind, const pg::proof_graph_t *graph, index_t i1, index_t i2)
+    : m_graph(graph),
+    m_refs{ { static_cast<int>(i1), static_cast<int>(i2), -1 } }, m_kind(kind)
+{}
+
+
+name_t::name_t(name_kind_e kind, const term_t &t1, const term_t &t2, const term_t &t3)
+    : m_graph(nullptr),
+    m_refs{ { static_cast<int>(t1.get_hash()), static_cast<int>(t2.get_hash()),
+        static_cast<int>(t3.get_hash()) } },
+    m_kind(kind)
+{}
+
+
+name_t name_t::atom(name_kind_e kind, const pg::proof_graph_t *graph, const atom_t &atom)
+{
+    const auto &nodes = graph->nodes.atom2nodes.get(atom);
+
+    if (not nodes.empty())
+        return name_t(kind, graph, *nodes.begin());
+    else
+        return name_t(name_t(kind, graph, -1).string() + atom.string());
+}
+
+
+string_t name_t::string() const
+{
+    auto atom = [this]() -> string_t
+    {
+        return (m_refs[0] >= 0) ? m_graph->nodes.at(m_refs[0]).atom_t::string() : string_t();
+    };
+    auto terms = [this]() -> string_t
+    {
+        return format("(%s,%s,%s)",
+            term_t(static_cast<unsigned>(m_refs[0])).string().c_str(),
+            term_t(static_cast<unsigned>(m_refs[1])).string().c_str(),
+            term_t(static_cast<unsigned>(m_refs[2])).string().c_str());
+    };
+
+    switch (m_kind)
+    {
+    case NAME_STRING:            return m_str ? *m_str : string_t();
+    case NAME_ATOM:              return "atom:" + atom();
+    case NAME_CWA:               return "cwa:" + atom();
+    case NAME_CLOSED:            return "closed:" + atom();
+    case NAME_SATISFIED:         return "satisfied:" + atom();
+    case NAME_NODE:              return "node:" + m_graph->nodes.at(m_refs[0]).string();
+    case NAME_HYPERNODE:         return format("hypernode[%d]", m_refs[0]);
+    case NAME_HYPERNODE_MEMBER:  return format("hypernode_member:hn(%d)", m_refs[0]);
+    case NAME_EDGE:
+    {
+        const pg::edge_t &e = m_graph->edges.at(m_refs[0]);
+        return format("edge(%d):hn(%d,%d)", e.index(), e.tail(), e.head());
+    }
+    case NAME_EDGE_TAIL:         return format("edge-tail:e(%d)", m_refs[0]);
+    case NAME_EDGE_HEAD:         return format("edge-head:e(%d)", m_refs[0]);
+    case NAME_EDGE_COND:         return format("edge-cond:e(%d)", m_refs[0]);
+    case NAME_EXCLUSION:         return format("exclusion(%d)", m_refs[0]);
+    case NAME_VIOLATE_EXCLUSION: return format("violate-exclusion[%d]", m_refs[0]);
+    case NAME_TRANSITIVITY:      return "transitivity" + terms();
+    case NAME_TRANSITIVITY_A:    return "transitivity_a" + terms();
+    case NAME_TRANSITIVITY_B:    return "transitivity_b" + terms();
+    case NAME_TRANSITIVITY_EXCLUSION: return "transitivity-exclusion" + terms();
+    case NAME_NODE_COST:         return format("cost(n:%d)", m_refs[0]);
+    case NAME_EDGE_COST:         return format("cost(e:%d)", m_refs[0]);
+    case NAME_COST_PAYMENT:      return "cost-payment:" + m_graph->nodes.at(m_refs[0]).string();
+    case NAME_COST_PAYMENT_ATOM: return "cost-payment:" + atom();
+    default:                     return string_t();
+    }
+}
+
+
+variable_t::variable_t(const name_t &name)
     : m_name(name), m_pert(0.0), m_index(-1), m_const(false, 0.0)
 {}
 
@@ -4,7 +4,9 @@
 #include <climits>
 #include <memory>
 #include <deque>
+#include <vector>
 #include <array>
+#include <iterator>
 
 #include "./util.h"
 #include "./pg.h"
@@ -84,6 +86,84 @@ enum translation_state_e
 };
 
 
+/** Enumerator to specify the kind of a name of ILP-variables and ILP-constraints. */
+enum name_kind_e
+{
+    NAME_STRING,              //< Name given as a string.
+    NAME_ATOM,                //< `atom:ATOM`, where ATOM is the atom of a node.
+    NAME_CWA,                 //< `cwa:ATOM`.
+    NAME_CLOSED,              //< `closed:ATOM`.
+    NAME_SATISFIED,           //< `satisfied:ATOM`.
+    NAME_NODE,                //< `node:NODE`.
+    NAME_HYPERNODE,           //< `hypernode[HN]`.
+    NAME_HYPERNODE_MEMBER,    //< `hypernode_member:hn(HN)`.
+    NAME_EDGE,                //< `edge(E):hn(TAIL,HEAD)`.
+    NAME_EDGE_TAIL,           //< `edge-tail:e(E)`.
+    NAME_EDGE_HEAD,           //< `edge-head:e(E)`.
+    NAME_EDGE_COND,           //< `edge-cond:e(E)`.
+    NAME_EXCLUSION,           //< `exclusion(EX)`.
+    NAME_VIOLATE_EXCLUSION,   //< `violate-exclusion[EX]`.
+    NAME_TRANSITIVITY,        //< `transitivity(T1,T2,T3)`.
+    NAME_TRANSITIVITY_A,      //< `transitivity_a(T1,T2,T3)`.
+    NAME_TRANSITIVITY_B,      //< `transitivity_b(T1,T2,T3)`.
+    NAME_TRANSITIVITY_EXCLUSION, //< `transitivity-exclusion(T1,T2,T3)`.
+    NAME_NODE_COST,           //< `cost(n:NODE)`.
+    NAME_EDGE_COST,           //< `cost(e:EDGE)`.
+    NAME_COST_PAYMENT,        //< `cost-payment:NODE`.
+    NAME_COST_PAYMENT_ATOM,   //< `cost-payment:ATOM`, where ATOM is the atom of a node.
+};
+
+
+/**
+* @brief Name of an ILP-variable or an ILP-constraint.
+* @details
+*   Names are needed only for outputs and debugging.
+*   So most of them are stored as a descriptor, which consists of the kind and
+*   the indices of nodes, edges or terms referred, and are made only when string() is called.
+*/
+class name_t
+{
+public:
+    name_t();
+    name_t(const char *str);
+    name_t(const std::string &str);
+
+    /**
+    * @brief Makes a name referring to components in a proof-graph.
+    * @param graph Proof-graph which the indices refer to.
+    */
+    name_t(name_kind_e kind, const pg::proof_graph_t *graph, index_t i1, index_t i2 = -1);
+
+    /** Makes a name referring to three terms. */
+    name_t(name_kind_e kind, const term_t &t1, const term_t &t2, const term_t &t3);
+
+    /**
+    * @brief Makes a name referring to an atom.
+    * @details If no node in `graph` has the atom, the name is made immediately.
+    */
+    static name_t atom(name_kind_e kind, const pg::proof_graph_t *graph, const atom_t &atom);
+
+    inline name_kind_e kind() const { return m_kind; }
+
+    /** Returns the proof-graph which refs() refer to, or null. */
+    inline const pg::proof_graph_t* graph() const { return m_graph; }
+
+    /** Returns indices of nodes or edges, or hashes of terms, which this refers to. */
+    inline const std::array<int, 3>& refs() const { return m_refs; }
+
+    /** Makes the name in string. */
+    string_t string() const;
+
+private:
+    /** The name given as a string. This is null unless m_kind is NAME_STRING. */
+    std::shared_ptr<const string_t> m_str;
+
+    const pg::proof_graph_t *m_graph;
+    std::array<int, 3> m_refs; /// Indices of nodes, edges or hashes of terms.
+    name_kind_e m_kind;
+};
+
+
 /** Returns whether the given value is equal to the pseudo-sampling penalty. */
 inline bool is_pseudo_sampling_penalty(double coef)
 {
@@ -100,7 +180,7 @@ public:
     * @param name Name of this variable.
     * @param coef Coefficient of this variable in the objective function.
     */
-    variable_t(const string_t &name);
+    variable_t(const name_t &name);
 
     /** Returns this variable's coefficient in the objective function. */
     coefficient_t coefficient() const;
@@ -111,7 +191,10 @@ public:
     void set_perturbation(coefficient_t pert) { m_pert = pert; }
 
     /** Returns name of this variable. */
-    inline const string_t& name() const { return m_name; }
+    inline string_t name() const { return m_name.string(); }
+
+    /** Returns the name of this variable without making the string. */
+    inline const name_t& name_descriptor() const { return m_name; }
 
     /** Returns index of this variable in ilp::problem_t::vars. */
     inline const variable_idx_t& index() const { return m_index; }
@@ -129,7 +212,7 @@ public:
     calc::component_ptr_t component;
 
 private:
-    string_t m_name;
+    name_t m_name;
     coefficient_t m_pert; /// Coefficient term from perturbation.
     variable_idx_t m_index;
 
@@ -137,14 +220,137 @@ private:
 };
 
 
-/** A class to express a constraint in ILP-problems. */
+/** A read-only view of terms in a constraint, which are stored in contiguous arrays. */
+class constraint_terms_t
+{
+public:
+    /** Iterator which yields pairs of a variable-index and its coefficient. */
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<variable_idx_t, coefficient_t> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+
+        iterator(const variable_idx_t *v, const coefficient_t *c) : m_var(v), m_coef(c) {}
+
+        inline value_type operator*() const { return value_type(*m_var, *m_coef); }
+        inline iterator& operator++() { ++m_var; ++m_coef; return *this; }
+        inline iterator operator++(int) { iterator x(*this); ++(*this); return x; }
+        inline bool operator==(const iterator &x) const { return m_var == x.m_var; }
+        inline bool operator!=(const iterator &x) const { return m_var != x.m_var; }
+
+    private:
+        const variable_idx_t *m_var;
+        const coefficient_t *m_coef;
+    };
+
+    constraint_terms_t(const variable_idx_t *vars, const coefficient_t *coefs, size_t n)
+        : m_vars(vars), m_coefs(coefs), m_size(n) {}
+
+    inline iterator begin() const { return iterator(m_vars, m_coefs); }
+    inline iterator end() const { return iterator(m_vars + m_size, m_coefs + m_size); }
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+
+    /** Returns the array of variable-indices, whose length is size(). */
+    inline const variable_idx_t* variables() const { return m_vars; }
+
+    /** Returns the array of coefficients, whose length is size(). */
+    inline const coefficient_t* coefficients() const { return m_coefs; }
+
+private:
+    const variable_idx_t *m_vars;
+    const coefficient_t *m_coefs;
+    size_t m_size;
+};
+
+
+/**
+* @brief Constraint matrix of ILP-problems in the compressed sparse row format.
+* @details
+*   Variable-indices and coefficients of all rows are stored in two contiguous arrays,
+*   and the terms of the i-th row are in the range [row_begin(i), row_begin(i + 1)).
+*   Each row also has a tag of its operator and the lazy flag, its bounds and its name.
+*/
+class constraint_matrix_t
+{
+public:
+    constraint_matrix_t();
+
+    /**
+    * Appends a row and returns its index.
+    * Terms of the row are sorted by variable-indices, and for duplicated variables the last one wins.
+    */
+    constraint_idx_t add_row(
+        const name_t &name, constraint_operator_e opr, double lower, double upper,
+        bool is_lazy, const variable_idx_t *vars, const coefficient_t *coefs, size_t n);
+
+    void reserve(size_t rows, size_t nonzeros);
+
+    inline size_t rows() const { return m_types.size(); }
+    inline size_t nonzeros() const { return m_vars.size(); }
+
+    /**
+    * Returns a view of the terms of the i-th row.
+    * The view refers to the storage of this matrix, so it is invalidated by the next add_row().
+    */
+    inline constraint_terms_t terms(constraint_idx_t i) const
+    {
+        size_t b = m_row_begin.at(i);
+        return constraint_terms_t(m_vars.data() + b, m_coefs.data() + b, m_row_begin.at(i + 1) - b);
+    }
+
+    inline constraint_operator_e operator_type(constraint_idx_t i) const
+    {
+        return static_cast<constraint_operator_e>(m_types.at(i) & ~LAZY_BIT);
+    }
+    inline bool lazy(constraint_idx_t i) const { return (m_types.at(i) & LAZY_BIT) != 0; }
+
+    inline double lower_bound(constraint_idx_t i) const { return m_bounds.at(i)[0]; }
+    inline double upper_bound(constraint_idx_t i) const { return m_bounds.at(i)[1]; }
+
+    inline const name_t& name(constraint_idx_t i) const { return m_names.at(i); }
+
+    /** Returns the number of bytes allocated for this matrix. */
+    size_t memory_usage() const;
+
+    /** Returns memory_usage() divided by the number of nonzero terms. */
+    double bytes_per_nonzero() const;
+
+private:
+    static const unsigned char LAZY_BIT = 0x80;
+
+    std::vector<size_t> m_row_begin; /// Offsets of rows in m_vars and m_coefs.
+    std::vector<variable_idx_t> m_vars;
+    std::vector<coefficient_t> m_coefs;
+
+    std::vector<unsigned char> m_types; /// Row-type tags, which are operators with the lazy flag.
+    std::vector<std::array<double, 2>> m_bounds;
+    std::vector<name_t> m_names;
+};
+
+
+/**
+* @brief A class to express a constraint in ILP-problems.
+* @details
+*   An instance made by users is a builder which owns its terms.
+*   Instances given by problem_t::constraints_t are views of rows in the constraint matrix,
+*   which are valid until the next constraint is added to the matrix.
+*/
 class constraint_t
 {
 public:
     constraint_t();
-    constraint_t(const string_t &name);
-    constraint_t(const string_t &name, constraint_operator_e opr, double val);
-    constraint_t(const string_t &name, constraint_operator_e opr, double val1, double val2);
+    constraint_t(const name_t &name);
+    constraint_t(const name_t &name, constraint_operator_e opr, double val);
+    constraint_t(const name_t &name, constraint_operator_e opr, double val1, double val2);
+
+    /** Makes a view of the i-th row of the matrix given. */
+    constraint_t(const constraint_matrix_t &mat, constraint_idx_t i);
 
     void add_term(variable_idx_t vi, coefficient_t coe);
     void erase_term(variable_idx_t vi);
@@ -156,9 +362,21 @@ public:
                 add_term(*it, coe);
     }
 
-    inline const std::unordered_map<variable_idx_t, double>& terms() const { return m_terms; }
+    /**
+    * Returns a view of the terms of this constraint.
+    * If this is a view of a matrix, the result is invalidated by the next row added to the matrix.
+    * Otherwise it is invalidated by the next change of terms of this.
+    */
+    inline constraint_terms_t terms() const
+    {
+        if (m_matrix)
+            return m_matrix->terms(m_index);
 
-    bool empty() const { return m_terms.empty(); }
+        normalize();
+        return constraint_terms_t(m_vars.data(), m_coefs.data(), m_vars.size());
+    }
+
+    bool empty() const { return size() == 0; }
     bool is_satisfied(const value_assignment_t&) const;
 
     /** Returns the number of terms whose coefficient is equal to `c`. */
@@ -167,7 +385,10 @@ public:
     /** Sorts the terms by variable-indices in numerical order and returns the result. */
     std::list<std::pair<variable_idx_t, coefficient_t>> sorted_terms() const;
 
-    inline const string_t& name() const { return m_name; }
+    inline string_t name() const { return (m_matrix ? m_matrix->name(m_index) : m_name).string(); }
+
+    /** Returns the name of this constraint without making the string. */
+    inline const name_t& name_descriptor() const { return m_matrix ? m_matrix->name(m_index) : m_name; }
     inline constraint_operator_e operator_type() const { return m_operator; }
 
     inline double bound() const { return m_bounds[0]; }
@@ -181,10 +402,9 @@ public:
     inline void set_lazy() { m_is_lazy = true; }
 
     inline const constraint_idx_t& index() const { return m_index; }
-    inline       constraint_idx_t& index() { return m_index; }
 
-    inline size_t size() const { return m_terms.size(); }
-    inline void clear() { m_terms.clear(); }
+    inline size_t size() const { return terms().size(); }
+    void clear();
 
 
     string_t string(const problem_t&) const;
@@ -193,14 +413,25 @@ public:
     string_t range2str() const;
 
 private:
+    /** Sorts the terms by variable-indices and removes duplicates, where the last one wins. */
+    void normalize() const;
 
     constraint_operator_e m_operator;
-    string_t m_name;
+    name_t m_name;
     ilp::constraint_idx_t m_index;
 
     bool m_is_lazy; /// If true, will be target of lazy inference.
 
-    std::unordered_map<variable_idx_t, coefficient_t> m_terms;
+    /**
+    * Terms of this constraint. These are empty if this is a view of a matrix.
+    * Terms are appended without lookup and normalized lazily on reading.
+    */
+    mutable std::vector<variable_idx_t> m_vars;
+    mutable std::vector<coefficient_t> m_coefs;
+    mutable bool m_is_normalized;
+
+    /** The matrix which this refers to. If null, this owns its terms. */
+    const constraint_matrix_t *m_matrix;
 
     /** Value of Left-hand-side and right-hand-side of this constraint. */
     std::array<double, 2> m_bounds;
@@ -244,7 +475,7 @@ public:
     * @return Index of the constraint made. -1 if no constraint was made.
     */
     constraint_idx_t make_constraint(
-        const string_t &name, constraint_type_e type,
+        const name_t &name, constraint_type_e type,
         const std::list<variable_idx_t> &targets, bool is_lazy = false);
 
     /**
@@ -258,7 +489,7 @@ public:
     * @return Index of the constraint made. -1 if no constraint was made.
     */
     constraint_idx_t make_constraint(
-        const string_t &name, constraint_type_e type,
+        const name_t &name, constraint_type_e type,
         const conjunction_t &conj, variable_idx_t var, bool is_lazy = false);
 
     void make_constraints_for_atom_and_node();
@@ -282,7 +513,7 @@ public:
 
         variable_idx_t add(const variable_t&);
 
-        variable_idx_t add(const string_t&, calc::component_ptr_t = calc::component_ptr_t());
+        variable_idx_t add(const name_t&, calc::component_ptr_t = calc::component_ptr_t());
 
         variable_idx_t add(const atom_t&);
         variable_idx_t add(const pg::node_t&);
@@ -321,7 +552,7 @@ public:
 
         void set_component_of(variable_idx_t vi, calc::component_ptr_t comp);
 
-        hash_map_t<atom_t, variable_idx_t>              atom2var;
+        interned_map_t<atom_t, variable_idx_t>          atom2var;
         hash_map_t<pg::node_idx_t, variable_idx_t>      node2var;
         hash_map_t<pg::hypernode_idx_t, variable_idx_t> hypernode2var;
         hash_map_t<pg::edge_idx_t, variable_idx_t>      edge2var;
@@ -345,10 +576,38 @@ public:
         hash_map_t<conjunction_t, std::list<pg::exclusion_idx_t>> conj2excs;
     } vars;
 
-    /** A container of ilp-constraints. */
-    class constraints_t : public std::deque<constraint_t>
+    /**
+    * @brief A container of ilp-constraints.
+    * @details
+    *   Constraints are stored in constraint_matrix_t.
+    *   Accessors return instances of constraint_t which are views of rows in the matrix.
+    */
+    class constraints_t
     {
     public:
+        /** Iterator which yields views of constraints in order of their indices. */
+        class const_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef constraint_t value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const constraint_t* pointer;
+            typedef constraint_t reference;
+
+            const_iterator(const constraint_matrix_t *mat, constraint_idx_t i) : m_matrix(mat), m_index(i) {}
+
+            inline constraint_t operator*() const { return constraint_t(*m_matrix, m_index); }
+            inline const_iterator& operator++() { ++m_index; return *this; }
+            inline const_iterator operator++(int) { const_iterator x(*this); ++m_index; return x; }
+            inline bool operator==(const const_iterator &x) const { return m_index == x.m_index; }
+            inline bool operator!=(const const_iterator &x) const { return m_index != x.m_index; }
+
+        private:
+            const constraint_matrix_t *m_matrix;
+            constraint_idx_t m_index;
+        };
+
         constraints_t(problem_t *m);
 
         /** Adds a constraint given. */
@@ -362,10 +621,22 @@ public:
         std::array<constraint_idx_t, 7> add_transitivity(
             const term_t &t1, const term_t &t2, const term_t &t3);
 
+        inline size_t size() const { return m_matrix.rows(); }
+        inline bool empty() const { return m_matrix.rows() == 0; }
+
+        constraint_t at(constraint_idx_t i) const;
+        inline constraint_t operator[](constraint_idx_t i) const { return constraint_t(m_matrix, i); }
+
+        inline const_iterator begin() const { return const_iterator(&m_matrix, 0); }
+        inline const_iterator end() const { return const_iterator(&m_matrix, static_cast<constraint_idx_t>(size())); }
+
+        inline const constraint_matrix_t& matrix() const { return m_matrix; }
+
         hash_map_t<pg::exclusion_idx_t, constraint_idx_t> exclusion2con;
 
     private:
         problem_t *m_master;
+        constraint_matrix_t m_matrix;
     }cons;
 
     /** Component for perturbation method. */
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "./ilp.h"
 
 namespace dav
@@ -6,46 +8,212 @@ namespace dav
 namespace ilp
 {
 
+/**
+* Sorts terms in [begin, end) of the arrays by variable-indices
+* and removes duplicated variables, keeping the one added last.
+* The arrays are shrunk to the new end.
+*/
+static void normalize_terms(
+    std::vector<variable_idx_t> &vars, std::vector<coefficient_t> &coefs, size_t begin)
+{
+    size_t end = vars.size();
+    bool is_sorted(true);
+
+    for (size_t i = begin + 1; i < end and is_sorted; ++i)
+        is_sorted = (vars[i - 1] < vars[i]);
+
+    if (is_sorted) return;
+
+    std::vector<std::pair<variable_idx_t, coefficient_t>> terms;
+    terms.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i)
+        terms.push_back(std::make_pair(vars[i], coefs[i]));
+
+    std::stable_sort(terms.begin(), terms.end(), [](
+        const std::pair<variable_idx_t, coefficient_t> &x,
+        const std::pair<variable_idx_t, coefficient_t> &y)
+    {
+        return x.first < y.first;
+    });
+
+    size_t k = begin;
+    for (size_t i = 0; i < terms.size(); ++i)
+    {
+        // THE LAST ONE OF THE SAME VARIABLE WINS.
+        if (i + 1 < terms.size() and terms[i + 1].first == terms[i].first)
+            continue;
+
+        vars[k] = terms[i].first;
+        coefs[k] = terms[i].second;
+        ++k;
+    }
+
+    vars.resize(k);
+    coefs.resize(k);
+}
+
+
+constraint_matrix_t::constraint_matrix_t()
+    : m_row_begin(1, 0)
+{}
+
+
+constraint_idx_t constraint_matrix_t::add_row(
+    const name_t &name, constraint_operator_e opr, double lower, double upper,
+    bool is_lazy, const variable_idx_t *vars, const coefficient_t *coefs, size_t n)
+{
+    constraint_idx_t ci = static_cast<constraint_idx_t>(rows());
+
+    // TERMS GIVEN MAY BE A VIEW OF THIS MATRIX, WHICH IS INVALIDATED BY THE INSERTION BELOW.
+    if (n > 0 and vars >= m_vars.data() and vars < m_vars.data() + m_vars.size())
+    {
+        std::vector<variable_idx_t> v(vars, vars + n);
+        std::vector<coefficient_t> c(coefs, coefs + n);
+        return add_row(name, opr, lower, upper, is_lazy, v.data(), c.data(), n);
+    }
+
+    m_vars.insert(m_vars.end(), vars, vars + n);
+    m_coefs.insert(m_coefs.end(), coefs, coefs + n);
+    normalize_terms(m_vars, m_coefs, m_row_begin.back());
+    m_row_begin.push_back(m_vars.size());
+
+    m_types.push_back(static_cast<unsigned char>(opr) | (is_lazy ? LAZY_BIT : 0));
+    m_bounds.push_back(std::array<double, 2>{ { lower, upper } });
+    m_names.push_back(name);
+
+    return ci;
+}
+
+
+void constraint_matrix_t::reserve(size_t rows, size_t nonzeros)
+{
+    m_row_begin.reserve(rows + 1);
+    m_types.reserve(rows);
+    m_bounds.reserve(rows);
+    m_names.reserve(rows);
+    m_vars.reserve(nonzeros);
+    m_coefs.reserve(nonzeros);
+}
+
+
+size_t constraint_matrix_t::memory_usage() const
+{
+    size_t out =
+        m_row_begin.capacity() * sizeof(size_t) +
+        m_vars.capacity() * sizeof(variable_idx_t) +
+        m_coefs.capacity() * sizeof(coefficient_t) +
+        m_types.capacity() * sizeof(unsigned char) +
+        m_bounds.capacity() * sizeof(std::array<double, 2>) +
+        m_names.capacity() * sizeof(name_t);
+
+    // NAMES GIVEN AS STRINGS ARE STORED ON HEAP WITH THEIR REFERENCE COUNTERS.
+    for (const auto &n : m_names)
+    {
+        if (n.kind() == NAME_STRING)
+        {
+            size_t len = n.string().size();
+            out += sizeof(string_t) + 2 * sizeof(long);
+            if (len > 15) out += len + 1;
+        }
+    }
+
+    return out;
+}
+
+
+double constraint_matrix_t::bytes_per_nonzero() const
+{
+    return nonzeros() ?
+        static_cast<double>(memory_usage()) / static_cast<double>(nonzeros()) : 0.0;
+}
+
+
 constraint_t::constraint_t()
-    : m_is_lazy(false), m_index(-1)
+    : m_index(-1), m_is_lazy(false), m_is_normalized(true), m_matrix(nullptr)
 {
     set_bound(OPR_UNSPECIFIED, 0.0);
 }
 
 
-constraint_t::constraint_t(const string_t &name)
-    : m_name(name), m_is_lazy(false), m_index(-1)
+constraint_t::constraint_t(const name_t &name)
+    : m_name(name), m_index(-1), m_is_lazy(false), m_is_normalized(true), m_matrix(nullptr)
 {
     set_bound(OPR_UNSPECIFIED, 0.0);
 }
 
 
 constraint_t::constraint_t(
-    const string_t &name, constraint_operator_e opr, double val)
-    : m_name(name), m_is_lazy(false), m_index(-1)
+    const name_t &name, constraint_operator_e opr, double val)
+    : m_name(name), m_index(-1), m_is_lazy(false), m_is_normalized(true), m_matrix(nullptr)
 {
     set_bound(opr, val);
 }
 
 
 constraint_t::constraint_t(
-    const string_t &name, constraint_operator_e opr, double val1, double val2)
-    : m_name(name), m_operator(opr), m_is_lazy(false), m_index(-1)
+    const name_t &name, constraint_operator_e opr, double val1, double val2)
+    : m_operator(opr), m_name(name), m_index(-1), m_is_lazy(false), m_is_normalized(true), m_matrix(nullptr)
 {
     set_bound(opr, val1, val2);
 }
 
 
+constraint_t::constraint_t(const constraint_matrix_t &mat, constraint_idx_t i)
+    : m_operator(mat.operator_type(i)), m_index(i), m_is_lazy(mat.lazy(i)), m_is_normalized(true), m_matrix(&mat)
+{
+    m_bounds[0] = mat.lower_bound(i);
+    m_bounds[1] = mat.upper_bound(i);
+}
+
+
 void constraint_t::add_term(variable_idx_t vi, coefficient_t coe)
 {
     assert(vi >= 0);
-    m_terms[vi] = coe;
+    assert(m_matrix == nullptr);
+
+    // DUPLICATES ARE REMOVED BY normalize() AT ONCE.
+    if (not m_vars.empty() and m_vars.back() >= vi)
+        m_is_normalized = false;
+
+    m_vars.push_back(vi);
+    m_coefs.push_back(coe);
 }
 
 
 void constraint_t::erase_term(variable_idx_t vi)
 {
-    m_terms.erase(vi);
+    assert(m_matrix == nullptr);
+
+    size_t k = 0;
+    for (size_t i = 0; i < m_vars.size(); ++i)
+    {
+        if (m_vars[i] == vi) continue;
+        m_vars[k] = m_vars[i];
+        m_coefs[k] = m_coefs[i];
+        ++k;
+    }
+
+    m_vars.resize(k);
+    m_coefs.resize(k);
+}
+
+
+void constraint_t::clear()
+{
+    assert(m_matrix == nullptr);
+
+    m_vars.clear();
+    m_coefs.clear();
+    m_is_normalized = true;
+}
+
+
+void constraint_t::normalize() const
+{
+    if (m_is_normalized) return;
+
+    normalize_terms(m_vars, m_coefs, 0);
+    m_is_normalized = true;
 }
 
 
@@ -53,11 +221,12 @@ bool constraint_t::is_satisfied(const value_assignment_t &values) const
 {
     double val = 0.0;
 
-    for (const auto &p : m_terms)
-    {
-        const double &var = values.at(p.first);
-        val += var * p.second;
-    }
+    auto &&ts = terms();
+    const variable_idx_t *vars = ts.variables();
+    const coefficient_t *coefs = ts.coefficients();
+
+    for (size_t i = 0; i < ts.size(); ++i)
+        val += values.at(vars[i]) * coefs[i];
 
     switch (m_operator)
     {
@@ -73,8 +242,9 @@ bool constraint_t::is_satisfied(const value_assignment_t &values) const
 int constraint_t::count_terms_of(coefficient_t c) const
 {
     int n(0);
-    for (const auto &p : m_terms)
-        if (feq(p.second, c))
+    auto &&ts = terms();
+    for (size_t i = 0; i < ts.size(); ++i)
+        if (feq(ts.coefficients()[i], c))
             ++n;
     return n;
 }
@@ -130,7 +300,8 @@ string_t constraint_t::range2str() const
 
 std::list<std::pair<variable_idx_t, coefficient_t>> constraint_t::sorted_terms() const
 {
-    std::list<std::pair<variable_idx_t, coefficient_t>> terms(m_terms.begin(), m_terms.end());
+    auto &&ts = this->terms();
+    std::list<std::pair<variable_idx_t, coefficient_t>> terms(ts.begin(), ts.end());
 
     terms.sort([](
         const std::pair<variable_idx_t, coefficient_t> &x,
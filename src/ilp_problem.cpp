@@ -51,7 +51,7 @@ double problem_t::objective_value(
 
 
 constraint_idx_t problem_t::make_constraint(
-    const string_t &name, constraint_type_e type,
+    const name_t &name, constraint_type_e type,
     const std::list<variable_idx_t> &targets, bool is_lazy)
 {
     auto set_const = [&](
@@ -456,7 +456,7 @@ constraint_idx_t problem_t::make_constraint(
 
 
 constraint_idx_t problem_t::make_constraint(
-    const string_t &name, constraint_type_e type,
+    const name_t &name, constraint_type_e type,
     const conjunction_t &conj, variable_idx_t var, bool is_lazy)
 {
     switch (type)
@@ -623,7 +623,7 @@ void problem_t::make_constraints_for_atom_and_node()
         // If any of nodes corresponding to an atom are true, the atom must be true.
         // If the atom is not negated, the reversed relation is true, too.
         make_constraint(
-            "atom:" + atom.string(),
+            name_t::atom(NAME_ATOM, graph(), atom),
             (atom.neg() ? CON_IF_ANY_THEN : CON_EQUIVALENT_ANY), targets);
 
         // Under C.W.A, either `p` or `!p` must be true.
@@ -635,7 +635,7 @@ void problem_t::make_constraints_for_atom_and_node()
             if (vi_neg >= 0)
             {
                 make_constraint(
-                    "cwa:" + atom.string(), CON_SELECT_ONE, { vi_atom, vi_neg });
+                    name_t::atom(NAME_CWA, graph(), atom), CON_SELECT_ONE, { vi_atom, vi_neg });
             }
         }
     };
@@ -663,7 +663,7 @@ void problem_t::make_constraints_for_hypernode_and_node()
         // If a hypernode is active, its all members are active.
         // If a hypernode is master, the reversed relation is true too.
         make_constraint(
-            format("hypernode_member:hn(%d)", p.first),
+            name_t(NAME_HYPERNODE_MEMBER, graph(), p.first),
             (is_master ? CON_SAME : CON_IF_THEN_ALL), targets);
     }
 }
@@ -680,14 +680,14 @@ void problem_t::make_constraints_for_edge()
 
         // If an edge is active, its tail must be active.
         make_constraint(
-            format("edge-tail:e(%d)", p.first),
+            name_t(NAME_EDGE_TAIL, graph(), p.first),
             CON_IF_THEN_ALL, { p.second, v_tail });
 
         if (e.head() >= 0 and v_head != p.second)
         {
             // Truth value of an edge is equal to one of its head.
             make_constraint(
-                format("edge-head:e(%d)", p.first),
+                name_t(NAME_EDGE_HEAD, graph(), p.first),
                 CON_EQUIVALENT_ALL, { p.second, v_head });
         }
 
@@ -695,7 +695,7 @@ void problem_t::make_constraints_for_edge()
         {
             // If the edge is active, its condition must be satisfied.
             make_constraint(
-                format("edge-cond:e(%d)", p.first), CON_IF_THEN_ALL,
+                name_t(NAME_EDGE_COND, graph(), p.first), CON_IF_THEN_ALL,
                 conjunction_t{ e.conditions().begin(), e.conditions().end() },
                 p.second, false);
         }
@@ -755,7 +755,7 @@ void problem_t::make_constraints_for_closed_predicate()
 
         // If the atom is true, its closed term must be unified with some constant.
         make_constraint(
-            "closed:" + atom.string(), CON_IF_THEN_ANY, targets, false);
+            name_t::atom(NAME_CLOSED, graph(), atom), CON_IF_THEN_ANY, targets, false);
     };
 
     for (const auto &pair : graph()->nodes.pid2nodes)
@@ -802,9 +802,9 @@ void problem_t::make_constraints_for_requirement(pseudo_sample_type_e type)
                 const term_t &t1(req.term(i)), &t2(p.first.term(i));
                 if (t1 == t2 or t1 == t_any) continue;
 
-                auto f = vars.atom2var.find(atom_t::equal(t1, t2));
-                if (f != vars.atom2var.end())
-                    vset.insert(f->second);
+                auto vi = vars.atom2var.get(atom_t::equal(t1, t2));
+                if (vi >= 0)
+                    vset.insert(vi);
                 else
                 {
                     vset.clear();
@@ -909,7 +909,7 @@ variable_idx_t problem_t::variables_t::add(const variable_t &v)
 }
 
 
-variable_idx_t problem_t::variables_t::add(const string_t &name, calc::component_ptr_t comp)
+variable_idx_t problem_t::variables_t::add(const name_t &name, calc::component_ptr_t comp)
 {
     if (comp)
     {
@@ -934,8 +934,8 @@ variable_idx_t problem_t::variables_t::add(const atom_t &atom)
 {
     // If already exists, returns its index.
     {
-        auto it = atom2var.find(atom);
-        if (it != atom2var.end()) return it->second;
+        auto ai = atom2var.find(atom);
+        if (ai != atom2var.INVALID_ID) return atom2var.value(ai);
     }
 
     const auto &nodes = m_master->graph()->nodes.atom2nodes.get(atom);
@@ -958,7 +958,7 @@ variable_idx_t problem_t::variables_t::add(const atom_t &atom)
     }
     else
     {
-        variable_t var("atom:" + atom.string());
+        variable_t var(name_t::atom(NAME_ATOM, m_master->graph(), atom));
         vi = add(var);
         atom2var[atom] = vi;
     }
@@ -985,7 +985,7 @@ variable_idx_t problem_t::variables_t::add(const pg::node_t &node)
     }
     else
     {
-        variable_t var("node:" + node.string());
+        variable_t var(name_t(NAME_NODE, m_master->graph(), node.index()));
         if (node.type() == pg::NODE_OBSERVABLE)
             var.set_const(1.0);
 
@@ -1005,7 +1005,7 @@ variable_idx_t problem_t::variables_t::add(const pg::hypernode_t &hn)
     if (hypernode2var.count(hn.index()) > 0)
         return -1; // ALREADY ADDED.
 
-    variable_t var(format("hypernode[%d]", hn.index()));
+    variable_t var(name_t(NAME_HYPERNODE, m_master->graph(), hn.index()));
     variable_idx_t vi = add(var);
 
     hypernode2var[hn.index()] = vi;
@@ -1019,7 +1019,7 @@ variable_idx_t problem_t::variables_t::add(const pg::edge_t &e)
 
     auto make_new_variable = [this](const pg::edge_t &e) -> variable_idx_t
     {
-        variable_t v(format("edge(%d):hn(%d,%d)", e.index(), e.tail(), e.head()));
+        variable_t v(name_t(NAME_EDGE, m_master->graph(), e.index()));
         return add(v);
     };
 
@@ -1062,7 +1062,7 @@ variable_idx_t problem_t::variables_t::add(const pg::exclusion_t &ex)
 
     if (excs.empty())
     {
-        variable_t v(format("violate-exclusion[%d]", ex.index()));
+        variable_t v(name_t(NAME_VIOLATE_EXCLUSION, m_master->graph(), ex.index()));
         vi = add(v);
     }
     else
@@ -1096,7 +1096,7 @@ variable_idx_t problem_t::variables_t::add_requirement(const atom_t &atom, pseud
     default: break;
     }
 
-    variable_idx_t vi = add("satisfied:" + atom.string(), comp);
+    variable_idx_t vi = add(name_t::atom(NAME_SATISFIED, m_master->graph(), atom), comp);
 
     req2var[atom] = vi;
     return vi;
@@ -1106,8 +1106,7 @@ variable_idx_t problem_t::variables_t::add_requirement(const atom_t &atom, pseud
 variable_idx_t problem_t::variables_t::add_transitivity(
     const term_t &t1, const term_t &t2, const term_t &t3)
 {
-    auto name = format("transitivity(%s,%s,%s)",
-        t1.string().c_str(), t2.string().c_str(), t3.string().c_str());
+    name_t name(NAME_TRANSITIVITY, t1, t2, t3);
     auto inferred = atom_t::equal(t3, t1);
 
     if (atom2var.has_key(inferred))
@@ -1123,8 +1122,7 @@ variable_idx_t problem_t::variables_t::add_transitivity(
 
 variable_idx_t problem_t::variables_t::add_node_cost_variable(pg::node_idx_t ni, calc::component_ptr_t comp)
 {
-    string_t name = format("cost(n:%d)", ni);
-    auto vi = add(name, comp);
+    auto vi = add(name_t(NAME_NODE_COST, m_master->graph(), ni), comp);
 
     node2costvar[ni] = vi;
     return vi;
@@ -1133,8 +1131,7 @@ variable_idx_t problem_t::variables_t::add_node_cost_variable(pg::node_idx_t ni,
 
 variable_idx_t problem_t::variables_t::add_edge_cost_variable(pg::edge_idx_t ei, calc::component_ptr_t comp)
 {
-    string_t name = format("cost(e:%d)", ei);
-    auto vi = add(name, comp);
+    auto vi = add(name_t(NAME_EDGE_COST, m_master->graph(), ei), comp);
 
     edge2costvar[ei] = vi;
     return vi;
@@ -1230,11 +1227,19 @@ constraint_idx_t problem_t::constraints_t::add(const constraint_t &c)
 {
     assert(c.operator_type() != OPR_UNSPECIFIED);
 
-    constraint_idx_t ci = static_cast<constraint_idx_t>(size());
-    push_back(c);
-    back().index() = ci;
+    auto &&ts = c.terms();
+    return m_matrix.add_row(
+        c.name_descriptor(), c.operator_type(), c.lower_bound(), c.upper_bound(), c.lazy(),
+        ts.variables(), ts.coefficients(), ts.size());
+}
 
-    return ci;
+
+constraint_t problem_t::constraints_t::at(constraint_idx_t i) const
+{
+    if (i < 0 or i >= static_cast<constraint_idx_t>(size()))
+        throw exception_t(format("constraints_t::at: invalid index %d", static_cast<int>(i)));
+
+    return constraint_t(m_matrix, i);
 }
 
 
@@ -1250,7 +1255,7 @@ constraint_idx_t problem_t::constraints_t::add(const pg::exclusion_t &ex)
     vars.push_back(m_master->vars.exclusion2var.get(ex.index()));
 
     auto ci = m_master->make_constraint(
-        format("exclusion(%d)", ex.index()), CON_EQUIVALENT_ALL, vars);
+        name_t(NAME_EXCLUSION, m_master->graph(), ex.index()), CON_EQUIVALENT_ALL, vars);
 
     if (ci >= 0)
         exclusion2con[ex.index()] = ci;
@@ -1286,21 +1291,18 @@ std::array<constraint_idx_t, 7> problem_t::constraints_t::add_transitivity(
 
         // (x=y) ^ (y=z) => (z=x)
         out[i] = m_master->make_constraint(
-            format("transitivity_a(%s,%s,%s)",
-                _t1.string().c_str(), _t2.string().c_str(), _t3.string().c_str()),
+            name_t(NAME_TRANSITIVITY_A, _t1, _t2, _t3),
             CON_IF_ALL_THEN, {eqv1, eqv2, eqv3}, true);
 
         // tr(z=x) => (x=y) ^ (y=z)
         out[i + 1] = m_master->make_constraint(
-            format("transitivity_b(%s,%s,%s)",
-                _t1.string().c_str(), _t2.string().c_str(), _t3.string().c_str()),
+            name_t(NAME_TRANSITIVITY_B, _t1, _t2, _t3),
             CON_IF_THEN_ALL, { trvars[i], eqv1, eqv2 }, true);
     }
 
     // 推移律同士の相互排他制約
     out[6] = m_master->make_constraint(
-        format("transitivity-exclusion(%s,%s,%s)",
-            t1.string().c_str(), t2.string().c_str(), t3.string().c_str()),
+        name_t(NAME_TRANSITIVITY_EXCLUSION, t1, t2, t3),
         CON_AT_MOST_ONE, { trvars[0], trvars[1], trvars[2] });
 
     return std::move(out);
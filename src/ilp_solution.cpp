@@ -42,7 +42,7 @@ bool solution_t::truth(variable_idx_t i) const
 
 void solution_t::make_term_cluster(term_cluster_t *tc) const
 {
-    for (auto &p : problem()->vars.atom2var)
+    for (const auto &p : problem()->vars.atom2var)
     {
         if (p.first.is_equality() and truth(p.second))
             tc->add(p.first);
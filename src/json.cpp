@@ -9,6 +9,69 @@ namespace json
 {
 
 
+namespace
+{
+/** Writes decimal digits of x backward from the end of the buffer. */
+char* print_digits_backward(char *end, unsigned long long x, int min_digits = 1)
+{
+    for (int i = 0; x > 0 or i < min_digits; ++i)
+    {
+        *(--end) = static_cast<char>('0' + (x % 10));
+        x /= 10;
+    }
+    return end;
+}
+
+/** Writes x in the same form as printf("%d") and returns the end of written chars. */
+char* print_int(char *out, long long x)
+{
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *begin = print_digits_backward(end, (x < 0) ? (0ull - x) : x);
+
+    if (x < 0) *(out++) = '-';
+    std::memcpy(out, begin, end - begin);
+    return out + (end - begin);
+}
+
+/**
+ * Writes x in the same form as printf("%f") and returns the end of written chars.
+ * The output buffer must have at least 512 bytes.
+ */
+char* print_fixed(char *out, double x)
+{
+    // ONLY THE CASES WHOSE ROUNDING IS CLEAR ARE FORMATTED HERE.
+    // THE OTHERS, SUCH AS HUGE VALUES AND TIES, ARE LEFT TO SNPRINTF.
+    if (std::isfinite(x) and std::fabs(x) < 1e15)
+    {
+        double a = std::fabs(x);
+        double ip = std::floor(a);
+        double fs = (a - ip) * 1e6;
+        double fp = std::floor(fs);
+
+        if (std::fabs(fs - fp - 0.5) > 1e-3)
+        {
+            unsigned long long i = static_cast<unsigned long long>(ip);
+            unsigned long long f = static_cast<unsigned long long>(fp) + ((fs - fp > 0.5) ? 1 : 0);
+            if (f == 1000000) { ++i; f = 0; }
+
+            char tmp[32];
+            char *end = tmp + sizeof(tmp);
+            char *begin = print_digits_backward(end, f, 6);
+            *(--begin) = '.';
+            begin = print_digits_backward(begin, i);
+            if (std::signbit(x)) *(--begin) = '-';
+
+            std::memcpy(out, begin, end - begin);
+            return out + (end - begin);
+        }
+    }
+
+    return out + std::snprintf(out, 512, "%f", x);
+}
+}
+
+
 /** Escapes quotation marks in given string. */
 string_t escape(const string_t &x)
 {
@@ -36,37 +99,98 @@ template <> string_t val2str<bool>(const bool &x)
 
 template <> string_t val2str<int>(const int &x)
 {
-    return format("%d", x);
+    char buf[32];
+    return string_t(std::string(buf, print_int(buf, x)));
 }
 
 template <> string_t val2str<double>(const double &x)
 {
-    return format("%lf", x);
+    char buf[512];
+    return string_t(std::string(buf, print_fixed(buf, x)));
 }
 
 template <> string_t val2str<float>(const float &x)
 {
-    return format("%f", x);
+    char buf[512];
+    return string_t(std::string(buf, print_fixed(buf, x)));
 }
 
 
-void atom2json_t::operator()(const atom_t &x, std::ostream *os) const
+void write_string(std::ostream *os, const string_t &x)
 {
-    (*os) << val2str<string_t>(x.string(not m_is_brief));
+    std::streambuf *buf = os->rdbuf();
+    const char *s = x.data(), *end = s + x.size();
+
+    buf->sputc('\"');
+    for (const char *p = s; p != end; ++p)
+    {
+        if (*p != '\"' and *p != '\'') continue;
+
+        buf->sputn(s, p - s);
+        if (*p == '\"') buf->sputn("&quot;", 6);
+        else             buf->sputn("&#39;", 5);
+        s = p + 1;
+    }
+    buf->sputn(s, end - s);
+    buf->sputc('\"');
 }
 
 
-void conj2json_t::operator()(const conjunction_t &x, std::ostream *os) const
+template <> void write_value<string_t>(std::ostream *os, const string_t &x)
 {
-    std::list<string_t> strs;
+    write_string(os, x);
+}
 
-    for (const auto &a : x)
-        strs.push_back(a.string(not m_is_brief));
+template <> void write_value<bool>(std::ostream *os, const bool &x)
+{
+    if (x) os->rdbuf()->sputn("true", 4);
+    else   os->rdbuf()->sputn("false", 5);
+}
 
+template <> void write_value<int>(std::ostream *os, const int &x)
+{
+    char buf[32];
+    os->rdbuf()->sputn(buf, print_int(buf, x) - buf);
+}
+
+template <> void write_value<double>(std::ostream *os, const double &x)
+{
+    char buf[512];
+    os->rdbuf()->sputn(buf, print_fixed(buf, x) - buf);
+}
+
+template <> void write_value<float>(std::ostream *os, const float &x)
+{
+    char buf[512];
+    os->rdbuf()->sputn(buf, print_fixed(buf, x) - buf);
+}
+
+
+void atom2json_t::operator()(const atom_t &x, std::ostream *os) const
+{
+    write_string(os, x.string(not m_is_brief));
+}
+
+
+void conj2json_t::operator()(const conjunction_t &x, std::ostream *os) const
+{
     if (m_is_brief)
-        (*os) << array2str<string_t>(strs.begin(), strs.end(), true);
+    {
+        (*os) << '[';
+        for (auto it = x.begin(); it != x.end(); ++it)
+        {
+            if (it != x.begin()) (*os) << ',';
+            (*os) << ' ';
+            write_string(os, it->string(false));
+        }
+        (*os) << " ]";
+    }
     else
     {
+        std::list<string_t> strs;
+        for (const auto &a : x)
+            strs.push_back(a.string(true));
+
         object_writer_t wr(os, true);
         wr.write_array_field<string_t>("atoms", strs.begin(), strs.end(), true);
         wr.write_field<string_t>("param", x.param());
@@ -186,6 +310,15 @@ void graph2json_t::operator()(const pg::proof_graph_t &x, std::ostream *os) cons
         wr2.write_field<int>("exclusion", x.excs.size());
     }
 
+    // WRITES HOW RESERVED OPERATORS HAVE BEEN CHECKED, ONLY IF METRICS ARE REQUESTED
+    if (param()->has("metrics"))
+    {
+        object_writer_t &&wr2 = wr.make_object_field_writer("reservation", true);
+        wr2.write_field<int>("waiting", x.reservations.size());
+        wr2.write_field<int>("hit", x.reservations.num_hits());
+        wr2.write_field<int>("miss", x.reservations.num_misses());
+    }
+
     std::unique_ptr<converter_t<rule_id_t>> rid2j(new rid2json_t(m_rule2json));
 
     wr.write_array_field_with_converter<pg::node_t>(
@@ -222,23 +355,28 @@ void variable2json_t::operator()(const ilp::variable_t &x, std::ostream *os) con
 void constraint2json_t::term2json_t::operator()(
     const std::pair<ilp::variable_idx_t, double> &x, std::ostream *os) const
 {
-    (*os) << val2str<string_t>(format("%lf*[%d]", x.second, x.first));
+    (*os) << '"';
+    write_value<double>(os, x.second);
+    (*os) << "*[";
+    write_value<int>(os, x.first);
+    (*os) << "]\"";
 }
 
 
 void constraint2json_t::operator()(const ilp::constraint_t &x, std::ostream *os) const
 {
-    std::ostringstream oss;
+    // SAME AS THE DEFAULT FORMAT OF std::ostream, WITHOUT CONSTRUCTING A STRING-STREAM.
+    char range[128] = "";
     switch (x.operator_type())
     {
     case ilp::OPR_EQUAL:
-        oss << "= " << x.bound(); break;
+        std::snprintf(range, sizeof(range), "= %g", x.bound()); break;
     case ilp::OPR_LESS_EQ:
-        oss << "<= " << x.bound(); break;
+        std::snprintf(range, sizeof(range), "<= %g", x.bound()); break;
     case ilp::OPR_GREATER_EQ:
-        oss << ">= " << x.bound(); break;
+        std::snprintf(range, sizeof(range), ">= %g", x.bound()); break;
     case ilp::OPR_RANGE:
-        oss << x.lower_bound() << " ~ " << x.upper_bound(); break;
+        std::snprintf(range, sizeof(range), "%g ~ %g", x.lower_bound(), x.upper_bound()); break;
     }
 
     object_writer_t wr(os, true);
@@ -248,7 +386,7 @@ void constraint2json_t::operator()(const ilp::constraint_t &x, std::ostream *os)
     wr.write_field<string_t>("name", x.name());
     wr.write_array_field_with_converter(
         "terms", x.terms().begin(), x.terms().end(), (*t2j), true);
-    wr.write_field<string_t>("range", oss.str());
+    wr.write_field<string_t>("range", range);
     wr.write_field<bool>("lazy", x.lazy());
 
     decorate(x, wr);
@@ -486,6 +624,8 @@ void kb2json_t::operator()(const kb::knowledge_base_t &x, std::ostream *os) cons
     object_writer_t wr(os, false);
 
     wr.write_field<string_t>("path", x.filepath());
+    if (x.image() != nullptr)
+        wr.write_field<string_t>("image", x.image()->filepath());
     wr.write_field<int>("version", x.version());
     wr.write_field<int>("rules-num", x.rules.size());
     wr.write_field<int>("predicates-num", plib()->predicates().size());
@@ -496,11 +636,32 @@ void kb2json_t::operator()(const kb::knowledge_base_t &x, std::ostream *os) cons
     }
 
     wr.write_field<string_t>("compiled", param()->get("__time_stamp_kb_compiled__"));
+    write_cache_stats(wr, "cache", x);
 
     decorate(x, wr);
 }
 
 
+void kb2json_t::write_cache_stats(object_writer_t &wr, const string_t &key, const kb::knowledge_base_t &x)
+{
+    object_writer_t &&wr2 = wr.make_object_field_writer(key, false);
+
+    auto write = [&wr2](const string_t &name, const cache_stats_t &s)
+    {
+        object_writer_t &&wr3 = wr2.make_object_field_writer(name, true);
+        wr3.write_field<int>("capacity", static_cast<int>(s.capacity));
+        wr3.write_field<int>("bytes", static_cast<int>(s.cost));
+        wr3.write_field<int>("entries", static_cast<int>(s.entries));
+        wr3.write_field<int>("hit", static_cast<int>(s.hits));
+        wr3.write_field<int>("miss", static_cast<int>(s.misses));
+        wr3.write_field<double>("hit-rate", s.hit_rate());
+    };
+
+    write("features", x.features.cache_stats());
+    write("feat2rids", x.feat2rids.cache_stats());
+}
+
+
 } // end of json
 
 } // end of dav
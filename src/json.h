@@ -30,6 +30,16 @@ template <> string_t val2str<int>(const int &x);
 template <> string_t val2str<double>(const double &x);
 template <> string_t val2str<float>(const float &x);
 
+/** Writes given string to the stream with quotation marks, without temporary strings. */
+void write_string(std::ostream *os, const string_t &x);
+
+template <typename T> void write_value(std::ostream *os, const T &x); // Don't define.
+template <> void write_value<string_t>(std::ostream *os, const string_t &x);
+template <> void write_value<bool>(std::ostream *os, const bool &x);
+template <> void write_value<int>(std::ostream *os, const int &x);
+template <> void write_value<double>(std::ostream *os, const double &x);
+template <> void write_value<float>(std::ostream *os, const float &x);
+
 template <typename T, class It> string_t array2str(It begin, It end, bool is_on_one_line)
 {
     string_t delim = is_on_one_line ? " " : "\n";
@@ -57,6 +67,53 @@ string_t array2str_if(It begin, It end, bool is_on_one_line, const Pred &pred)
     return out;
 }
 
+/**
+ * @brief Stream-buffer which writes bytes to a file descriptor.
+ * @details
+ *   Bytes are accumulated in a large reusable buffer and written with write(2).
+ *   A chunk larger than the buffer is written together with the buffered bytes by writev(2).
+ */
+class file_buffer_t : public std::streambuf
+{
+public:
+    static const size_t DEFAULT_SIZE = (1 << 20);
+
+    file_buffer_t(int fd, bool do_close, size_t size = DEFAULT_SIZE);
+    ~file_buffer_t();
+
+    file_buffer_t(const file_buffer_t&) = delete;
+    file_buffer_t& operator=(const file_buffer_t&) = delete;
+
+    int fd() const { return m_fd; }
+
+protected:
+    virtual int_type overflow(int_type c) override;
+    virtual std::streamsize xsputn(const char *s, std::streamsize n) override;
+    virtual int sync() override;
+
+private:
+    bool write_all(const char *s1, size_t n1, const char *s2 = nullptr, size_t n2 = 0);
+    bool flush_buffer();
+
+    int m_fd;
+    bool m_do_close; /// If true, the descriptor is closed on destruction.
+    std::vector<char> m_buffer;
+};
+
+
+/** Output-stream to write JSON into a file or stdout through file_buffer_t. */
+class file_stream_t : public std::ostream
+{
+public:
+    /** @param path Path of the output. "-" means stdout. */
+    file_stream_t(const filepath_t &path);
+    ~file_stream_t();
+
+private:
+    std::unique_ptr<file_buffer_t> m_buffer;
+};
+
+
 /** Class to decorate JSON output. */
 template <class T> class decorator_t
 {
@@ -104,8 +161,8 @@ public:
     void write_field(const string_t &key, const T &value)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : " << val2str<T>(value);
+        write_key(key);
+        write_value<T>(m_os, value);
         ++m_num;
     }
 
@@ -113,8 +170,7 @@ public:
     void write_field_with_converter(const string_t &key, const T &value, const json::converter_t<T> &cnv)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : ";
+        write_key(key);
         cnv(value, m_os);
         ++m_num;
     }
@@ -123,8 +179,15 @@ public:
     void write_array_field(const string_t &key, It begin, It end, bool is_on_one_line)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : " << array2str<T>(begin, end, is_on_one_line);
+        write_key(key);
+        (*m_os) << '[';
+        for (It it = begin; it != end; ++it)
+        {
+            if (it != begin) (*m_os) << ',';
+            (*m_os) << delim(is_on_one_line);
+            write_value<T>(m_os, *it);
+        }
+        (*m_os) << delim(is_on_one_line) << ']';
         ++m_num;
     }
 
@@ -133,8 +196,17 @@ public:
         const string_t &key, It begin, It end, bool is_on_one_line, const Pred &pred)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : " << array2str_if<T>(begin, end, is_on_one_line, pred);
+        write_key(key);
+        (*m_os) << '[';
+        int n(0);
+        for (It it = begin; it != end; ++it)
+        {
+            if (not pred(*it)) continue;
+            if (++n > 1) (*m_os) << ',';
+            (*m_os) << delim(is_on_one_line);
+            write_value<T>(m_os, *it);
+        }
+        (*m_os) << delim(is_on_one_line) << ']';
         ++m_num;
     }
 
@@ -143,8 +215,8 @@ public:
         const string_t &key, It begin, It end, json::converter_t<T> &cnv, bool is_on_one_line)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : [";
+        write_key(key);
+        (*m_os) << '[';
         for (It it = begin; it != end; ++it)
         {
             if (it != begin) (*m_os) << ',' << delim(is_on_one_line);
@@ -160,8 +232,8 @@ public:
         const string_t &key, It begin, It end, json::converter_t<T> &cnv, bool is_on_one_line)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : [";
+        write_key(key);
+        (*m_os) << '[';
         for (It it = begin; it != end; ++it)
         {
             if (it != begin) (*m_os) << ',' << delim(is_on_one_line);
@@ -169,7 +241,6 @@ public:
             cnv(**it, m_os);
         }
         (*m_os) << delim(is_on_one_line) << "]";
-        (*m_os).flush();
         ++m_num;
     }
 
@@ -179,8 +250,8 @@ public:
         bool is_on_one_line, const Pred &pred)
     {
         assert(not is_on_writing());
-        write_delim();
-        (*m_os) << quot(key) << " : [";
+        write_key(key);
+        (*m_os) << '[';
         int n(0);
         for (It it = begin; it != end; ++it)
         {
@@ -190,7 +261,6 @@ public:
             cnv(*it, m_os);
         }
         (*m_os) << delim(is_on_one_line) << "]";
-        (*m_os).flush();
         ++m_num;
     }
 
@@ -208,6 +278,7 @@ public:
 
 private:
     void write_delim();
+    void write_key(const string_t &key);
     char delim(bool is_on_one_line) const { return is_on_one_line ? ' ' : '\n'; }
 
     std::ostream *m_os;
@@ -235,6 +306,9 @@ public:
     void write_content();
     void write_footer();
 
+    /** Writes the information of the kernel and the knowledge-base to given writer. */
+    static void write_kernel(object_writer_t &wr, const converter_t<kb::knowledge_base_t> &kb2js);
+
     std::shared_ptr<json::converter_t<kb::knowledge_base_t>> kb2js;
     std::shared_ptr<json::converter_t<rule_t>>               rule2js;
     std::shared_ptr<json::converter_t<pg::node_t>>           node2js;
@@ -253,7 +327,7 @@ private:
     int m_num; /// The number of contents written.
     format_type_e m_type;
 
-    std::unique_ptr<std::ofstream> m_fout;
+    std::unique_ptr<std::ostream> m_fout;
     std::unique_ptr<object_writer_t> m_writer;
 };
 
@@ -463,6 +537,9 @@ class kb2json_t : public json::converter_t<kb::knowledge_base_t>
 {
 public:
     virtual void operator()(const kb::knowledge_base_t&, std::ostream*) const override;
+
+    /** Writes statistics of the caches of lookups on KB as a field `key`. */
+    static void write_cache_stats(object_writer_t &wr, const string_t &key, const kb::knowledge_base_t&);
 };
 
 
@@ -0,0 +1,186 @@
+#include <cerrno>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#include "./json.h"
+
+namespace dav
+{
+
+namespace json
+{
+
+
+file_buffer_t::file_buffer_t(int fd, bool do_close, size_t size)
+    : m_fd(fd), m_do_close(do_close), m_buffer(std::max<size_t>(size, 1))
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+
+file_buffer_t::~file_buffer_t()
+{
+    flush_buffer();
+
+#ifdef _WIN32
+    if (m_do_close and m_fd >= 0) _close(m_fd);
+#else
+    if (m_do_close and m_fd >= 0) close(m_fd);
+#endif
+}
+
+
+file_buffer_t::int_type file_buffer_t::overflow(int_type c)
+{
+    if (not flush_buffer())
+        return traits_type::eof();
+
+    if (not traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+
+std::streamsize file_buffer_t::xsputn(const char *s, std::streamsize n)
+{
+    if (n <= epptr() - pptr())
+    {
+        std::memcpy(pptr(), s, n);
+        pbump(static_cast<int>(n));
+        return n;
+    }
+
+    // SMALL CHUNKS ARE COPIED INTO THE BUFFER AFTER FLUSHING IT.
+    if (static_cast<size_t>(n) < m_buffer.size())
+    {
+        if (not flush_buffer()) return 0;
+        std::memcpy(pptr(), s, n);
+        pbump(static_cast<int>(n));
+        return n;
+    }
+
+    // LARGE CHUNKS ARE WRITTEN DIRECTLY, TOGETHER WITH BUFFERED BYTES.
+    if (not write_all(pbase(), pptr() - pbase(), s, n)) return 0;
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    return n;
+}
+
+
+int file_buffer_t::sync()
+{
+    return flush_buffer() ? 0 : -1;
+}
+
+
+bool file_buffer_t::flush_buffer()
+{
+    if (pptr() == pbase()) return true;
+
+    bool ok = write_all(pbase(), pptr() - pbase());
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    return ok;
+}
+
+
+bool file_buffer_t::write_all(const char *s1, size_t n1, const char *s2, size_t n2)
+{
+    if (m_fd < 0) return false;
+
+#ifdef _WIN32
+    for (auto p : { std::make_pair(s1, n1), std::make_pair(s2, n2) })
+    {
+        while (p.second > 0)
+        {
+            int n = _write(m_fd, p.first, static_cast<unsigned>(p.second));
+            if (n < 0) return false;
+            p.first += n;
+            p.second -= n;
+        }
+    }
+#else
+    struct iovec iov[2];
+    int iovcnt(0);
+
+    if (n1 > 0) { iov[iovcnt].iov_base = const_cast<char*>(s1); iov[iovcnt++].iov_len = n1; }
+    if (n2 > 0) { iov[iovcnt].iov_base = const_cast<char*>(s2); iov[iovcnt++].iov_len = n2; }
+
+    struct iovec *v = iov;
+    while (iovcnt > 0)
+    {
+        ssize_t n = writev(m_fd, v, iovcnt);
+
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        // SKIPS WHAT HAS BEEN WRITTEN AND RETRIES THE REST.
+        while (iovcnt > 0 and static_cast<size_t>(n) >= v->iov_len)
+        {
+            n -= v->iov_len;
+            ++v;
+            --iovcnt;
+        }
+        if (iovcnt > 0)
+        {
+            v->iov_base = static_cast<char*>(v->iov_base) + n;
+            v->iov_len -= n;
+        }
+    }
+#endif
+
+    return true;
+}
+
+
+file_stream_t::file_stream_t(const filepath_t &path)
+    : std::ostream(nullptr)
+{
+    int fd;
+    bool do_close(true);
+
+    if (path == "-")
+    {
+        // THE OUTPUT OF std::cout MUST PRECEDE THAT OF THIS STREAM.
+        std::cout.flush();
+        fd = 1;
+        do_close = false;
+    }
+    else
+    {
+#ifdef _WIN32
+        fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    }
+
+    m_buffer.reset(new file_buffer_t(fd, do_close));
+    rdbuf(m_buffer.get());
+
+    if (fd < 0)
+        setstate(std::ios::badbit);
+}
+
+
+file_stream_t::~file_stream_t()
+{
+    flush();
+    rdbuf(nullptr);
+}
+
+
+}
+
+}
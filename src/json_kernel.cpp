@@ -24,7 +24,7 @@ kernel2json_t::kernel2json_t(std::ostream *os, const string_t &key)
 kernel2json_t::kernel2json_t(const filepath_t &path, const string_t &key)
     : m_num(0), m_type(FORMAT_UNDERSPECIFIED)
 {
-    m_fout.reset(new std::ofstream(path.c_str()));
+    m_fout.reset(new file_stream_t(path));
     if (m_fout->fail())
         throw exception_t(format("json::kernel2json_t cannot open \"%s\"", path.c_str()));
     else
@@ -86,9 +86,15 @@ void kernel2json_t::write_header()
     assert(m_writer);
 
     m_writer->write_field<string_t>("output-type", type2str(type()));
+    write_kernel(*m_writer, *kb2js);
+    m_writer->begin_object_array_field("results");
+}
 
+
+void kernel2json_t::write_kernel(object_writer_t &wr, const converter_t<kb::knowledge_base_t> &kb2js)
+{
     {
-        object_writer_t &&wr1 = m_writer->make_object_field_writer("kernel", false);
+        object_writer_t &&wr1 = wr.make_object_field_writer("kernel", false);
 		string_t mode;
 
 		switch (kernel()->cmd.mode)
@@ -117,10 +123,7 @@ void kernel2json_t::write_header()
         }
     }
 
-    m_writer->write_field_with_converter<kb::knowledge_base_t>("knowledge-base", *kb::kb(), (*kb2js));
-
-
-    m_writer->begin_object_array_field("results");
+    wr.write_field_with_converter<kb::knowledge_base_t>("knowledge-base", *kb::kb(), kb2js);
 }
 
 
@@ -128,33 +131,66 @@ void kernel2json_t::write_content()
 {
     assert(m_writer);
 
-    object_writer_t &&wr = m_writer->make_object_array_element_writer(false);
-	bool is_infer_mode = (kernel()->cmd.mode == MODE_INFER);
-
-	if (is_infer_mode)
-	{
-		wr.write_field<int>("index", kernel()->problem().index);
-		wr.write_field<string_t>("name", kernel()->problem().name);
+    {
+        object_writer_t &&wr = m_writer->make_object_array_element_writer(false);
+		bool is_infer_mode = (kernel()->cmd.mode == MODE_INFER);
 
+		if (is_infer_mode)
+		{
+			wr.write_field<int>("index", kernel()->problem().index);
+			wr.write_field<string_t>("name", kernel()->problem().name);
+
+			{
+				object_writer_t &&wr2 = wr.make_object_field_writer("elapsed-time", false);
+				wr2.write_field<time_t>("lhs", kernel()->lhs->timer->duration());
+				if (kernel()->lhs->out)
+					wr2.write_field<time_t>("lhs-exclusion", kernel()->lhs->out->exclusion_time());
+				wr2.write_field<time_t>("cnv", kernel()->cnv->timer->duration());
+				wr2.write_field<time_t>("sol", kernel()->sol->timer->duration());
+				wr2.write_field<time_t>("all", kernel()->timer->duration());
+			}
+
+			if (param()->has("metrics"))
+			{
+				object_writer_t &&wr2 = wr.make_object_field_writer("metrics", false);
+				for (const auto &p : tracer()->metrics())
+				{
+					const auto &m = p.second;
+					int n = tracer_t::metric_t::NUM_BUCKETS;
+					while (n > 0 and m.histogram[n - 1] == 0) --n;
+
+					object_writer_t &&wr3 = wr2.make_object_field_writer(p.first, true);
+					wr3.write_field<int>("count", static_cast<int>(m.count));
+					wr3.write_field<double>("time", m.total * 1.0e-6);
+					wr3.write_field<double>("max", m.max * 1.0e-6);
+					wr3.write_array_field<int>("histogram", m.histogram, m.histogram + n, true);
+				}
+			}
+
+			if (param()->has("metrics") and kernel()->lhs->out)
+			{
+				const auto &rsv = kernel()->lhs->out->reservations;
+				object_writer_t &&wr2 = wr.make_object_field_writer("reservation", true);
+				wr2.write_field<int>("waiting", rsv.size());
+				wr2.write_field<int>("hit", rsv.num_hits());
+				wr2.write_field<int>("miss", rsv.num_misses());
+			}
+
+			const auto &sols = kernel()->sol->out;
+
+			if (kernel()->sol->out.size() == 1)
+				wr.write_field_with_converter<ilp::solution_t>("solution", *(sols.front()), (*sol2js));
+			else if (kernel()->sol->out.size() > 1)
+				wr.write_ptr_array_field_with_converter<ilp::solution_t>(
+					"solutions", sols.begin(), sols.end(), (*sol2js), false);
+		}
+		else
 		{
-			object_writer_t &&wr2 = wr.make_object_field_writer("elapsed-time", false);
-			wr2.write_field<time_t>("lhs", kernel()->lhs->timer->duration());
-			wr2.write_field<time_t>("cnv", kernel()->cnv->timer->duration());
-			wr2.write_field<time_t>("sol", kernel()->sol->timer->duration());
-			wr2.write_field<time_t>("all", kernel()->timer->duration());
 		}
+    }
 
-		const auto &sols = kernel()->sol->out;
-
-		if (kernel()->sol->out.size() == 1)
-			wr.write_field_with_converter<ilp::solution_t>("solution", *(sols.front()), (*sol2js));
-		else if (kernel()->sol->out.size() > 1)
-			wr.write_ptr_array_field_with_converter<ilp::solution_t>(
-				"solutions", sols.begin(), sols.end(), (*sol2js), false);
-	}
-	else
-	{
-	}
+    // LETS THE READER OF THE OUTPUT SEE EACH RESULT AS SOON AS IT IS WRITTEN.
+    m_writer->stream().flush();
 }
 
 
@@ -163,6 +199,11 @@ void kernel2json_t::write_footer()
     assert(m_writer);
 
     m_writer->end_object_array_field();
+
+    // THE KB SECTION IS WRITTEN BEFORE INFERENCE, SO THE CACHES ARE REPORTED AGAIN AFTER ALL RESULTS.
+    if (kernel()->cmd.mode == MODE_INFER and kb::kb()->is_readable())
+        kb2json_t::write_cache_stats(*m_writer, "knowledge-base-cache", *kb::kb());
+
     m_writer.reset();
 }
 
@@ -69,8 +69,7 @@ object_writer_t object_writer_t::make_object_field_writer(const string_t &key, b
 {
     assert(not is_on_writing());
 
-    write_delim();
-    (*m_os) << quot(key) << " : ";
+    write_key(key);
     object_writer_t ch(m_os, is_on_one_line, this);
     m_child = &ch;
     ++m_num;
@@ -83,8 +82,8 @@ void object_writer_t::begin_object_array_field(const string_t &key)
 {
     assert(not is_on_writing());
 
-    write_delim();
-    (*m_os) << quot(key) << " : [";
+    write_key(key);
+    (*m_os) << '[';
     m_is_writing_object_array = true;
     m_num_array = 0;
     ++m_num;
@@ -127,6 +126,14 @@ void object_writer_t::write_delim()
 }
 
 
+void object_writer_t::write_key(const string_t &key)
+{
+    write_delim();
+    write_string(m_os, key);
+    (*m_os) << " : ";
+}
+
+
 }
 
 }
\ No newline at end of file
@@ -9,10 +9,29 @@ namespace kb
 std::mutex feature_to_rules_cdb_t::ms_mutex;
 
 
+size_t lookup_cache_capacity()
+{
+    if (param()->has("disable-kb-cache")) return 0;
+
+    // THE CAPACITY IS SHARED EQUALLY BY conjunction_library_t AND feature_to_rules_cdb_t.
+    size_t mib = static_cast<size_t>(std::max(0, param()->geti("kb-cache-size", 64)));
+    return (mib << 20) / 2;
+}
+
+
 void feature_to_rules_cdb_t::prepare_compile()
 {
 	cdb_data_t::prepare_compile();
 	m_feat2rids.clear();
+    m_cache.clear();
+}
+
+
+void feature_to_rules_cdb_t::prepare_query()
+{
+    cdb_data_t::prepare_query();
+    m_cache.clear();
+    m_cache.set_capacity(lookup_cache_capacity());
 }
 
 
@@ -46,52 +65,48 @@ void feature_to_rules_cdb_t::finalize()
 }
 
 
-std::list<rule_id_t> feature_to_rules_cdb_t::gets(
+std::shared_ptr<const std::vector<rule_id_t>> feature_to_rules_cdb_t::gets(
 	const conjunction_template_t &feat, is_backward_t backward) const
 {
 	assert(is_readable());
+	tracer_t::span_t span("kb-feat2rids");
 
-	std::list<rule_id_t> out;
 	char key[512];
 	binary_writer_t key_writer(key, 512);
 
 	key_writer.write<conjunction_template_t>(feat);
 	key_writer.write<char>(backward ? 1 : 0);
 
-	size_t value_size;
-    const char *value;
+    std::string cache_key(key, key_writer.size());
+    auto cached = m_cache.get(cache_key);
+    if (cached) return cached;
+
+	std::shared_ptr<std::vector<rule_id_t>> out(new std::vector<rule_id_t>());
 
     {
         std::lock_guard<std::mutex> lock(ms_mutex);
-        value = (const char*)get(key, key_writer.size(), &value_size);
-    }
-
-	if (value != nullptr)
-	{
-		binary_reader_t val_reader(value, value_size);
-		size_t num = val_reader.get<size_t>();
-
-		for (size_t i = 0; i < num; ++i)
-			out.push_back(val_reader.get<rule_id_t>());
-	}
-
-	return out;
-}
 
+        // RULES IN DELTA SEGMENTS FOLLOW THOSE IN THE BASE.
+        get_each(key, key_writer.size(), [&out](const void *value, size_t value_size)
+        {
+            binary_reader_t val_reader((const char*)value, value_size);
+            size_t num = val_reader.get<size_t>();
 
-void feature_to_rules_cdb_t::insert(const conjunction_t &conj, is_backward_t backward, rule_id_t rid)
-{
-    auto feat = conj.feature();
+            out->reserve(out->size() + num);
+            for (size_t i = 0; i < num; ++i)
+                out->push_back(val_reader.get<rule_id_t>());
+        });
+    }
 
-    if (not feat.empty())
-    	m_feat2rids[std::make_pair(conj.feature(), backward)].insert(rid);
+    size_t cost = sizeof(std::vector<rule_id_t>) + out->size() * sizeof(rule_id_t) + cache_key.size() * 2;
+    return m_cache.put(cache_key, out, cost);
 }
 
 
-void feature_to_rules_cdb_t::insert(const rule_t &r)
+void feature_to_rules_cdb_t::insert(const feature_t &f, rule_id_t rid)
 {
-	insert(r.evidence(false), false, r.rid());
-	insert(r.evidence(true), true, r.rid());
+    if (not f.first.empty())
+    	m_feat2rids[f].insert(rid);
 }
 
 
@@ -30,6 +30,20 @@ enum version_e
 
 
 class heuristic_t;
+class knowledge_base_t;
+
+
+/** A feature of the evidence of a rule, which is a key to look up rules. */
+typedef std::pair<conjunction_template_t, is_backward_t> feature_t;
+
+
+/**
+* @brief Returns the capacity in bytes of each cache of lookups on KB.
+* @details
+*   The option `kb-cache-size` gives the total capacity of the caches in MiB, which is 64 on default.
+*   If the option `disable-kb-cache` is given, nothing is cached.
+*/
+size_t lookup_cache_capacity();
 
 
 /** A class to strage all patterns of conjunctions found in KB. */
@@ -40,10 +54,19 @@ public:
 	~conjunction_library_t();
 
 	virtual void prepare_compile() override;
+	virtual void prepare_query() override;
 	virtual void finalize() override;
 
-	void insert(const rule_t&);
-	std::list<std::pair<conjunction_template_t, is_backward_t>> get(predicate_id_t) const;
+	void insert(const feature_t&);
+
+    /**
+    * @brief Gets features which have given predicate, in order.
+    * @details Results are shared via the cache, which persists over problems.
+    */
+	std::shared_ptr<const std::vector<feature_t>> get(predicate_id_t) const;
+
+    /** Returns statistics of the cache of get(). */
+    cache_stats_t cache_stats() const { return m_cache.stats(); }
 
 private:
     /** Mutex for accessing to CDB. */
@@ -52,6 +75,8 @@ private:
 	std::unordered_map<
 		predicate_id_t,
 		std::set<std::pair<conjunction_template_t, is_backward_t>>> m_features;
+
+    mutable lru_cache_t<predicate_id_t, std::vector<feature_t>> m_cache;
 };
 
 
@@ -62,11 +87,18 @@ public:
 	feature_to_rules_cdb_t(const filepath_t &path) : cdb_data_t(path) {}
 
 	virtual void prepare_compile() override;
+	virtual void prepare_query() override;
 	virtual void finalize() override;
 
-	std::list<rule_id_t> gets(const conjunction_template_t&, is_backward_t) const;
-	void insert(const conjunction_t&, is_backward_t, rule_id_t);
-	void insert(const rule_t&);
+    /**
+    * @brief Gets IDs of rules which have given feature.
+    * @details Results are shared via the cache, which persists over problems.
+    */
+	std::shared_ptr<const std::vector<rule_id_t>> gets(const conjunction_template_t&, is_backward_t) const;
+	void insert(const feature_t&, rule_id_t);
+
+    /** Returns statistics of the cache of gets(). */
+    cache_stats_t cache_stats() const { return m_cache.stats(); }
 
 private:
     /** Mutex for accessing to CDB. */
@@ -75,6 +107,9 @@ private:
 	std::map<
 		std::pair<conjunction_template_t, is_backward_t>,
 		std::unordered_set<rule_id_t>> m_feat2rids;
+
+    /** Cache whose keys are the keys in CDB, namely serialized features. */
+    mutable lru_cache_t<std::string, std::vector<rule_id_t>> m_cache;
 };
 
 
@@ -110,46 +145,197 @@ public:
 	void prepare_query();
 	void finalize();
 
+    /**
+    * @brief Makes prepare_query() read rules on given memory instead of the files.
+    * @details The memory, such as sections of a mapped image, must outlive READ mode. It is forgotten on finalize().
+    */
+    void assign(const char *idx, size_t idx_size, const char *dat, size_t dat_size);
+
+    /** Sets the number of rules in the preceding segments of KB, which the IDs of rules in this follow. */
+    void set_offset(size_t n) { m_offset = n; }
+
+    /** Returns the number of names generated for unnamed rules, which is stored in the spec of KB. */
+    size_t num_unnamed_rules() const { return m_num_unnamed_rules; }
+
+    /**
+    * @brief Sets the number of names generated for unnamed rules in the preceding segments.
+    * @details This must be called after prepare_compile(), so that names of new rules follow them.
+    */
+    void set_num_unnamed_rules(size_t n) { m_num_unnamed_rules = n; }
+
+    /**
+    * @brief Links the rule-library of a delta segment, whose rules follow those of this and of deltas linked before.
+    * @details This must be called in READ mode, and `delta` must be readable while this is readable.
+    */
+    void add_delta(const rule_library_t *delta) { m_deltas.push_back(delta); }
+
 	rule_id_t add(rule_t &r);
 	rule_t get(rule_id_t id) const;
 
+    /**
+    * @brief Gets the side of a rule preprocessed for chaining in given direction.
+    * @details Results are cached unless the option `disable-kb-cache` is given.
+    */
+    std::shared_ptr<const rule_side_t> side(rule_id_t id, is_backward_t backward) const;
+
     rule_id_t add_temporally(const rule_t &r);
 
-    /** Returns number of rules EXCLUDING temporal rules. */
+    /** Returns number of rules EXCLUDING temporal rules, including those of the preceding and delta segments. */
     size_t size() const;
     inline bool empty() const { return size() == 0; }
 
     bool is_writable() const;
     bool is_readable() const;
 
+	filepath_t filepath_idx() const { return m_filename + ".idx.cdb"; }
+	filepath_t filepath_dat() const { return m_filename + ".dat.cdb"; }
+
 private:
 	typedef unsigned long long pos_t;
 
 	string_t get_name_of_unnamed_axiom();
-	filepath_t filepath_idx() const { return m_filename + ".idx.cdb"; }
-	filepath_t filepath_dat() const { return m_filename + ".dat.cdb"; }
+
+    /** Decodes the rule of given ID, which must be in this segment. */
+    rule_t read(rule_id_t id) const;
 
     /** Mutex for methods callable in read-mode. */
 	static std::recursive_mutex ms_mutex;
 
 	filepath_t m_filename;
 	std::unique_ptr<std::ofstream> m_fo_idx, m_fo_dat;
-	std::unique_ptr<std::ifstream> m_fi_idx, m_fi_dat;
-	size_t m_num_rules;
+	std::unique_ptr<mapped_file_t> m_fi_idx, m_fi_dat;
+
+    /** The index and the data of rules on memory in READ mode, which are mapped files or given by assign(). */
+    std::pair<const char*, size_t> m_idx, m_dat;
+    std::pair<const char*, size_t> m_assigned_idx, m_assigned_dat;
+
+	size_t m_num_rules; /// The number of rules in this segment.
 	size_t m_num_unnamed_rules;
+    size_t m_offset;
+    std::vector<const rule_library_t*> m_deltas;
 	pos_t m_writing_pos;
 
     std::unique_ptr<std::unordered_map<rule_id_t, rule_t>> m_cache;
+    std::unique_ptr<std::unordered_map<rule_id_t, std::shared_ptr<const rule_side_t>>> m_sides[2];
 
     std::deque<rule_t> m_tmp_rules;
 };
 
 
+/**
+* @brief Rules compiled at once and their indices, which make up a part of knowledge-base.
+* @details
+*   KB consists of the base segment and delta segments, which are appended by compiling incrementally.
+*   The files of each delta segment are named as those of the base, but with the prefix `KB.deltaN`.
+*/
+class segment_t
+{
+public:
+    segment_t(const filepath_t &prefix);
+
+    segment_t(const segment_t&) = delete;
+    segment_t& operator=(const segment_t&) = delete;
+
+    /** Opens the files of this segment in WRITE mode. */
+    void prepare_compile();
+
+    /** Opens the files of this segment in READ mode. */
+    void prepare_query();
+
+    /** Closes the files of this segment. */
+    void finalize();
+
+    /**
+    * @brief Links a delta segment, so that lookups on this find the rules in `delta` too.
+    * @details This must be called in READ mode, and `delta` must be readable while this is readable.
+    */
+    void add_delta(const segment_t &delta);
+
+    /** Returns the indices of this segment. */
+    std::vector<cdb_data_t*> indices();
+
+    /** Returns all files of this segment. */
+    std::vector<filepath_t> files() const;
+
+    rule_library_t rules;
+	conjunction_library_t features;
+	feature_to_rules_cdb_t feat2rids;
+	rules_cdb_t<predicate_id_t> lhs2rids;
+	rules_cdb_t<predicate_id_t> rhs2rids;
+	rules_cdb_t<rule_class_t> class2rids;
+};
+
+
+/**
+* @brief Entries of the indices of knowledge-base for some rules.
+* @details
+*   Extracting features from rules is the major cost of adding rules to KB.
+*   So entries are extracted into this independently of KB, which can be done in parallel,
+*   and then are merged into KB in the order of rule-IDs.
+*/
+class rule_indices_t
+{
+public:
+    /** Extracts entries from given rule, whose ID must have been assigned. */
+    void insert(const rule_t &r);
+
+    /** Adds entries extracted so far to the indices of `seg`. */
+    void merge_into(segment_t *seg) const;
+
+private:
+    std::vector<std::pair<feature_t, rule_id_t>> m_features;
+    std::vector<std::pair<predicate_id_t, rule_id_t>> m_lhs, m_rhs;
+    std::vector<std::pair<rule_class_t, rule_id_t>> m_classes;
+};
+
+
+/**
+* @brief Single-file image of a compiled knowledge-base.
+* @details
+*   An image consists of a header, a table of sections and the sections,
+*   each of which is the content of one of the files of a compiled KB, such as the CDB of an index.
+*   Sections are aligned to pages, so that they are used directly on the memory mapped.
+*/
+class image_t
+{
+public:
+    /** A section on memory, namely its head and its byte size. */
+    typedef std::pair<const char*, size_t> section_t;
+
+    /**
+    * @brief Writes an image which consists of given files.
+    * @param[in] path Filepath of the image to write.
+    * @param[in] files Pairs of the name of each section and the file to be its content.
+    * @param[in] version Version of the KB to which the files belong.
+    */
+    static void write(
+        const filepath_t &path,
+        const std::vector<std::pair<std::string, filepath_t>> &files, version_e version);
+
+    /** Maps given image onto memory, and throws an exception if its header is broken. */
+    image_t(const filepath_t &path);
+
+    /** Returns the section of given name, or a pair of nullptr and 0 if not found. */
+    section_t section(const std::string &name) const;
+
+    version_e version() const { return m_version; }
+    const filepath_t& filepath() const { return m_path; }
+    size_t size() const { return m_file.size(); }
+
+private:
+    filepath_t m_path;
+    mapped_file_t m_file;
+    version_e m_version;
+    std::unordered_map<std::string, section_t> m_sections;
+};
+
+
 /**
  * A class of knowledge-base.
  * This class is based on Singleton pattern.
+ * Members inherited from segment_t look up rules in all segments of KB.
  */
-class knowledge_base_t
+class knowledge_base_t : public segment_t
 {
 public:
     static void initialize(const filepath_t&);
@@ -160,27 +346,60 @@ public:
     /** Prepares for compiling knowledge base. Call this before compiling KB. */
     void prepare_compile();
 
+    /**
+    * @brief Prepares for appending rules to the compiled KB. Call this instead of prepare_compile() to compile KB incrementally.
+    * @details
+    *   New rules are written to a new delta segment, and the heuristic is updated only for them on finalize().
+    *   The predicate-library of KB is loaded, so that predicates keep their IDs.
+    */
+    void prepare_append();
+
+    /**
+    * @brief Folds the delta segments of the compiled KB into its base segment.
+    * @details Rules keep their IDs, so that the heuristic is kept as it is.
+    */
+    void compact();
+
     /** Prepares for reading knowledge base. Call this before reading KB. */
     void prepare_query(bool do_prepare_heuristic = true);
 
     /** Does the postprocess of compiling or reading. */
     void finalize();
 
+    /**
+    * @brief Loads the predicate-library of this KB.
+    * @details If the image of KB exists, predicates are read from it, otherwise from the file of the predicate-library.
+    */
+    void load_predicates();
+
     /** Adds a new rule to KB. */
 	void add(rule_t &r);
 
+    /**
+    * @brief Adds new rules to KB, extracting their indices in parallel.
+    * @param[in,out] rules Lists of rules, which are given IDs in the order.
+    * @param[in] pool Pool of threads to extract indices.
+    * @details The result is the same as calling add() for each rule in the order.
+    */
+    void add(std::vector<std::list<rule_t>*> &rules, task_pool_t *pool);
+
     version_e version() const     { return m_version; }
     bool is_valid_version() const { return m_version == KB_VERSION_2; }
     bool is_writable() const      { return m_state == STATE_COMPILE; }
     bool is_readable() const      { return m_state == STATE_QUERY; }
     const filepath_t& filepath() const { return m_path; }
 
-    rule_library_t rules;
-	conjunction_library_t features;
-	feature_to_rules_cdb_t feat2rids;
-	rules_cdb_t<predicate_id_t> lhs2rids;
-	rules_cdb_t<predicate_id_t> rhs2rids;
-	rules_cdb_t<rule_class_t> class2rids;
+    /** Returns the filepath of the image of KB, which is written on compiling with the option `kb-image`. */
+    filepath_t filepath_image() const { return m_path + ".image"; }
+
+    /** Returns the image of KB mapped on reading, or nullptr if KB is read from separate files. */
+    const image_t* image() const { return m_image.get(); }
+
+    /** Returns the number of delta segments of KB. */
+    size_t num_deltas() const { return m_num_deltas; }
+
+    /** Returns the prefix of the files of the `i`-th delta segment, which starts from 1. */
+    filepath_t filepath_delta(size_t i) const { return m_path + format(".delta%d", static_cast<int>(i)); }
 
     std::unique_ptr<heuristic_t> heuristic;
 
@@ -191,14 +410,34 @@ private:
 
     void initialize_heuristic();
 
-	void write_spec(const filepath_t&) const;
-    void read_spec(const filepath_t&);
+	void write_spec(const filepath_t&, size_t num_rules) const;
+    void read_spec(std::istream*);
+
+    /** Maps the image of KB onto memory if it exists and has not been mapped yet. */
+    void map_image();
+
+    /** Returns the section of the image which has the content of given file of KB. */
+    image_t::section_t section(const filepath_t &file) const;
+
+    /** Writes the image of KB, which consists of all files of KB. */
+    void write_image() const;
+
+    /** Removes the files of delta segments and the image, which are left by the previous KB. */
+    void remove_old_files();
 
     static std::unique_ptr<knowledge_base_t, deleter_t<knowledge_base_t>> ms_instance;
 
     kb_state_e m_state;
     version_e m_version;
 	filepath_t m_path;
+
+    std::unique_ptr<image_t> m_image;
+
+    size_t m_num_deltas;
+    size_t m_num_unnamed_rules; /// The number of names generated for unnamed rules in all segments.
+    std::vector<std::unique_ptr<segment_t>> m_deltas; /// Delta segments opened, in the order.
+    segment_t *m_target; /// The segment to which rules are added in WRITE mode.
+    rule_id_t m_appended_from; /// The ID of the first rule appended by prepare_append(), or 0.
 };
 
 inline knowledge_base_t* kb() { return knowledge_base_t::instance(); }
@@ -248,23 +487,19 @@ template <typename T> void rules_cdb_t<T>::finalize()
 template <typename T> std::list<rule_id_t> rules_cdb_t<T>::gets(const T &key) const
 {
     assert(is_readable());
+    tracer_t::span_t span("kb-rids");
 
     std::list<rule_id_t> out;
     char key_bin[512];
     binary_writer_t key_writer(key_bin, 512);
     key_writer.write<T>(key);
 
-    size_t value_size;
-    const char *value;
+    std::lock_guard<std::mutex> lock(ms_mutex);
 
+    // RULES IN DELTA SEGMENTS FOLLOW THOSE IN THE BASE.
+    get_each(key_bin, key_writer.size(), [&out](const void *value, size_t value_size)
     {
-        std::lock_guard<std::mutex> lock(ms_mutex);
-        value = (const char*)get(key_bin, key_writer.size(), &value_size);
-    }
-
-    if (value != nullptr)
-    {
-        binary_reader_t value_reader(value, value_size);
+        binary_reader_t value_reader((const char*)value, value_size);
         size_t num(0);
         value_reader.read<size_t>(&num);
 
@@ -274,7 +509,7 @@ template <typename T> std::list<rule_id_t> rules_cdb_t<T>::gets(const T &key) co
             value_reader.read<rule_id_t>(&rid);
             out.push_back(rid);
         }
-    }
+    });
 
     return out;
 }
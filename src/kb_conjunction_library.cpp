@@ -25,6 +25,15 @@ void conjunction_library_t::prepare_compile()
 {
     cdb_data_t::prepare_compile();
     m_features.clear();
+    m_cache.clear();
+}
+
+
+void conjunction_library_t::prepare_query()
+{
+    cdb_data_t::prepare_query();
+    m_cache.clear();
+    m_cache.set_capacity(lookup_cache_capacity());
 }
 
 
@@ -61,56 +70,59 @@ void conjunction_library_t::finalize()
 }
 
 
-void conjunction_library_t::insert(const rule_t &r)
+void conjunction_library_t::insert(const feature_t &f)
 {
     assert(is_writable());
 
-    std::pair<conjunction_template_t, is_backward_t>
-        vl(r.evidence(false).feature(), false),
-        vr(r.evidence(true).feature(), true);
-
     // TODO: abstractȀqƋLĂ̂͒ǉΏۂ珜O
 
-    if (not vl.first.empty())
-        for (const auto &p : vl.first.pids)
-            m_features[p].insert(vl);
-
-    if (not vr.first.empty())
-        for (const auto &p : vr.first.pids)
-            m_features[p].insert(vr);
+    if (not f.first.empty())
+        for (const auto &p : f.first.pids)
+            m_features[p].insert(f);
 }
 
 
-std::list<std::pair<conjunction_template_t, is_backward_t>>
-conjunction_library_t::get(predicate_id_t pid) const
+std::shared_ptr<const std::vector<feature_t>> conjunction_library_t::get(predicate_id_t pid) const
 {
     assert(is_readable());
+    tracer_t::span_t span("kb-features");
 
-    std::list<std::pair<conjunction_template_t, is_backward_t>> out;
-    size_t value_size;
-    const char *value;
+    auto cached = m_cache.get(pid);
+    if (cached) return cached;
 
-    {
-        std::lock_guard<std::mutex> lock(ms_mutex);
-        value = (const char*)cdb_data_t::get(&pid, sizeof(predicate_id_t), &value_size);
-    }
+    std::shared_ptr<std::vector<feature_t>> out(new std::vector<feature_t>());
+    size_t total_size(0), num_values(0);
 
-    if (value != nullptr)
     {
-        binary_reader_t reader(value, value_size);
-        size_t num = reader.get<size_t>();
+        std::lock_guard<std::mutex> lock(ms_mutex);
 
-        out.assign(num, std::pair<conjunction_template_t, is_backward_t>());
-        for (auto &p : out)
+        num_values = get_each(&pid, sizeof(predicate_id_t), [&](const void *value, size_t value_size)
         {
-            reader.read<conjunction_template_t>(&p.first);
-            p.second = (reader.get<char>() != 0);
-        }
+            binary_reader_t reader((const char*)value, value_size);
+            size_t num = reader.get<size_t>();
+
+            out->resize(out->size() + num);
+            for (auto it = out->end() - num; it != out->end(); ++it)
+            {
+                reader.read<conjunction_template_t>(&it->first);
+                it->second = (reader.get<char>() != 0);
+            }
+
+            assert(reader.size() == reader.max_size());
+            total_size += value_size;
+        });
+    }
 
-        assert(reader.size() == reader.max_size());
+    // FEATURES OF EACH SEGMENT ARE IN ORDER, BUT THOSE OF MULTIPLE SEGMENTS MUST BE MERGED.
+    if (num_values > 1)
+    {
+        std::sort(out->begin(), out->end());
+        out->erase(std::unique(out->begin(), out->end()), out->end());
     }
 
-    return out;
+    // THE COST IS ESTIMATED FROM THE SIZE OF THE VALUE IN CDB.
+    size_t cost = sizeof(std::vector<feature_t>) + out->size() * sizeof(feature_t) + total_size;
+    return m_cache.put(pid, out, cost);
 }
 
 
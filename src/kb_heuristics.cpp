@@ -1,5 +1,9 @@
 #include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
 #include <algorithm>
+#include <queue>
 
 #include "./kb_heuristics.h"
 #include "./json.h"
@@ -12,6 +16,13 @@ namespace kb
 {
 
 
+void heuristic_t::update(rule_id_t /*begin*/)
+{
+    LOG_ROUGH("this heuristic cannot be updated incrementally, so it is compiled from scratch.");
+    compile();
+}
+
+
 heuristic_t* make_heuristic(const string_t &name, const filepath_t &path)
 {
     if (name == "basic")
@@ -20,6 +31,12 @@ heuristic_t* make_heuristic(const string_t &name, const filepath_t &path)
         return new heuristics::predicate_distance_t(path, df_key);
     }
 
+    if (name == "landmark")
+    {
+        string_t df_key = param()->get("dist-func", "const");
+        return new heuristics::landmark_distance_t(path, df_key);
+    }
+
     if (name == "null" or name.empty())
         return new heuristics::null_heuristic_t();
     
@@ -63,10 +80,80 @@ template <class Map, class Key, class Value> bool update_min(
 }
 
 
+namespace
+{
+const char DISTANCE_MAGIC[8] = { 'D', 'A', 'V', 'I', 'D', 'P', 'D', 'Q' };
+
+/** The number of entries in each block of a compressed row, whose first predicate-ID is in the index of blocks. */
+const uint32_t DISTANCE_BLOCK_SIZE = 16;
+
+
+/** The header of files of predicate_distance_t in compressed formats. */
+struct distance_header_t
+{
+    char magic[8];
+    uint32_t format;
+    uint32_t block_size;
+    float step;
+    uint32_t reserved;
+    uint64_t index_pos;
+};
+
+
+predicate_distance_t::format_e parse_distance_format(const string_t &key)
+{
+    if (key == "q16") return predicate_distance_t::FORMAT_Q16;
+    if (key == "q8")  return predicate_distance_t::FORMAT_Q8;
+    if (key == "raw") return predicate_distance_t::FORMAT_RAW;
+
+    throw exception_t(format("Invalid distance-format: \"%s\"", key.c_str()));
+}
+
+
+const char* distance_format_name(predicate_distance_t::format_e f)
+{
+    switch (f)
+    {
+    case predicate_distance_t::FORMAT_Q16: return "q16";
+    case predicate_distance_t::FORMAT_Q8:  return "q8";
+    default: return "raw";
+    }
+}
+
+
+/** Returns the size in bytes of each quantized distance. */
+size_t distance_size(predicate_distance_t::format_e f)
+{
+    return (f == predicate_distance_t::FORMAT_Q8) ? sizeof(uint8_t) : sizeof(uint16_t);
+}
+
+
+void write_varint(std::string *out, uint64_t x)
+{
+    for (; x >= 0x80; x >>= 7)
+        out->push_back(static_cast<char>((x & 0x7f) | 0x80));
+    out->push_back(static_cast<char>(x));
+}
+
+
+uint64_t read_varint(const unsigned char **p)
+{
+    uint64_t out(0);
+    for (int shift = 0; ; shift += 7, ++(*p))
+    {
+        out |= static_cast<uint64_t>(**p & 0x7f) << shift;
+        if ((**p & 0x80) == 0) break;
+    }
+    ++(*p);
+    return out;
+}
+}
+
+
 std::mutex predicate_distance_t::ms_mutex;
 
 
-std::function<float(rule_id_t)> predicate_distance_t::distance_function(const string_t &key)
+predicate_distance_t::distance_function_t predicate_distance_t::distance_function(const string_t &key)
 {
     if (key == "const")
         return [](rule_id_t) { return 1.0f; };
@@ -76,7 +163,9 @@ std::function<float(rule_id_t)> predicate_distance_t::distance_function(const st
 
 
 predicate_distance_t::predicate_distance_t(const filepath_t &p, const string_t &df_key)
-    : heuristic_t(p), m_df_key(df_key), m_dist(distance_function(df_key))
+    : heuristic_t(p), m_df_key(df_key), m_dist(distance_function(df_key)),
+      m_out_format(parse_distance_format(param()->get("distance-format", "q16"))),
+      m_format(m_out_format), m_step(0.0f), m_index(nullptr), m_num_indexed(0)
 {
     m_max_distance = static_cast<float>(param()->getf("max-distance"));
     m_max_depth = param()->geti("max-depth", 5);
@@ -88,20 +177,24 @@ void predicate_distance_t::compile()
     assert(kb()->is_readable());
 
     m_fin.reset();
+    m_data = std::make_pair(nullptr, 0);
     m_fout.reset(new std::ofstream(m_filepath.c_str(), std::ios::binary | std::ios::out));
     m_pid2pos.clear();
 
-    /** CfbNXւ̃|C^ނ߂̗̈mۂĂ. */
-    pos_t pos(0);
-    m_fout->write((const char*)&pos, sizeof(pos_t));
-
     time_watcher_t watch1;
     
     distance_matrix_t mtx_f, mtx_b;
     LOG_ROUGH("making adjacency matrix ...");
     make_adjacency_matrix(&mtx_f, &mtx_b);
 
+    m_format = m_out_format;
+    m_step = quantization_step(mtx_f);
+
+    /** CfbNXւ̃|C^ނ߂̗̈mۂĂ. */
+    write_header();
+
     LOG_ROUGH("making distance matrix ...");
+    float max_error(0.0f);
     {
         progress_bar_t prog(0, plib()->predicates().size(), verboseness_e::MIDDLE);
         matrix_writer_t mtx(param()->get("reachability-matrix-out")); // FOR DEBUG
@@ -113,7 +206,7 @@ void predicate_distance_t::compile()
 
             std::unordered_map<predicate_id_t, float> pid2dist;
             make_distance_matrix(pred.pid(), mtx_f, mtx_b, &pid2dist);
-            write(pred.pid(), pid2dist);
+            max_error = std::max(max_error, write(pred.pid(), pid2dist));
             mtx.write(pred.pid(), pid2dist);
 
             prog.set(pred.pid());
@@ -121,27 +214,184 @@ void predicate_distance_t::compile()
     }
 
     LOG_ROUGH("writing indices to database ...");
+    write_index();
+
+    if (m_format != FORMAT_RAW)
+        LOG_ROUGH(format("maximum under-estimate of quantized distances: %g", max_error));
+
+    LOG_ROUGH("finished.");
+}
 
-    pos = m_fout->tellp();
-    size_t num = m_pid2pos.size();
 
-    m_fout->write((const char*)&num, sizeof(size_t));
+void predicate_distance_t::update(rule_id_t begin)
+{
+    assert(kb()->is_readable());
 
-    for (const auto &p : m_pid2pos)
+    if (not m_filepath.find_file())
     {
-        m_fout->write((const char*)&p.first, sizeof(predicate_id_t));
-        m_fout->write((const char*)&p.second, sizeof(pos_t));
+        compile();
+        return;
     }
 
-    m_fout->seekp(0, std::ios::beg);
-    m_fout->write((const char*)&pos, sizeof(pos_t));
+    // THE OLD TABLE IS KEPT ON MEMORY, FROM WHICH UNCHANGED ROWS ARE COPIED.
+    load();
+    std::unordered_map<predicate_id_t, std::pair<const char*, size_t>> old_rows;
 
-    m_fout.reset();
+    for (const auto &pred : plib()->predicates())
+        if (const char *r = row(pred.pid()))
+            old_rows[pred.pid()] = std::make_pair(r, row_size(r));
+
+    std::unique_ptr<mapped_file_t> old_file(std::move(m_fin));
+    m_data = std::make_pair(nullptr, 0);
+    m_pid2pos.clear();
+    m_index = nullptr;
+    m_num_indexed = 0;
+
+    distance_matrix_t mtx_f, mtx_b;
+    LOG_ROUGH("making adjacency matrix ...");
+    make_adjacency_matrix(&mtx_f, &mtx_b);
+
+    // ROWS CAN BE COPIED ONLY IF THEY ARE QUANTIZED IN THE SAME WAY.
+    format_e old_format = m_format;
+    float old_step = m_step;
+
+    m_format = m_out_format;
+    m_step = quantization_step(mtx_f);
+
+    if (m_format != old_format or m_step != old_step)
+    {
+        LOG_ROUGH("the format of distances has been changed, so that all rows are recomputed.");
+        old_file.reset();
+        compile();
+        return;
+    }
+
+    std::unordered_set<predicate_id_t> changed;
+    for (rule_id_t rid = begin; rid <= static_cast<rule_id_t>(kb()->rules.size()); ++rid)
+    {
+        rule_t r = kb()->rules.get(rid);
+        for (const auto &a : r.lhs()) changed.insert(a.pid());
+        for (const auto &a : r.rhs()) changed.insert(a.pid());
+    }
+
+    std::unordered_set<predicate_id_t> &&affected = reachable_to(changed, mtx_f, mtx_b);
+
+    // THE NEW TABLE IS RENAMED AFTER WRITTEN, SINCE THE OLD ONE IS READ UNTIL THEN.
+    filepath_t tmp = m_filepath + ".tmp";
+    m_fout.reset(new std::ofstream(tmp.c_str(), std::ios::binary | std::ios::out));
+
+    if (m_fout->fail())
+        throw exception_t(format("kb::predicate_distance_t cannot open \"%s\"", tmp.c_str()));
+
+    write_header();
+
+    LOG_ROUGH("updating distance matrix ...");
+    size_t num_updated(0);
+    float max_error(0.0f);
+    {
+        progress_bar_t prog(0, plib()->predicates().size(), verboseness_e::MIDDLE);
+
+        for (const auto &pred : plib()->predicates())
+        {
+            if (not pred.good()) continue;
+            if (pred.is_equality()) continue;
+
+            auto found = old_rows.find(pred.pid());
+
+            if (found == old_rows.end() or affected.count(pred.pid()) > 0)
+            {
+                std::unordered_map<predicate_id_t, float> pid2dist;
+                make_distance_matrix(pred.pid(), mtx_f, mtx_b, &pid2dist);
+                max_error = std::max(max_error, write(pred.pid(), pid2dist));
+                ++num_updated;
+            }
+            else
+            {
+                m_pid2pos.insert(std::make_pair(pred.pid(), m_fout->tellp()));
+                m_fout->write(found->second.first, found->second.second);
+            }
+
+            prog.set(pred.pid());
+        }
+    }
+
+    LOG_ROUGH(format("updated %d rows of distance matrix.", num_updated));
+    write_index();
+
+    if (m_format != FORMAT_RAW)
+        LOG_ROUGH(format("maximum under-estimate of quantized distances: %g", max_error));
+    old_file.reset();
+
+    if (std::rename(tmp.c_str(), m_filepath.c_str()) != 0)
+        throw exception_t(format("kb::predicate_distance_t cannot rename \"%s\"", tmp.c_str()));
 
     LOG_ROUGH("finished.");
 }
 
 
+void predicate_distance_t::write_header()
+{
+    if (m_format == FORMAT_RAW)
+    {
+        // THE POSITION OF THE INDEX, WHICH IS WRITTEN IN write_index().
+        pos_t pos(0);
+        m_fout->write((const char*)&pos, sizeof(pos_t));
+    }
+    else
+    {
+        distance_header_t header;
+        std::memcpy(header.magic, DISTANCE_MAGIC, sizeof(DISTANCE_MAGIC));
+        header.format = static_cast<uint32_t>(m_format);
+        header.block_size = DISTANCE_BLOCK_SIZE;
+        header.step = m_step;
+        header.reserved = 0;
+        header.index_pos = 0;
+        m_fout->write((const char*)&header, sizeof(distance_header_t));
+    }
+}
+
+
+void predicate_distance_t::write_index()
+{
+    pos_t pos = m_fout->tellp();
+
+    if (m_format == FORMAT_RAW)
+    {
+        size_t num = m_pid2pos.size();
+
+        m_fout->write((const char*)&num, sizeof(size_t));
+
+        for (const auto &p : m_pid2pos)
+        {
+            m_fout->write((const char*)&p.first, sizeof(predicate_id_t));
+            m_fout->write((const char*)&p.second, sizeof(pos_t));
+        }
+    }
+    else
+    {
+        // POSITIONS OF ROWS ARE INDEXED BY PREDICATE-IDS, SO THAT THE INDEX IS READ ON THE MEMORY AS IT IS.
+        std::vector<uint64_t> index(plib()->predicates().size(), 0);
+        for (const auto &p : m_pid2pos)
+            index.at(p.first) = p.second;
+
+        uint64_t num = index.size();
+        m_fout->write((const char*)&num, sizeof(uint64_t));
+        m_fout->write((const char*)index.data(), sizeof(uint64_t) * index.size());
+    }
+
+    pos_t size = m_fout->tellp();
+    LOG_ROUGH(format("wrote %d rows in %s format: %d bytes", m_pid2pos.size(), distance_format_name(m_format), size));
+
+    if (m_format == FORMAT_RAW)
+        m_fout->seekp(0, std::ios::beg);
+    else
+        m_fout->seekp(offsetof(distance_header_t, index_pos), std::ios::beg);
+    m_fout->write((const char*)&pos, sizeof(pos_t));
+
+    m_fout.reset();
+}
+
+
 void predicate_distance_t::load()
 {
     std::lock_guard<std::mutex> lock(ms_mutex);
@@ -150,18 +400,76 @@ void predicate_distance_t::load()
     predicate_id_t pid;
 
     m_fout.reset();
-    m_fin.reset(new std::ifstream(m_filepath.c_str(), std::ios::binary | std::ios::in));
     m_pid2pos.clear();
+    m_index = nullptr;
+    m_num_indexed = 0;
 
-    m_fin->read((char*)&pos, sizeof(pos_t));
-    m_fin->seekg(pos, std::ios::beg);
+    // DISTANCES ARE READ DIRECTLY FROM THE FILE MAPPED ONTO MEMORY.
+    if (m_data.first == nullptr)
+    {
+        m_fin.reset(new mapped_file_t(m_filepath, false));
+        m_data = std::make_pair(m_fin->data(), m_fin->size());
+    }
 
-    m_fin->read((char*)&num, sizeof(size_t));
-    for (size_t i = 0; i < num; ++i)
+    auto fail = [this]()
     {
-        m_fin->read((char*)&pid, sizeof(predicate_id_t));
-        m_fin->read((char*)&pos, sizeof(pos_t));
-        m_pid2pos.insert(std::make_pair(pid, pos));
+        throw exception_t(format("kb::predicate_distance_t cannot read \"%s\"", m_filepath.c_str()));
+    };
+
+    auto read = [this, &fail](pos_t p, void *out, size_t n) -> pos_t
+    {
+        if (p + n > m_data.second) fail();
+        std::memcpy(out, m_data.first + p, n);
+        return p + n;
+    };
+
+    // FILES IN THE RAW FORMAT HAVE NO HEADER, WHICH ARE WRITTEN BY OLDER VERSIONS TOO.
+    if (m_data.second >= sizeof(distance_header_t) and
+        std::memcmp(m_data.first, DISTANCE_MAGIC, sizeof(DISTANCE_MAGIC)) == 0)
+    {
+        distance_header_t header;
+        uint64_t num_indexed;
+
+        read(0, &header, sizeof(distance_header_t));
+        read(header.index_pos, &num_indexed, sizeof(uint64_t));
+
+        if ((header.format != FORMAT_Q8 and header.format != FORMAT_Q16) or
+            header.block_size != DISTANCE_BLOCK_SIZE or header.index_pos < sizeof(distance_header_t) or
+            num_indexed > (m_data.second - header.index_pos) / sizeof(uint64_t) - 1)
+            fail();
+
+        m_format = static_cast<format_e>(header.format);
+        m_step = header.step;
+        m_index = m_data.first + header.index_pos + sizeof(uint64_t);
+        m_num_indexed = num_indexed;
+
+        // CHECKS THAT ALL ROWS ARE IN THE DATA, SO THAT get() NEEDS NO CHECK.
+        for (pid = 0; pid < m_num_indexed; ++pid)
+        {
+            const char *r = row(pid);
+            if (r == nullptr) continue;
+
+            pos_t p = r - m_data.first;
+            if (p < sizeof(distance_header_t) or p + sizeof(uint32_t) * 2 > header.index_pos or
+                p + row_size(r) > header.index_pos)
+                fail();
+        }
+    }
+    else
+    {
+        m_format = FORMAT_RAW;
+        read(0, &pos, sizeof(pos_t));
+        pos = read(pos, &num, sizeof(size_t));
+
+        for (size_t i = 0; i < num; ++i)
+        {
+            pos_t row;
+            size_t len;
+            pos = read(pos, &pid, sizeof(predicate_id_t));
+            pos = read(pos, &row, sizeof(pos_t));
+            read(row, &len, sizeof(size_t)); // CHECKS THAT THE ROW IS IN THE DATA.
+            m_pid2pos.insert(std::make_pair(pid, row));
+        }
     }
 
     assert(is_readable());
@@ -175,25 +483,77 @@ float predicate_distance_t::get(predicate_id_t pid1, predicate_id_t pid2) const
 
     if (pid1 > pid2) std::swap(pid1, pid2);
 
-    std::lock_guard<std::mutex> lock(ms_mutex);
-    size_t num;
-    predicate_id_t pid;
-    float dist;
+    // THE MEMORY IS READ-ONLY, SO THAT NO LOCK IS NEEDED.
+    const char *r = row(pid1);
+    if (r == nullptr) return -1.0f;
+
+    if (m_format == FORMAT_RAW)
+    {
+        const size_t ENTRY_SIZE = sizeof(predicate_id_t) + sizeof(float);
+        size_t num;
+        predicate_id_t pid;
+        float dist;
+
+        std::memcpy(&num, r, sizeof(size_t));
+
+        if ((r - m_data.first) + sizeof(size_t) + num * ENTRY_SIZE > m_data.second)
+            throw exception_t(format("kb::predicate_distance_t cannot read \"%s\"", m_filepath.c_str()));
 
-    auto found = m_pid2pos.find(pid1);
-    if (found == m_pid2pos.end()) return -1.0f;
+        for (const char *p = r + sizeof(size_t), *end = p + num * ENTRY_SIZE; p != end; p += ENTRY_SIZE)
+        {
+            std::memcpy(&pid, p, sizeof(predicate_id_t));
+            if (pid == pid2)
+            {
+                std::memcpy(&dist, p + sizeof(predicate_id_t), sizeof(float));
+                return dist;
+            }
+        }
+
+        return -1.0f;
+    }
+
+    uint32_t num, pid_bytes, first, offset;
+    std::memcpy(&num, r, sizeof(uint32_t));
+    std::memcpy(&pid_bytes, r + sizeof(uint32_t), sizeof(uint32_t));
 
-    m_fin->seekg(found->second, std::ios::beg);
-    m_fin->read((char*)&num, sizeof(size_t));
+    const size_t num_blocks = (num + DISTANCE_BLOCK_SIZE - 1) / DISTANCE_BLOCK_SIZE;
+    const char *blocks = r + sizeof(uint32_t) * 2;
+    const char *pids = blocks + sizeof(uint32_t) * 2 * num_blocks;
+    const char *dists = pids + pid_bytes;
 
-    for (size_t i = 0; i < num; ++i)
+    // FINDS THE LAST BLOCK WHOSE FIRST PREDICATE IS NOT GREATER THAN pid2.
+    size_t lo(0), hi(num_blocks);
+    while (lo < hi)
     {
-        m_fin->read((char*)&pid, sizeof(size_t));
-        m_fin->read((char*)&dist, sizeof(float));
-        if (pid == pid2) return dist;
+        size_t mid = (lo + hi) / 2;
+        std::memcpy(&first, blocks + sizeof(uint32_t) * 2 * mid, sizeof(uint32_t));
+        if (first <= pid2) lo = mid + 1;
+        else hi = mid;
     }
+    if (lo == 0) return -1.0f;
 
-    return -1.0f;
+    const char *block = blocks + sizeof(uint32_t) * 2 * (lo - 1);
+    std::memcpy(&first, block, sizeof(uint32_t));
+    std::memcpy(&offset, block + sizeof(uint32_t), sizeof(uint32_t));
+
+    size_t i = (lo - 1) * DISTANCE_BLOCK_SIZE;
+    size_t end = std::min<size_t>(num, i + DISTANCE_BLOCK_SIZE);
+    const unsigned char *delta = reinterpret_cast<const unsigned char*>(pids + offset);
+
+    for (predicate_id_t pid = first; pid != pid2;)
+    {
+        if (pid > pid2 or ++i == end) return -1.0f;
+        pid += read_varint(&delta);
+    }
+
+    if (m_format == FORMAT_Q8)
+        return static_cast<uint8_t>(dists[i]) * m_step;
+    else
+    {
+        uint16_t q;
+        std::memcpy(&q, dists + sizeof(uint16_t) * i, sizeof(uint16_t));
+        return q * m_step;
+    }
 }
 
 
@@ -201,6 +561,7 @@ void predicate_distance_t::write_json(json::object_writer_t &wr) const
 {
     wr.write_field<string_t>("name", "predicate-distance");
     wr.write_field<string_t>("distance-function", m_df_key);
+    wr.write_field<string_t>("format", distance_format_name(m_format));
     wr.write_field<float>("max-distance", m_max_distance);
     wr.write_field<int>("max-depth", m_max_depth);
 }
@@ -325,27 +686,228 @@ void predicate_distance_t::make_distance_matrix(
 }
 
 
-void predicate_distance_t::write(
+std::unordered_set<predicate_id_t> predicate_distance_t::reachable_to(
+    const std::unordered_set<predicate_id_t> &pids,
+    const distance_matrix_t &mtx_f, const distance_matrix_t &mtx_b) const
+{
+    // THE SEARCH FROM A PREDICATE FOLLOWS AT MOST (max_depth() + 1) EDGES WITHIN max_distance().
+    // SINCE mtx_b IS THE TRANSPOSE OF mtx_f, PREDICATES REACHING `pids` ARE FOUND BY SEARCHING FROM `pids` ON BOTH.
+    const int max_hops = (max_depth() < 0) ? -1 : max_depth() + 1;
+    std::unordered_map<predicate_id_t, int> hops;
+    std::unordered_map<predicate_id_t, float> dists;
+
+    auto for_each_adjacent = [&](predicate_id_t pid, const std::function<void(predicate_id_t, float)> &f)
+    {
+        for (const auto *mtx : { &mtx_f, &mtx_b })
+        {
+            auto found = mtx->find(pid);
+            if (found != mtx->end())
+                for (const auto &p : found->second)
+                    if (p.first != pid)
+                        f(p.first, p.second);
+        }
+    };
+
+    // MINIMUM NUMBERS OF EDGES, BY BREADTH-FIRST SEARCH.
+    std::deque<predicate_id_t> queue(pids.begin(), pids.end());
+    for (const auto &p : pids)
+        hops[p] = 0;
+
+    while (not queue.empty())
+    {
+        predicate_id_t pid = queue.front();
+        int h = hops.at(pid) + 1;
+        queue.pop_front();
+
+        if (max_hops >= 0 and h > max_hops) continue;
+
+        for_each_adjacent(pid, [&](predicate_id_t p, float)
+        {
+            if (hops.insert(std::make_pair(p, h)).second)
+                queue.push_back(p);
+        });
+    }
+
+    // MINIMUM DISTANCES, BY DIJKSTRA'S ALGORITHM.
+    typedef std::pair<float, predicate_id_t> item_t;
+    std::priority_queue<item_t, std::vector<item_t>, std::greater<item_t>> heap;
+    for (const auto &p : pids)
+    {
+        dists[p] = 0.0f;
+        heap.push(item_t(0.0f, p));
+    }
+
+    while (not heap.empty())
+    {
+        item_t top = heap.top();
+        heap.pop();
+
+        if (top.first > dists.at(top.second)) continue;
+
+        for_each_adjacent(top.second, [&](predicate_id_t p, float d)
+        {
+            float dist = top.first + d;
+            if (max_distance() >= 0.0f and dist > max_distance()) return;
+
+            if (update_min(dists, p, dist))
+                heap.push(item_t(dist, p));
+        });
+    }
+
+    std::unordered_set<predicate_id_t> out;
+    for (const auto &p : hops)
+        if (dists.count(p.first) > 0)
+            out.insert(p.first);
+
+    return out;
+}
+
+
+float predicate_distance_t::write(
     predicate_id_t pid, const std::unordered_map<predicate_id_t, float> &pid2dist)
 {
     std::lock_guard<std::mutex> lock(ms_mutex);
 
     m_pid2pos.insert(std::make_pair(pid, m_fout->tellp()));
 
-    size_t num(0);
+    if (m_format == FORMAT_RAW)
+    {
+        size_t num(0);
+        for (const auto &p : pid2dist)
+            if (pid <= p.first)
+                ++num;
+
+        m_fout->write((const char*)&num, sizeof(size_t));
+        for (const auto &p : pid2dist)
+        {
+            if (pid <= p.first)
+            {
+                m_fout->write((const char*)&p.first, sizeof(predicate_id_t));
+                m_fout->write((const char*)&p.second, sizeof(float));
+            }
+        }
+
+        return 0.0f;
+    }
+
+    std::vector<std::pair<predicate_id_t, float>> entries;
     for (const auto &p : pid2dist)
         if (pid <= p.first)
-            ++num;
+            entries.push_back(p);
+    std::sort(entries.begin(), entries.end());
 
-    m_fout->write((const char*)&num, sizeof(size_t));
-    for (const auto &p : pid2dist)
+    // A ROW CONSISTS OF THE NUMBER OF ENTRIES, THE SIZE OF DELTA-ENCODED PREDICATE-IDS,
+    // THE INDEX OF BLOCKS, DELTA-ENCODED PREDICATE-IDS AND QUANTIZED DISTANCES.
+    const uint32_t q_max = (m_format == FORMAT_Q8) ? UINT8_MAX : UINT16_MAX;
+    std::vector<uint32_t> blocks;
+    std::string pids, dists;
+    float max_error(0.0f);
+
+    for (size_t i = 0; i < entries.size(); ++i)
     {
-        if (pid <= p.first)
+        if (entries[i].first > UINT32_MAX)
+            throw exception_t("kb::predicate_distance_t cannot compress too large predicate-IDs. Use --distance-format=raw.");
+
+        if (i % DISTANCE_BLOCK_SIZE == 0)
         {
-            m_fout->write((const char*)&p.first, sizeof(predicate_id_t));
-            m_fout->write((const char*)&p.second, sizeof(float));
+            blocks.push_back(static_cast<uint32_t>(entries[i].first));
+            blocks.push_back(static_cast<uint32_t>(pids.size()));
         }
+        else
+            write_varint(&pids, entries[i].first - entries[i - 1].first);
+
+        // DISTANCES ARE ROUNDED DOWN, SO THAT THEY REMAIN LOWER BOUNDS FOR A* SEARCH.
+        float dist = entries[i].second;
+        uint32_t q = static_cast<uint32_t>(std::min<double>(q_max, std::floor(dist / m_step)));
+        if (q > 0 and q * m_step > dist) --q;
+        max_error = std::max(max_error, dist - q * m_step);
+
+        if (m_format == FORMAT_Q8)
+            dists.push_back(static_cast<char>(q));
+        else
+        {
+            uint16_t q16 = static_cast<uint16_t>(q);
+            dists.append((const char*)&q16, sizeof(uint16_t));
+        }
+    }
+
+    uint32_t num = static_cast<uint32_t>(entries.size());
+    uint32_t pid_bytes = static_cast<uint32_t>(pids.size());
+
+    m_fout->write((const char*)&num, sizeof(uint32_t));
+    m_fout->write((const char*)&pid_bytes, sizeof(uint32_t));
+    m_fout->write((const char*)blocks.data(), sizeof(uint32_t) * blocks.size());
+    m_fout->write(pids.data(), pids.size());
+    m_fout->write(dists.data(), dists.size());
+
+    return max_error;
+}
+
+
+const char* predicate_distance_t::row(predicate_id_t pid) const
+{
+    if (m_format == FORMAT_RAW)
+    {
+        auto found = m_pid2pos.find(pid);
+        return (found == m_pid2pos.end()) ? nullptr : (m_data.first + found->second);
     }
+
+    if (pid >= m_num_indexed) return nullptr;
+
+    uint64_t pos;
+    std::memcpy(&pos, m_index + sizeof(uint64_t) * pid, sizeof(uint64_t));
+    return (pos == 0) ? nullptr : (m_data.first + pos);
+}
+
+
+size_t predicate_distance_t::row_size(const char *row) const
+{
+    if (m_format == FORMAT_RAW)
+    {
+        size_t num;
+        std::memcpy(&num, row, sizeof(size_t));
+        return sizeof(size_t) + num * (sizeof(predicate_id_t) + sizeof(float));
+    }
+
+    uint32_t num, pid_bytes;
+    std::memcpy(&num, row, sizeof(uint32_t));
+    std::memcpy(&pid_bytes, row + sizeof(uint32_t), sizeof(uint32_t));
+
+    size_t num_blocks = (num + DISTANCE_BLOCK_SIZE - 1) / DISTANCE_BLOCK_SIZE;
+    return sizeof(uint32_t) * (2 + 2 * num_blocks) + pid_bytes + num * distance_size(m_format);
+}
+
+
+float predicate_distance_t::quantization_step(const distance_matrix_t &mtx_f) const
+{
+    if (m_format == FORMAT_RAW) return 0.0f;
+
+    const float q_max = (m_format == FORMAT_Q8) ? UINT8_MAX : UINT16_MAX;
+    float max_dist(0.0f);
+    bool is_integral(true);
+
+    for (const auto &row : mtx_f)
+        for (const auto &p : row.second)
+        {
+            max_dist = std::max(max_dist, p.second);
+            is_integral = is_integral and (p.second == std::floor(p.second));
+        }
+
+    // A DISTANCE IS THE SUM OF DISTANCES OF AT MOST (max_depth() + 1) RULES.
+    float bound(-1.0f);
+    if (max_depth() >= 0)
+        bound = max_dist * (max_depth() + 1);
+    if (max_distance() >= 0.0f and (bound < 0.0f or max_distance() < bound))
+        bound = max_distance();
+
+    // INTEGRAL DISTANCES ARE QUANTIZED AS THEY ARE, SO THAT THEY ARE EXACT UNLESS THEY EXCEED q_max.
+    if (is_integral and bound <= q_max)
+        return 1.0f;
+
+    if (bound < 0.0f)
+        throw exception_t("Quantized distances need max-depth or max-distance. Use --distance-format=raw.");
+
+    return bound / q_max;
 }
 
 
@@ -381,6 +943,343 @@ void predicate_distance_t::matrix_writer_t::write(
 }
 
 
+
+namespace
+{
+/** The component of predicates which have no distance, such as equality. */
+const uint32_t NO_COMPONENT = static_cast<uint32_t>(-1);
+}
+
+
+landmark_distance_t::landmark_distance_t(const filepath_t &p, const string_t &df_key)
+    : heuristic_t(p), m_df_key(df_key), m_selection(param()->get("landmark-selection", "farthest")),
+      m_dist(predicate_distance_t::distance_function(df_key)),
+      m_num_landmarks(param()->geti("landmarks", 16)), m_num_predicates(0),
+      m_components(nullptr), m_distances(nullptr)
+{
+    if (m_selection != "farthest" and m_selection != "degree")
+        throw exception_t(format("Invalid selection of landmarks: \"%s\"", m_selection.c_str()));
+
+    if (m_num_landmarks == 0)
+        throw exception_t("The number of landmarks must be positive.");
+}
+
+
+void landmark_distance_t::compile()
+{
+    assert(kb()->is_readable());
+
+    m_fin.reset();
+    m_data = std::make_pair(nullptr, 0);
+
+    const size_t num_preds = plib()->predicates().size();
+
+    adjacency_list_t adj;
+    LOG_ROUGH("making adjacency list ...");
+    make_adjacency_list(&adj);
+
+    // CONNECTED COMPONENTS, BETWEEN WHICH PREDICATES ARE NEVER REACHABLE.
+    std::vector<uint32_t> comps(num_preds, NO_COMPONENT);
+    uint32_t num_comps(0);
+
+    for (predicate_id_t pid = 0; pid < num_preds; ++pid)
+    {
+        if (comps[pid] != NO_COMPONENT) continue;
+
+        std::deque<predicate_id_t> queue{ pid };
+        comps[pid] = num_comps;
+
+        while (not queue.empty())
+        {
+            predicate_id_t p1 = queue.front();
+            queue.pop_front();
+
+            for (const auto &e : adj[p1])
+            {
+                if (comps[e.first] == NO_COMPONENT)
+                {
+                    comps[e.first] = num_comps;
+                    queue.push_back(e.first);
+                }
+            }
+        }
+        ++num_comps;
+    }
+
+    // EQUALITY IS ON PATHS BETWEEN PREDICATES, BUT HAS NO DISTANCE ITSELF AS IN predicate_distance_t.
+    for (const auto &pred : plib()->predicates())
+        if (not pred.good() or pred.is_equality())
+            comps[pred.pid()] = NO_COMPONENT;
+
+    LOG_ROUGH("selecting landmarks ...");
+    std::vector<predicate_id_t> landmarks;
+    std::vector<std::vector<float>> dists;
+    select_landmarks(adj, comps, &landmarks, &dists);
+
+    LOG_ROUGH(format("selected %d landmarks from %d components.", landmarks.size(), num_comps));
+
+    LOG_ROUGH("writing distances from landmarks ...");
+    {
+        std::ofstream fo(m_filepath.c_str(), std::ios::binary | std::ios::out);
+        uint64_t n = landmarks.size(), p = num_preds;
+
+        if (fo.fail())
+            throw exception_t(format("kb::landmark_distance_t cannot open \"%s\"", m_filepath.c_str()));
+
+        fo.write((const char*)&n, sizeof(uint64_t));
+        fo.write((const char*)&p, sizeof(uint64_t));
+        fo.write((const char*)landmarks.data(), sizeof(predicate_id_t) * landmarks.size());
+        fo.write((const char*)comps.data(), sizeof(uint32_t) * comps.size());
+
+        // DISTANCES OF EACH PREDICATE ARE CONTIGUOUS, SO THAT get() READS THEM AT ONCE.
+        std::vector<float> row(landmarks.size());
+        for (predicate_id_t pid = 0; pid < num_preds; ++pid)
+        {
+            for (size_t i = 0; i < landmarks.size(); ++i)
+                row[i] = dists[i][pid];
+            fo.write((const char*)row.data(), sizeof(float) * row.size());
+        }
+
+        if (fo.fail())
+            throw exception_t(format("kb::landmark_distance_t failed to write \"%s\"", m_filepath.c_str()));
+    }
+
+    LOG_ROUGH("finished.");
+}
+
+
+void landmark_distance_t::load()
+{
+    if (m_data.first == nullptr)
+    {
+        m_fin.reset(new mapped_file_t(m_filepath, false));
+        m_data = std::make_pair(m_fin->data(), m_fin->size());
+    }
+
+    auto fail = [this]()
+    {
+        throw exception_t(format("kb::landmark_distance_t cannot read \"%s\"", m_filepath.c_str()));
+    };
+
+    uint64_t n, p;
+
+    if (m_data.second < sizeof(uint64_t) * 2) fail();
+    std::memcpy(&n, m_data.first, sizeof(uint64_t));
+    std::memcpy(&p, m_data.first + sizeof(uint64_t), sizeof(uint64_t));
+
+    size_t pos_comps = sizeof(uint64_t) * 2 + sizeof(predicate_id_t) * n;
+    size_t pos_dists = pos_comps + sizeof(uint32_t) * p;
+
+    if (n > m_data.second or p > m_data.second or pos_dists + sizeof(float) * n * p != m_data.second)
+        fail();
+
+    m_num_landmarks = n;
+    m_num_predicates = p;
+    m_components = m_data.first + pos_comps;
+    m_distances = m_data.first + pos_dists;
+}
+
+
+float landmark_distance_t::get(predicate_id_t pid1, predicate_id_t pid2) const
+{
+    assert(is_readable());
+
+    if (pid1 >= m_num_predicates or pid2 >= m_num_predicates) return -1.0f;
+
+    uint32_t c1, c2;
+    std::memcpy(&c1, m_components + sizeof(uint32_t) * pid1, sizeof(uint32_t));
+    std::memcpy(&c2, m_components + sizeof(uint32_t) * pid2, sizeof(uint32_t));
+
+    if (c1 == NO_COMPONENT or c1 != c2) return -1.0f;
+    if (pid1 == pid2) return 0.0f;
+
+    // THE MEMORY IS READ-ONLY, SO THAT NO LOCK IS NEEDED.
+    const char *row1 = m_distances + sizeof(float) * m_num_landmarks * pid1;
+    const char *row2 = m_distances + sizeof(float) * m_num_landmarks * pid2;
+    float out(0.0f), d1, d2;
+
+    for (size_t i = 0; i < m_num_landmarks; ++i)
+    {
+        std::memcpy(&d1, row1 + sizeof(float) * i, sizeof(float));
+        std::memcpy(&d2, row2 + sizeof(float) * i, sizeof(float));
+
+        // LANDMARKS IN OTHER COMPONENTS GIVE NO BOUND.
+        if (d1 >= 0.0f and d2 >= 0.0f)
+            out = std::max(out, std::abs(d1 - d2));
+    }
+
+    return out;
+}
+
+
+void landmark_distance_t::write_json(json::object_writer_t &wr) const
+{
+    wr.write_field<string_t>("name", "landmark-distance");
+    wr.write_field<string_t>("distance-function", m_df_key);
+    wr.write_field<string_t>("landmark-selection", m_selection);
+    wr.write_field<int>("landmarks", static_cast<int>(m_num_landmarks));
+}
+
+
+void landmark_distance_t::make_adjacency_list(adjacency_list_t *out) const
+{
+    const size_t num_preds = plib()->predicates().size();
+    std::vector<std::unordered_map<predicate_id_t, float>> adj(num_preds);
+    progress_bar_t prog(0, kb()->rules.size(), verboseness_e::MIDDLE);
+
+    auto conj2pids = [](const conjunction_t &conj) -> std::unordered_set<predicate_id_t>
+    {
+        std::unordered_set<predicate_id_t> out;
+        for (const auto &a : conj)
+            out.insert(a.pid());
+        return out;
+    };
+
+    for (rule_id_t rid = 1; rid <= static_cast<rule_id_t>(kb()->rules.size()); ++rid)
+    {
+        rule_t r = kb()->rules.get(rid);
+        if (r.rhs().empty()) continue;
+
+        float dist = m_dist(rid);
+        if (dist < 0.0f) continue;
+
+        std::unordered_set<predicate_id_t> &&lpids = conj2pids(r.lhs());
+        std::unordered_set<predicate_id_t> &&rpids = conj2pids(r.rhs());
+
+        for (const auto &p1 : lpids)
+            for (const auto &p2 : rpids)
+            {
+                if (p1 == p2) continue;
+                update_min(adj[p1], p2, dist);
+                update_min(adj[p2], p1, dist);
+            }
+
+        prog.set(rid);
+    }
+
+    // EDGES ARE SORTED, SO THAT THE RESULT DOES NOT DEPEND ON THE ORDER OF HASHING.
+    out->assign(num_preds, std::vector<std::pair<predicate_id_t, float>>());
+    for (predicate_id_t pid = 0; pid < num_preds; ++pid)
+    {
+        (*out)[pid].assign(adj[pid].begin(), adj[pid].end());
+        std::sort((*out)[pid].begin(), (*out)[pid].end());
+    }
+}
+
+
+void landmark_distance_t::make_distances(
+    predicate_id_t pid, const adjacency_list_t &adj, std::vector<float> *out) const
+{
+    typedef std::pair<float, predicate_id_t> item_t;
+    std::priority_queue<item_t, std::vector<item_t>, std::greater<item_t>> heap;
+
+    out->assign(adj.size(), -1.0f);
+    (*out)[pid] = 0.0f;
+    heap.push(item_t(0.0f, pid));
+
+    while (not heap.empty())
+    {
+        item_t top = heap.top();
+        heap.pop();
+
+        if (top.first > (*out)[top.second]) continue;
+
+        for (const auto &e : adj[top.second])
+        {
+            float dist = top.first + e.second;
+            float &d = (*out)[e.first];
+
+            if (d < 0.0f or dist < d)
+            {
+                d = dist;
+                heap.push(item_t(dist, e.first));
+            }
+        }
+    }
+}
+
+
+void landmark_distance_t::select_landmarks(
+    const adjacency_list_t &adj, const std::vector<uint32_t> &comps,
+    std::vector<predicate_id_t> *landmarks, std::vector<std::vector<float>> *dists) const
+{
+    const size_t num_preds = adj.size();
+
+    // PREDICATES NOT IN ANY RULE NEED NO LANDMARK, SINCE THEY REACH NOTHING.
+    std::vector<predicate_id_t> cands;
+    std::unordered_map<uint32_t, size_t> comp2size;
+
+    for (predicate_id_t pid = 0; pid < num_preds; ++pid)
+    {
+        if (comps[pid] == NO_COMPONENT or adj[pid].empty()) continue;
+        cands.push_back(pid);
+        ++comp2size[comps[pid]];
+    }
+
+    auto add = [&](predicate_id_t pid)
+    {
+        landmarks->push_back(pid);
+        dists->push_back(std::vector<float>());
+        make_distances(pid, adj, &dists->back());
+    };
+
+    if (m_selection == "degree")
+    {
+        std::stable_sort(cands.begin(), cands.end(), [&adj](predicate_id_t p1, predicate_id_t p2)
+        {
+            return adj[p1].size() > adj[p2].size();
+        });
+
+        for (size_t i = 0; i < cands.size() and i < m_num_landmarks; ++i)
+            add(cands[i]);
+    }
+    else
+    {
+        std::vector<float> min_dists(num_preds, -1.0f); // -1 MEANS NO LANDMARK IN THE COMPONENT.
+        std::unordered_set<predicate_id_t> selected;
+
+        while (landmarks->size() < m_num_landmarks)
+        {
+            // A PREDICATE IN THE LARGEST COMPONENT WITHOUT LANDMARKS COMES FIRST,
+            // AND THEN THE FARTHEST ONE FROM LANDMARKS. TIES ARE BROKEN BY DEGREE.
+            typedef std::tuple<bool, float, size_t> key_t;
+            predicate_id_t best(PID_INVALID);
+            key_t best_key(false, -1.0f, 0);
+
+            for (auto pid : cands)
+            {
+                if (selected.count(pid) > 0) continue;
+
+                bool uncovered = (min_dists[pid] < 0.0f);
+                key_t key(uncovered,
+                    uncovered ? static_cast<float>(comp2size.at(comps[pid])) : min_dists[pid],
+                    adj[pid].size());
+
+                if (best == PID_INVALID or key > best_key)
+                {
+                    best = pid;
+                    best_key = key;
+                }
+            }
+
+            // ALL PREDICATES COINCIDE WITH LANDMARKS.
+            if (best == PID_INVALID or (not std::get<0>(best_key) and std::get<1>(best_key) <= 0.0f))
+                break;
+
+            selected.insert(best);
+            add(best);
+
+            for (auto pid : cands)
+            {
+                float d = dists->back()[pid];
+                if (d >= 0.0f and (min_dists[pid] < 0.0f or d < min_dists[pid]))
+                    min_dists[pid] = d;
+            }
+        }
+    }
+}
+
+
 }
 
 }
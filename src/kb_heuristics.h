@@ -17,12 +17,24 @@ namespace kb
 class heuristic_t
 {
 public:
-    heuristic_t(const filepath_t &p) : m_filepath(p) {}
+    heuristic_t(const filepath_t &p) : m_filepath(p), m_data(nullptr, 0) {}
     virtual ~heuristic_t() {}
 
     virtual void compile() = 0;
     virtual void load() = 0;
 
+    /**
+    * @brief Updates the compiled heuristic for rules appended to KB, whose IDs are `begin` or larger.
+    * @details On default, the heuristic is compiled from scratch.
+    */
+    virtual void update(rule_id_t /*begin*/);
+
+    /**
+    * @brief Makes load() read the compiled heuristic on given memory instead of the file.
+    * @details The memory, such as a section of a mapped image, must outlive this.
+    */
+    void assign(const char *data, size_t size) { m_data = std::make_pair(data, size); }
+
     /** Returns distance between given predicates. */
     virtual float get(predicate_id_t, predicate_id_t) const = 0;
 
@@ -35,6 +47,7 @@ public:
 
 protected:
     filepath_t m_filepath;
+    std::pair<const char*, size_t> m_data; /// The compiled heuristic on memory, or nullptr.
 };
 
 
@@ -78,11 +91,25 @@ public:
     typedef std::unordered_map<predicate_id_t, std::unordered_map<predicate_id_t, float>> distance_matrix_t;
     typedef std::function<float(rule_id_t)> distance_function_t;
 
+    /** Formats of the file of distances, which is given by the option `distance-format`. */
+    enum format_e : uint32_t
+    {
+        FORMAT_RAW = 0, /// Each entry is a pair of a predicate-ID and a float.
+        FORMAT_Q8 = 1,  /// Predicate-IDs are delta-encoded, and distances are quantized into 8 bits.
+        FORMAT_Q16 = 2  /// Predicate-IDs are delta-encoded, and distances are quantized into 16 bits.
+    };
+
     predicate_distance_t(const filepath_t &p, const string_t &df_key);
 
+    /** Returns the function which gives the distance of each rule, such as "const". */
+    static distance_function_t distance_function(const string_t &key);
+
     virtual void compile() override;
     virtual void load() override;
 
+    /** Recomputes only the rows of predicates from which some predicate in the new rules is reachable. */
+    virtual void update(rule_id_t begin) override;
+
     virtual float get(predicate_id_t, predicate_id_t) const override;
     virtual float get(rule_id_t r) const override { return m_dist(r); }
 
@@ -90,13 +117,12 @@ public:
 
     float max_distance() const { return m_max_distance; }
     int max_depth() const { return m_max_depth; }
+    format_e distance_format() const { return m_format; }
 
-    bool is_readable() const { return (bool)m_fin; }
+    bool is_readable() const { return m_data.first != nullptr; }
     bool is_writable() const { return (bool)m_fout; }
 
 private:
-    static std::function<float(rule_id_t)> distance_function(const string_t &key);
-
     /** Computes the adjacency matrix of predicates in the KB. */
     void make_adjacency_matrix(
         distance_matrix_t *mtx_forward, distance_matrix_t *mtx_backward) const;
@@ -107,7 +133,34 @@ private:
         const distance_matrix_t &adj_f, const distance_matrix_t &adj_b,
         std::unordered_map<predicate_id_t, float> *pid2dist) const;
 
-    void write(predicate_id_t, const std::unordered_map<predicate_id_t, float>&);
+    /**
+    * @brief Returns predicates from which some of `pids` can be reachable in make_distance_matrix().
+    * @details The result may have extra predicates, since it is bounded by the depth and the distance separately.
+    */
+    std::unordered_set<predicate_id_t> reachable_to(
+        const std::unordered_set<predicate_id_t> &pids,
+        const distance_matrix_t &adj_f, const distance_matrix_t &adj_b) const;
+
+    /**
+    * @brief Returns the distance per unit of quantized distances.
+    * @details Integral distances are quantized as they are, and others are rounded down over their upper bound.
+    */
+    float quantization_step(const distance_matrix_t &mtx_f) const;
+
+    /** Returns the row of given predicate in the data, or nullptr. */
+    const char* row(predicate_id_t pid) const;
+
+    /** Returns the size in bytes of given row in the data. */
+    size_t row_size(const char *row) const;
+
+    /** Writes the header of the file, which begins writing the file. */
+    void write_header();
+
+    /** Writes the row of given predicate, and returns the maximum under-estimate of distances by quantization. */
+    float write(predicate_id_t, const std::unordered_map<predicate_id_t, float>&);
+
+    /** Writes the index of rows and its position, which ends writing the file. */
+    void write_index();
 
     typedef unsigned long long pos_t;
     static std::mutex ms_mutex;
@@ -118,9 +171,72 @@ private:
     float m_max_distance;
     int m_max_depth;
 
+    const format_e m_out_format; /// The format in which distances are written.
+    format_e m_format; /// The format of the data being read or written.
+    float m_step;      /// The distance per unit of quantized distances.
+
     std::unique_ptr<std::ofstream> m_fout;
-    std::unique_ptr<std::ifstream> m_fin;
-    std::unordered_map<predicate_id_t, pos_t> m_pid2pos;
+    std::unique_ptr<mapped_file_t> m_fin; /// The file mapped onto m_data, unless assign() is called.
+    std::unordered_map<predicate_id_t, pos_t> m_pid2pos; /// Positions of rows written, or read in the raw format.
+
+    const char *m_index;  /// Positions of rows indexed by predicate-IDs in the compressed data.
+    size_t m_num_indexed; /// The number of elements of m_index.
+};
+
+
+/**
+* @brief Class of heuristics which bounds distance between predicates with distances from landmarks.
+* @details
+*   Distances from a few landmark predicates to all predicates are computed in advance,
+*   and distance between two predicates is estimated from them by the triangle inequality in O(#landmarks).
+*   Distances are taken on the graph whose edges link predicates in both sides of each rule,
+*   so that the estimate is a lower bound of the distance given by predicate_distance_t.
+*/
+class landmark_distance_t : public heuristic_t
+{
+public:
+    landmark_distance_t(const filepath_t &p, const string_t &df_key);
+
+    virtual void compile() override;
+    virtual void load() override;
+
+    virtual float get(predicate_id_t, predicate_id_t) const override;
+    virtual float get(rule_id_t r) const override { return m_dist(r); }
+
+    virtual void write_json(json::object_writer_t&) const override;
+
+    size_t num_landmarks() const { return m_num_landmarks; }
+    bool is_readable() const { return m_data.first != nullptr; }
+
+private:
+    typedef std::vector<std::vector<std::pair<predicate_id_t, float>>> adjacency_list_t;
+
+    /** Computes the adjacency list of predicates, in which each rule links predicates in its LHS and RHS. */
+    void make_adjacency_list(adjacency_list_t *out) const;
+
+    /** Computes distances from given predicate to all predicates, which are -1 for unreachable ones. */
+    void make_distances(predicate_id_t pid, const adjacency_list_t &adj, std::vector<float> *out) const;
+
+    /**
+    * @brief Chooses landmarks and computes distances from them.
+    * @details
+    *   With the selection "farthest", each landmark is the predicate farthest from the landmarks chosen before,
+    *   where components without landmarks come first. With "degree", predicates in the most rules are chosen.
+    */
+    void select_landmarks(
+        const adjacency_list_t &adj, const std::vector<uint32_t> &comps,
+        std::vector<predicate_id_t> *landmarks, std::vector<std::vector<float>> *dists) const;
+
+    const string_t m_df_key;
+    const string_t m_selection;
+    predicate_distance_t::distance_function_t m_dist;
+
+    size_t m_num_landmarks;
+    size_t m_num_predicates;
+    const char *m_components; /// Components of predicates in m_data, whose elements are uint32_t.
+    const char *m_distances;  /// Distances from landmarks to each predicate in m_data, whose elements are float.
+
+    std::unique_ptr<mapped_file_t> m_fin; /// The file mapped onto m_data, unless assign() is called.
 };
 
 }
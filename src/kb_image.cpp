@@ -0,0 +1,165 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "./kb.h"
+
+
+namespace dav
+{
+
+namespace kb
+{
+
+
+namespace
+{
+const char IMAGE_MAGIC[8] = { 'D', 'A', 'V', 'I', 'D', 'K', 'B', 'I' };
+const uint32_t IMAGE_FORMAT_VERSION = 1;
+
+/** Sections are aligned to this, which is the size of pages on most platforms. */
+const uint64_t IMAGE_ALIGNMENT = 4096;
+
+const size_t MAX_SECTION_NAME = 32;
+
+
+struct image_header_t
+{
+    char magic[8];
+    uint32_t format_version;
+    uint32_t kb_version;
+    uint64_t num_sections;
+    uint64_t alignment;
+};
+
+
+struct image_entry_t
+{
+    char name[MAX_SECTION_NAME]; /// Null-terminated name of the section.
+    uint64_t offset;
+    uint64_t size;
+};
+
+
+uint64_t align(uint64_t pos)
+{
+    return (pos + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT * IMAGE_ALIGNMENT;
+}
+}
+
+
+void image_t::write(
+    const filepath_t &path,
+    const std::vector<std::pair<std::string, filepath_t>> &files, version_e version)
+{
+    std::vector<std::unique_ptr<mapped_file_t>> contents;
+    std::vector<image_entry_t> entries(files.size());
+
+    image_header_t header;
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.format_version = IMAGE_FORMAT_VERSION;
+    header.kb_version = static_cast<uint32_t>(version);
+    header.num_sections = files.size();
+    header.alignment = IMAGE_ALIGNMENT;
+
+    uint64_t pos = sizeof(image_header_t) + sizeof(image_entry_t) * files.size();
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const auto &name = files.at(i).first;
+
+        if (name.size() >= MAX_SECTION_NAME)
+            throw exception_t(format("kb::image_t: too long name of section \"%s\"", name.c_str()));
+
+        contents.emplace_back(new mapped_file_t(files.at(i).second));
+
+        auto &e = entries.at(i);
+        std::memset(e.name, 0, MAX_SECTION_NAME);
+        std::memcpy(e.name, name.c_str(), name.size());
+        e.offset = pos = align(pos);
+        e.size = contents.back()->size();
+        pos += e.size;
+    }
+
+    // THE IMAGE IS RENAMED AFTER WRITTEN, SO THAT A BROKEN IMAGE IS NEVER LEFT.
+    filepath_t tmp = path + ".tmp";
+    {
+        std::ofstream fo(tmp.c_str(), std::ios::binary | std::ios::trunc);
+
+        if (fo.fail())
+            throw exception_t(format("kb::image_t cannot open \"%s\"", tmp.c_str()));
+
+        fo.write((const char*)&header, sizeof(image_header_t));
+        fo.write((const char*)entries.data(), sizeof(image_entry_t) * entries.size());
+
+        const std::vector<char> padding(IMAGE_ALIGNMENT, '\0');
+        uint64_t written = sizeof(image_header_t) + sizeof(image_entry_t) * entries.size();
+
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            fo.write(padding.data(), entries.at(i).offset - written);
+            fo.write(contents.at(i)->data(), entries.at(i).size);
+            written = entries.at(i).offset + entries.at(i).size;
+        }
+        fo.write(padding.data(), align(written) - written);
+
+        if (fo.fail())
+            throw exception_t(format("kb::image_t failed to write \"%s\"", tmp.c_str()));
+    }
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        throw exception_t(format("kb::image_t cannot rename \"%s\"", tmp.c_str()));
+}
+
+
+image_t::image_t(const filepath_t &path)
+    : m_path(path), m_file(path, false), m_version(KB_VERSION_UNSPECIFIED)
+{
+    auto fail = [&](const char *reason)
+    {
+        throw exception_t(format(
+            "kb::image_t cannot read \"%s\" (%s). Please re-compile KB.", path.c_str(), reason));
+    };
+
+    if (m_file.size() < sizeof(image_header_t))
+        fail("too small");
+
+    image_header_t header;
+    std::memcpy(&header, m_file.data(), sizeof(image_header_t));
+
+    if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0)
+        fail("not an image of KB");
+    if (header.format_version != IMAGE_FORMAT_VERSION)
+        fail("unsupported format");
+
+    uint64_t table_end = sizeof(image_header_t) + sizeof(image_entry_t) * header.num_sections;
+
+    if (header.num_sections > m_file.size() / sizeof(image_entry_t) or table_end > m_file.size())
+        fail("broken table of sections");
+
+    m_version = static_cast<version_e>(header.kb_version);
+
+    for (uint64_t i = 0; i < header.num_sections; ++i)
+    {
+        image_entry_t e;
+        std::memcpy(&e, m_file.data() + sizeof(image_header_t) + sizeof(image_entry_t) * i, sizeof(image_entry_t));
+
+        if (e.name[MAX_SECTION_NAME - 1] != '\0' or e.offset < table_end or
+            e.offset > m_file.size() or e.size > m_file.size() - e.offset)
+            fail("broken table of sections");
+
+        m_sections[std::string(e.name)] = section_t(m_file.data() + e.offset, e.size);
+    }
+}
+
+
+image_t::section_t image_t::section(const std::string &name) const
+{
+    auto it = m_sections.find(name);
+    return (it != m_sections.end()) ? it->second : section_t(nullptr, 0);
+}
+
+
+}
+
+}
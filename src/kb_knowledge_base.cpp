@@ -1,6 +1,7 @@
 /* -*- coding: utf-8 -*- */
 
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <climits>
 #include <algorithm>
@@ -21,6 +22,106 @@ namespace kb
 
 
 const int BUFFER_SIZE = 512 * 512;
+
+
+void rule_indices_t::insert(const rule_t &r)
+{
+	for (auto backward : { false, true })
+	{
+		feature_t f(r.evidence(backward).feature(), backward);
+
+		if (not f.first.empty())
+			m_features.push_back(std::make_pair(f, r.rid()));
+	}
+
+	for (const auto &a : r.lhs())
+		m_lhs.push_back(std::make_pair(a.pid(), r.rid()));
+	for (const auto &a : r.rhs())
+		m_rhs.push_back(std::make_pair(a.pid(), r.rid()));
+
+	auto cls = r.classname();
+	if (not cls.empty())
+		m_classes.push_back(std::make_pair(cls, r.rid()));
+}
+
+
+void rule_indices_t::merge_into(segment_t *seg) const
+{
+	for (const auto &p : m_features)
+	{
+		seg->features.insert(p.first);
+		seg->feat2rids.insert(p.first, p.second);
+	}
+
+	for (const auto &p : m_lhs)
+		seg->lhs2rids.insert(p.first, p.second);
+	for (const auto &p : m_rhs)
+		seg->rhs2rids.insert(p.first, p.second);
+	for (const auto &p : m_classes)
+		seg->class2rids.insert(p.first, p.second);
+}
+
+
+segment_t::segment_t(const filepath_t &prefix)
+    : rules(prefix + ".base"),
+      features(prefix + ".ft1.cdb"),
+      feat2rids(prefix + ".ft2.cdb"),
+      lhs2rids(prefix + ".lhs.cdb"),
+      rhs2rids(prefix + ".rhs.cdb"),
+      class2rids(prefix + ".cls.cdb")
+{}
+
+
+void segment_t::prepare_compile()
+{
+    rules.prepare_compile();
+    for (auto *cdb : indices())
+        cdb->prepare_compile();
+}
+
+
+void segment_t::prepare_query()
+{
+    rules.prepare_query();
+    for (auto *cdb : indices())
+        cdb->prepare_query();
+}
+
+
+void segment_t::finalize()
+{
+    rules.finalize();
+    for (auto *cdb : indices())
+        cdb->finalize();
+}
+
+
+void segment_t::add_delta(const segment_t &delta)
+{
+    rules.add_delta(&delta.rules);
+    features.add_delta(&delta.features);
+    feat2rids.add_delta(&delta.feat2rids);
+    lhs2rids.add_delta(&delta.lhs2rids);
+    rhs2rids.add_delta(&delta.rhs2rids);
+    class2rids.add_delta(&delta.class2rids);
+}
+
+
+std::vector<cdb_data_t*> segment_t::indices()
+{
+    return std::vector<cdb_data_t*>{ &features, &feat2rids, &lhs2rids, &rhs2rids, &class2rids };
+}
+
+
+std::vector<filepath_t> segment_t::files() const
+{
+    return std::vector<filepath_t>{
+        rules.filepath_idx(), rules.filepath_dat(),
+        features.filename(), feat2rids.filename(),
+        lhs2rids.filename(), rhs2rids.filename(), class2rids.filename() };
+}
+
+
 std::unique_ptr<knowledge_base_t, deleter_t<knowledge_base_t>> knowledge_base_t::ms_instance;
 
 
@@ -43,13 +144,8 @@ void knowledge_base_t::initialize(const filepath_t &path)
 
 
 knowledge_base_t::knowledge_base_t(const filepath_t &path)
-    : m_state(STATE_NULL), m_version(KB_VERSION_2),	m_path(path),
-	rules(path + ".base"),
-	features(path + ".ft1.cdb"),
-	feat2rids(path + ".ft2.cdb"),
-	lhs2rids(path + ".lhs.cdb"),
-	rhs2rids(path + ".rhs.cdb"),
-	class2rids(path + ".cls.cdb")
+    : segment_t(path), m_state(STATE_NULL), m_version(KB_VERSION_2), m_path(path),
+      m_num_deltas(0), m_num_unnamed_rules(0), m_target(this), m_appended_from(0)
 {}
 
 
@@ -73,19 +169,134 @@ void knowledge_base_t::prepare_compile()
             console()->print("preparing to compile KB ...");
             console()->add_indent();
         }
-        
-        rules.prepare_compile();
-        features.prepare_compile();
-        feat2rids.prepare_compile();
-        lhs2rids.prepare_compile();
-        rhs2rids.prepare_compile();
-        class2rids.prepare_compile();
+
+        remove_old_files();
+
+        m_num_deltas = 0;
+        m_target = this;
+        m_appended_from = 0;
+
+        rules.set_offset(0);
+        segment_t::prepare_compile();
 
         m_state = STATE_COMPILE;
     }
 }
 
 
+void knowledge_base_t::prepare_append()
+{
+    if (m_state != STATE_NULL)
+        finalize();
+
+    console_t::auto_indent_t ai;
+
+    if (console()->is(verboseness_e::DEBUG))
+    {
+        console()->print("preparing to append rules to KB ...");
+        console()->add_indent();
+    }
+
+    // THE NUMBER OF RULES IN KB AND ITS PREDICATES ARE READ FROM THE COMPILED KB.
+    load_predicates();
+    prepare_query(false);
+    size_t n = rules.size();
+    finalize();
+
+    // THE IMAGE DOES NOT HAVE THE NEW SEGMENT, SO THAT IT IS REMOVED UNLESS IT IS RE-WRITTEN.
+    if (filepath_image().find_file())
+    {
+        LOG_MIDDLE(format("removing the old image of KB: \"%s\"", filepath_image().c_str()));
+        std::remove(filepath_image().c_str());
+    }
+
+    ++m_num_deltas;
+    LOG_MIDDLE(format("appending rules to the delta segment: \"%s\"", filepath_delta(m_num_deltas).c_str()));
+
+    m_deltas.emplace_back(new segment_t(filepath_delta(m_num_deltas)));
+    m_target = m_deltas.back().get();
+    m_target->rules.set_offset(n);
+    m_target->prepare_compile();
+
+    // NAMES OF UNNAMED RULES FOLLOW THOSE IN THE PRECEDING SEGMENTS, SO THAT THEY ARE UNIQUE.
+    m_target->rules.set_num_unnamed_rules(m_num_unnamed_rules);
+
+    m_appended_from = static_cast<rule_id_t>(n + 1);
+    m_state = STATE_COMPILE;
+}
+
+
+void knowledge_base_t::compact()
+{
+    console_t::auto_indent_t ai;
+
+    if (console()->is(verboseness_e::ROUGH))
+    {
+        console()->print_fmt("compacting KB: \"%s\"", m_path.c_str());
+        console()->add_indent();
+    }
+
+    load_predicates();
+    prepare_query(false);
+
+    if (m_num_deltas == 0)
+    {
+        LOG_ROUGH("KB has no delta segment.");
+        finalize();
+        return;
+    }
+
+    size_t n = rules.size();
+    segment_t tmp(m_path + ".compacting");
+    {
+        progress_bar_t progress(0, static_cast<int>(n), verboseness_e::ROUGH);
+
+        tmp.prepare_compile();
+
+        // RULES ARE COPIED IN THE ORDER OF IDS, SO THAT THEY KEEP THEIR IDS.
+        for (rule_id_t rid = 1; rid <= n; ++rid)
+        {
+            rule_t r = rules.get(rid);
+            tmp.rules.add(r);
+
+            rule_indices_t idx;
+            idx.insert(r);
+            idx.merge_into(&tmp);
+
+            progress.set(static_cast<int>(rid));
+        }
+
+        tmp.finalize();
+    }
+
+    std::vector<filepath_t> deltas;
+    for (const auto &d : m_deltas)
+        for (const auto &f : d->files())
+            deltas.push_back(f);
+
+    finalize();
+
+    auto from = tmp.files(), to = files();
+    for (size_t i = 0; i < from.size(); ++i)
+    {
+        if (std::rename(from.at(i).c_str(), to.at(i).c_str()) != 0)
+            throw exception_t(format("kb::knowledge_base_t cannot rename \"%s\"", from.at(i).c_str()));
+    }
+
+    for (const auto &f : deltas)
+        std::remove(f.c_str());
+
+    m_num_deltas = 0;
+    write_spec(m_path + ".spec.txt", n);
+
+    m_image.reset();
+    if (param()->has("kb-image"))
+        write_image();
+    else if (filepath_image().find_file())
+        std::remove(filepath_image().c_str());
+}
+
+
 void knowledge_base_t::prepare_query(bool do_prepare_heuristic)
 {
     if (m_state == STATE_COMPILE)
@@ -101,21 +312,74 @@ void knowledge_base_t::prepare_query(bool do_prepare_heuristic)
             console()->add_indent();
         }
 
-        read_spec(m_path + ".spec.txt");
+        map_image();
+
+        if (m_image)
+        {
+            auto spec = section(m_path + ".spec.txt");
+            std::istringstream fi(std::string(spec.first, spec.second));
+            read_spec(&fi);
+        }
+        else
+        {
+            filepath_t path = m_path + ".spec.txt";
+            std::ifstream fi(path);
+
+            if (fi.fail())
+                throw exception_t(format("kb::knowledge_base_t cannot open \"%s\")", path.c_str()));
+
+            read_spec(&fi);
+        }
 
         if (not is_valid_version())
             throw exception_t("Invalid KB-version. Please re-compile it.");
 
-        rules.prepare_query();
-        features.prepare_query();
-        feat2rids.prepare_query();
-        lhs2rids.prepare_query();
-        rhs2rids.prepare_query();
-        class2rids.prepare_query();
+        std::vector<segment_t*> segments{ this };
+
+        m_deltas.clear();
+        for (size_t i = 1; i <= m_num_deltas; ++i)
+        {
+            m_deltas.emplace_back(new segment_t(filepath_delta(i)));
+            segments.push_back(m_deltas.back().get());
+        }
+
+        // RULE-IDS IN EACH SEGMENT FOLLOW THOSE IN THE PRECEDING SEGMENTS.
+        size_t offset(0);
+
+        for (auto *seg : segments)
+        {
+            // WITH THE IMAGE, ALL COMPONENTS READ THEIR SECTIONS ON THE MEMORY MAPPED.
+            if (m_image)
+            {
+                auto idx = section(seg->rules.filepath_idx());
+                auto dat = section(seg->rules.filepath_dat());
+                seg->rules.assign(idx.first, idx.second, dat.first, dat.second);
+
+                for (cdb_data_t *cdb : seg->indices())
+                {
+                    auto s = section(cdb->filename());
+                    cdb->assign(s.first, s.second);
+                }
+            }
+
+            seg->rules.set_offset(offset);
+            seg->prepare_query();
+            offset = seg->rules.size();
+        }
+
+        for (const auto &d : m_deltas)
+            add_delta(*d);
 
         if (do_prepare_heuristic)
         {
             initialize_heuristic();
+
+            if (m_image and not heuristic->filepath().empty())
+            {
+                auto s = section(heuristic->filepath());
+                heuristic->assign(s.first, s.second);
+            }
+
             heuristic->load();
         }
 
@@ -140,15 +404,18 @@ void knowledge_base_t::finalize()
     m_state = STATE_NULL;
 
 	if (state == STATE_COMPILE)
-		write_spec(m_path + ".spec.txt");
-
-	rules.finalize();
-	features.finalize();
-	feat2rids.finalize();
-	lhs2rids.finalize();
-	rhs2rids.finalize();
-	class2rids.finalize();
+    {
+        m_num_unnamed_rules = m_target->rules.num_unnamed_rules();
+		write_spec(m_path + ".spec.txt", m_target->rules.size());
+    }
+
+    segment_t::finalize();
+    for (const auto &d : m_deltas)
+        d->finalize();
+    m_deltas.clear();
+
     heuristic.reset();
+    m_image.reset();
 
     if (state == STATE_COMPILE)
     {
@@ -164,10 +431,117 @@ void knowledge_base_t::finalize()
         prepare_query(false);
         {
             initialize_heuristic();
-            heuristic->compile();
 
+            // ON APPENDING, THE HEURISTIC IS UPDATED ONLY FOR THE NEW RULES.
+            if (m_appended_from > 0)
+                heuristic->update(m_appended_from);
+            else
+                heuristic->compile();
         }
         finalize();
+
+        m_target = this;
+        m_appended_from = 0;
+
+        if (param()->has("kb-image"))
+            write_image();
+    }
+}
+
+
+void knowledge_base_t::load_predicates()
+{
+    map_image();
+
+    if (m_image)
+    {
+        auto s = section(plib()->filepath());
+        plib()->load(s.first, s.second);
+    }
+    else
+        plib()->load();
+}
+
+
+void knowledge_base_t::map_image()
+{
+    if (not m_image and filepath_image().find_file())
+    {
+        LOG_MIDDLE(format("mapping the image of KB: \"%s\"", filepath_image().c_str()));
+        m_image.reset(new image_t(filepath_image()));
+
+        if (m_image->version() != KB_VERSION_2)
+            throw exception_t("Invalid KB-version. Please re-compile it.");
+    }
+}
+
+
+image_t::section_t knowledge_base_t::section(const filepath_t &file) const
+{
+    assert(m_image);
+
+    // THE NAME OF EACH SECTION IS THE SUFFIX OF THE FILE, SUCH AS "ft1.cdb".
+    if (file.size() <= m_path.size() + 1 or file.compare(0, m_path.size(), m_path) != 0)
+        throw exception_t(format("kb::knowledge_base_t has no section for \"%s\"", file.c_str()));
+
+    auto out = m_image->section(file.substr(m_path.size() + 1));
+
+    if (out.first == nullptr)
+        throw exception_t(format(
+            "The image of KB lacks \"%s\". Please re-compile it.", file.substr(m_path.size() + 1).c_str()));
+
+    return out;
+}
+
+
+void knowledge_base_t::write_image() const
+{
+    console_t::auto_indent_t ai;
+    filepath_t path = filepath_image();
+
+    if (console()->is(verboseness_e::ROUGH))
+    {
+        console()->print_fmt("writing the image of KB: \"%s\"", path.c_str());
+        console()->add_indent();
+    }
+
+    std::vector<filepath_t> files{ m_path + ".spec.txt", plib()->filepath() };
+
+    for (const auto &f : segment_t::files())
+        files.push_back(f);
+
+    for (size_t i = 1; i <= m_num_deltas; ++i)
+        for (const auto &f : segment_t(filepath_delta(i)).files())
+            files.push_back(f);
+
+    // THE NULL HEURISTIC HAS NO FILE.
+    if (filepath_t(m_path + ".heuristic").find_file())
+        files.push_back(m_path + ".heuristic");
+
+    std::vector<std::pair<std::string, filepath_t>> sections;
+    for (const auto &f : files)
+        sections.push_back(std::make_pair(f.substr(m_path.size() + 1), f));
+
+    image_t::write(path, sections, m_version);
+}
+
+
+void knowledge_base_t::remove_old_files()
+{
+    // AN IMAGE OF THE OLD KB IS REMOVED, SO THAT IT IS NEVER READ INSTEAD OF THE NEW KB.
+    m_image.reset();
+    if (filepath_image().find_file())
+    {
+        LOG_MIDDLE(format("removing the old image of KB: \"%s\"", filepath_image().c_str()));
+        std::remove(filepath_image().c_str());
+    }
+
+    for (size_t i = 1; filepath_t(segment_t(filepath_delta(i)).rules.filepath_idx()).find_file(); ++i)
+    {
+        LOG_MIDDLE(format("removing the old delta segment of KB: \"%s\"", filepath_delta(i).c_str()));
+
+        for (const auto &f : segment_t(filepath_delta(i)).files())
+            std::remove(f.c_str());
     }
 }
 
@@ -185,45 +559,68 @@ void knowledge_base_t::add(rule_t &r)
 	{
         LOG_DETAIL(format("added rule: %s", r.string().c_str()));
 
-		rules.add(r);
-		features.insert(r);
-		feat2rids.insert(r);
-
-		for (const auto &a : r.lhs())
-			lhs2rids.insert(a.pid(), r.rid());
-		for (const auto &a : r.rhs())
-			rhs2rids.insert(a.pid(), r.rid());
+		m_target->rules.add(r);
 
-		auto cls = r.classname();
-		if (not cls.empty())
-			class2rids.insert(cls, r.rid());
+		rule_indices_t idx;
+		idx.insert(r);
+		idx.merge_into(m_target);
 	}
 	else
 		throw exception_t("Knowledge-base is not writable.");
 }
 
 
-void knowledge_base_t::write_spec(const filepath_t &path) const
+void knowledge_base_t::add(std::vector<std::list<rule_t>*> &rs, task_pool_t *pool)
+{
+	if (not is_writable())
+		throw exception_t("Knowledge-base is not writable.");
+
+	// RULE-IDS ARE ASSIGNED IN THE ORDER OF INPUTS.
+	for (auto *list : rs)
+		for (auto &r : (*list))
+		{
+			LOG_DETAIL(format("added rule: %s", r.string().c_str()));
+			m_target->rules.add(r);
+		}
+
+	std::vector<rule_indices_t> idx(rs.size());
+
+	for (size_t i = 0; i < rs.size(); ++i)
+	{
+		pool->push([&rs, &idx, i]()
+		{
+			for (const auto &r : (*rs[i]))
+				idx[i].insert(r);
+		});
+	}
+	pool->wait();
+
+	for (const auto &x : idx)
+		x.merge_into(m_target);
+}
+
+
+void knowledge_base_t::write_spec(const filepath_t &path, size_t num_rules) const
 {
 	std::ofstream fo(path);
 
 	fo << "kb-version: " << m_version << std::endl;
 	fo << "time-stamp: " << INIT_TIME.string() << std::endl;
-	fo << "num-rules: " << rules.size() << std::endl;
+	fo << "num-rules: " << num_rules << std::endl;
 	fo << "num-predicates: " << predicate_library_t::instance()->predicates().size() << std::endl;
     fo << "heuristic: " << param()->heuristic() << std::endl;
+    fo << "num-deltas: " << m_num_deltas << std::endl;
+    fo << "num-unnamed-rules: " << m_num_unnamed_rules << std::endl;
 }
 
 
-void knowledge_base_t::read_spec(const filepath_t &path)
+void knowledge_base_t::read_spec(std::istream *fi)
 {
-    std::ifstream fi(path);
     std::string line;
+    m_num_deltas = 0;
+    m_num_unnamed_rules = 0;
 
-    if (fi.fail())
-        throw exception_t(format("kb::knowledge_base_t cannot open \"%s\")", path.c_str()));
-
-    while (std::getline(fi, line))
+    while (std::getline(*fi, line))
     {
         string_t s(line);
 
@@ -241,6 +638,12 @@ void knowledge_base_t::read_spec(const filepath_t &path)
 
         if (key == "heuristic")
             param()->add("heuristic", val);
+
+        if (key == "num-deltas")
+            m_num_deltas = std::stoul(val);
+
+        if (key == "num-unnamed-rules")
+            m_num_unnamed_rules = std::stoul(val);
     }
 }
 
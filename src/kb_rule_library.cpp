@@ -11,8 +11,9 @@ std::recursive_mutex rule_library_t::ms_mutex;
 
 
 rule_library_t::rule_library_t(const filepath_t &filename)
-    : m_filename(filename),
-      m_num_rules(0), m_num_unnamed_rules(0), m_writing_pos(0)
+    : m_filename(filename), m_idx(nullptr, 0), m_dat(nullptr, 0),
+      m_assigned_idx(nullptr, 0), m_assigned_dat(nullptr, 0),
+      m_num_rules(0), m_num_unnamed_rules(0), m_offset(0), m_writing_pos(0)
 {}
 
 
@@ -48,16 +49,31 @@ void rule_library_t::prepare_query()
 
     if (not is_readable())
     {
-        auto flag = (std::ios::binary | std::ios::in);
-        m_fi_idx.reset(new std::ifstream(filepath_idx().c_str(), flag));
-        m_fi_dat.reset(new std::ifstream(filepath_dat().c_str(), flag));
-
-        m_fi_idx->seekg(-static_cast<int>(sizeof(size_t)), std::ios_base::end);
-        m_fi_idx->read((char*)&m_num_rules, sizeof(size_t));
-        m_fi_idx->clear();
+        // RULES ARE READ DIRECTLY FROM THE FILES MAPPED ONTO MEMORY.
+        if (m_assigned_idx.first != nullptr)
+        {
+            m_idx = m_assigned_idx;
+            m_dat = m_assigned_dat;
+        }
+        else
+        {
+            m_fi_idx.reset(new mapped_file_t(filepath_idx(), false));
+            m_fi_dat.reset(new mapped_file_t(filepath_dat(), false));
+            m_idx = std::make_pair(m_fi_idx->data(), m_fi_idx->size());
+            m_dat = std::make_pair(m_fi_dat->data(), m_fi_dat->size());
+        }
+
+        if (m_idx.first == nullptr or m_idx.second < sizeof(size_t))
+            throw exception_t(format("rule_library_t cannot read \"%s\"", filepath_idx().c_str()));
+
+        std::memcpy(&m_num_rules, m_idx.first + m_idx.second - sizeof(size_t), sizeof(size_t));
 
         if (not param()->has("disable-kb-cache"))
+        {
             m_cache.reset(new std::unordered_map<rule_id_t, rule_t>());
+            for (auto &s : m_sides)
+                s.reset(new std::unordered_map<rule_id_t, std::shared_ptr<const rule_side_t>>());
+        }
 
         m_tmp_rules.clear();
     }
@@ -75,6 +91,15 @@ void rule_library_t::finalize()
 
     m_fi_idx.reset();
     m_fi_dat.reset();
+    m_idx = m_dat = m_assigned_idx = m_assigned_dat = std::make_pair(nullptr, 0);
+    m_deltas.clear();
+}
+
+
+void rule_library_t::assign(const char *idx, size_t idx_size, const char *dat, size_t dat_size)
+{
+    m_assigned_idx = std::make_pair(idx, idx_size);
+    m_assigned_dat = std::make_pair(dat, dat_size);
 }
 
 
@@ -110,6 +135,7 @@ rule_id_t rule_library_t::add(rule_t &r)
 
 rule_t rule_library_t::get(rule_id_t rid) const
 {
+    tracer_t::span_t span("kb-rule");
     std::lock_guard<std::recursive_mutex> lock(ms_mutex);
 
     if (not is_readable())
@@ -137,27 +163,59 @@ rule_t rule_library_t::get(rule_id_t rid) const
         return out;
     }
 
+    // FINDS THE SEGMENT WHICH HAS THE RULE.
+    const rule_library_t *seg = this;
+    for (const auto *d : m_deltas)
+        if (rid > d->m_offset)
+            seg = d;
+
+    rule_t out = seg->read(rid);
+
+    if (m_cache)
+        m_cache->insert(std::make_pair(rid, out));
+
+    return out;
+}
+
+
+rule_t rule_library_t::read(rule_id_t rid) const
+{
     pos_t pos;
     size_t rsize;
-    const int SIZE(512 * 512);
-    char buffer[SIZE];
 
     // GET RULE'S POSITION AND SIZE.
-    int offset = (rid - 1) * (sizeof(pos_t) + sizeof(size_t));
-    m_fi_idx->seekg(offset);
-    m_fi_idx->read((char*)&pos, sizeof(pos_t));
-    m_fi_idx->read((char*)&rsize, sizeof(size_t));
+    const char *idx = m_idx.first + (rid - m_offset - 1) * (sizeof(pos_t) + sizeof(size_t));
+    std::memcpy(&pos, idx, sizeof(pos_t));
+    std::memcpy(&rsize, idx + sizeof(pos_t), sizeof(size_t));
 
-    // GET THE RULE
-    m_fi_dat->seekg(pos);
-    m_fi_dat->read(buffer, rsize);
+    if (pos + rsize > m_dat.second)
+        throw exception_t(format("rule_library_t has a broken rule [rid = %d].", rid));
 
+    // GET THE RULE, WHICH IS DECODED FROM THE MEMORY WITHOUT COPYING.
     rule_t out;
-    binary_reader_t(buffer, SIZE).read<rule_t>(&out);
+    binary_reader_t(m_dat.first + pos, rsize).read<rule_t>(&out);
     out.set_rid(rid);
 
-    if (m_cache)
-        m_cache->insert(std::make_pair(rid, out));
+    return out;
+}
+
+
+std::shared_ptr<const rule_side_t> rule_library_t::side(rule_id_t rid, is_backward_t backward) const
+{
+    std::lock_guard<std::recursive_mutex> lock(ms_mutex);
+    const auto &cache = m_sides[backward ? 1 : 0];
+
+    if (cache)
+    {
+        auto it = cache->find(rid);
+        if (it != cache->end())
+            return it->second;
+    }
+
+    std::shared_ptr<const rule_side_t> out(new rule_side_t(get(rid), backward));
+
+    if (cache)
+        cache->insert(std::make_pair(rid, out));
 
     return out;
 }
@@ -186,7 +244,7 @@ rule_id_t rule_library_t::add_temporally(const rule_t &r)
 size_t rule_library_t::size() const
 {
     std::lock_guard<std::recursive_mutex> lock(ms_mutex);
-    return m_num_rules;
+    return m_deltas.empty() ? (m_offset + m_num_rules) : m_deltas.back()->size();
 }
 
 bool rule_library_t::is_writable() const
@@ -198,7 +256,7 @@ bool rule_library_t::is_writable() const
 bool rule_library_t::is_readable() const
 {
     std::lock_guard<std::recursive_mutex> lock(ms_mutex);
-    return (bool)m_fi_idx and (bool)m_fi_dat;
+    return m_idx.first != nullptr;
 }
 
 
@@ -9,6 +9,7 @@
 #include "./cnv_wp.h"
 #include "./sol.h"
 #include "./json.h"
+#include "./bin.h"
 
 
 
@@ -72,6 +73,11 @@ kernel_t::kernel_t(const command_t &c)
     assert(cnv);
     assert(sol);
 
+    // WORKERS ARE LAUNCHED ONCE HERE, SO THAT THEY ARE NOT RESPAWNED FOR EACH PROBLEM.
+    int num_exc_threads = param()->geti("exclusion-threads", 1);
+    if (num_exc_threads > 1)
+        exclusion_pool.reset(new task_pool_t(num_exc_threads));
+
     std::unordered_map<string_t, string_t> path2key;
 
     if (cmd.mode != MODE_LEARN)
@@ -94,13 +100,17 @@ kernel_t::kernel_t(const command_t &c)
 
     for (const auto &p : path2key)
     {
-        if (p.first == "-")
-            m_k2j.push_back(json::kernel2json_t(&std::cout, p.second));
+        // THE BINARY FORMAT HAS NO DECORATION.
+        if (p.second == "bin")
+            m_k2b.emplace_back(p.first);
         else
+        {
             m_k2j.push_back(json::kernel2json_t(p.first, p.second));
 
-        lhs->decorate(m_k2j.back());
-        cnv->decorate(m_k2j.back());
+            lhs->decorate(m_k2j.back());
+            cnv->decorate(m_k2j.back());
+            sol->decorate(m_k2j.back());
+        }
     }
 }
 
@@ -115,13 +125,36 @@ void kernel_t::read()
         console()->add_indent();
     }
 
+    tracer_t::span_t span("read");
     int n(0);
     bool do_compile = (cmd.mode == MODE_COMPILE) or param()->has("compile");
 
+    if (cmd.mode == MODE_COMPILE and param()->has("compact"))
+    {
+        kb::kb()->compact();
+        return;
+    }
+
+    // THIS IS CHECKED BEFORE prepare_compile(), WHICH REMOVES THE COMPILED KB.
+    if (cmd.mode == MODE_INFER and param()->has("stream") and do_compile)
+        throw exception_t("Streaming mode cannot be used together with compiling KB.");
+
     if (do_compile)
-        kb::kb()->prepare_compile();
+    {
+        if (param()->has("append"))
+            kb::kb()->prepare_append();
+        else
+            kb::kb()->prepare_compile();
+    }
     else
-        plib()->load();
+        kb::kb()->load_predicates();
+
+    if (cmd.mode == MODE_INFER and param()->has("stream"))
+    {
+        // PROBLEMS WILL BE READ ONE BY ONE IN run().
+        m_reader.reset(new parse::problem_reader_t(cmd.inputs));
+        return;
+    }
 
     auto proc = [&](parse::input_parser_t &parser)
     {
@@ -160,7 +193,11 @@ void kernel_t::read()
         }
     };
 
-    if (cmd.inputs.empty())
+    int num_threads = param()->geti("compile-threads", 1);
+
+    if (do_compile and num_threads > 1 and not cmd.inputs.empty())
+        read_in_parallel(num_threads);
+    else if (cmd.inputs.empty())
     {
         // READ FROM STDIN
         LOG_ROUGH("Reads stdin");
@@ -194,6 +231,184 @@ void kernel_t::read()
 }
 
 
+namespace
+{
+/** Statements read from a chunk of inputs. */
+struct chunk_content_t
+{
+    std::list<problem_t> probs;
+    std::list<rule_t> rules;
+    std::list<predicate_property_t> props;
+    std::vector<predicate_id_t> pids; /// Predicates appeared in the chunk, in the order.
+    std::exception_ptr error;
+};
+
+
+/** Replaces IDs of predicates in `conj` following `map`. */
+void remap(conjunction_t *conj, const std::vector<predicate_id_t> &map)
+{
+    for (auto &a : (*conj))
+    {
+        if (a.pid() < map.size())
+            a.set_pid(map[a.pid()]);
+    }
+}
+}
+
+
+void kernel_t::read_in_parallel(int num_threads)
+{
+    const size_t CHUNK_SIZE = 1 << 20;
+    const size_t BATCH_SIZE = num_threads * 4; // The number of chunks parsed at once.
+
+    std::vector<std::unique_ptr<mapped_file_t>> files;
+    std::vector<parse::chunk_t> chunks;
+    std::vector<std::exception_ptr> errors;
+    size_t total(0);
+
+    for (size_t i = 0; i < cmd.inputs.size(); ++i)
+    {
+        const auto &path = cmd.inputs.at(i);
+        LOG_ROUGH(format("Reads input #%d : \"%s\"", i, path.c_str()));
+
+        try
+        {
+            files.emplace_back(new mapped_file_t(path));
+        }
+        catch (...)
+        {
+            // THE ERROR IS REPORTED AFTER READING THE PRECEDING INPUTS.
+            chunks.push_back(parse::chunk_t{ nullptr, 0, 1 });
+            errors.resize(chunks.size());
+            errors.back() = std::current_exception();
+            continue;
+        }
+
+        const auto &f = files.back();
+        for (const auto &c : parse::input_parser_t::split(f->data(), f->size(), CHUNK_SIZE))
+            chunks.push_back(c);
+        total += f->size();
+    }
+    errors.resize(chunks.size());
+
+    task_pool_t pool(num_threads);
+    progress_bar_t progress(0, static_cast<int>(total >> 10), verboseness_e::SIMPLEST);
+    size_t readsize(0);
+
+    for (size_t begin = 0; begin < chunks.size(); begin += BATCH_SIZE)
+    {
+        size_t end = std::min(begin + BATCH_SIZE, chunks.size());
+        std::vector<chunk_content_t> contents(end - begin);
+        predicate_id_t n = plib()->predicates().size();
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            chunk_content_t *out = &contents[i - begin];
+
+            if (errors[i])
+            {
+                out->error = errors[i];
+                continue;
+            }
+
+            pool.push([&chunks, out, i]()
+            {
+                tracer_t::span_t span("read-chunk");
+                predicate_library_t::record(&out->pids);
+
+                try
+                {
+                    parse::input_parser_t parser(chunks[i]);
+
+                    while (parser.good())
+                    {
+                        parser.read();
+
+                        if (parser.prob())
+                            out->probs.push_back(*parser.prob());
+                        if (parser.rules())
+                            out->rules.splice(out->rules.end(), *parser.rules());
+                        if (parser.prop())
+                            out->props.push_back(*parser.prop());
+                    }
+                }
+                catch (...)
+                {
+                    out->error = std::current_exception();
+                }
+
+                predicate_library_t::record(nullptr);
+            });
+        }
+        pool.wait();
+
+        // PREDICATES ARE NUMBERED IN THE ORDER OF THEIR FIRST APPEARANCES,
+        // WHICH IS THE SAME AS READING INPUTS SEQUENTIALLY.
+        std::vector<predicate_id_t> order;
+        {
+            std::vector<bool> is_ordered(plib()->predicates().size() - n, false);
+
+            for (const auto &c : contents)
+            {
+                // ERRORS ARE REPORTED IN THE ORDER OF INPUTS.
+                if (c.error)
+                    std::rethrow_exception(c.error);
+
+                for (auto pid : c.pids)
+                {
+                    if (pid >= n and not is_ordered[pid - n])
+                    {
+                        is_ordered[pid - n] = true;
+                        order.push_back(pid);
+                    }
+                }
+            }
+        }
+
+        auto map = plib()->reorder(n, order);
+        std::vector<std::list<rule_t>*> rules;
+
+        for (auto &c : contents)
+        {
+            for (auto &p : c.probs)
+            {
+                remap(&p.facts, map);
+                remap(&p.queries, map);
+                remap(&p.requirement, map);
+                remap(&p.forall, map);
+
+                m_probs.push_back(p);
+                m_probs.back().index = (m_probs.size() - 1);
+
+                LOG_DETAIL(format(
+                    "added a problem [%d] : \"%s\"",
+                    m_probs.back().index, m_probs.back().name.c_str()));
+            }
+
+            for (auto &r : c.rules)
+            {
+                conjunction_t lhs(r.lhs()), rhs(r.rhs()), pre(r.pre());
+
+                remap(&lhs, map);
+                remap(&rhs, map);
+                remap(&pre, map);
+                r = rule_t(r.name(), lhs, rhs, pre);
+            }
+            rules.push_back(&c.rules);
+
+            for (const auto &p : c.props)
+                plib()->add_property(predicate_property_t(map.at(p.pid()), p.properties()));
+        }
+
+        kb::kb()->add(rules, &pool);
+
+        for (size_t i = begin; i < end; ++i)
+            readsize += chunks[i].length;
+        progress.set(static_cast<int>(readsize >> 10));
+    }
+}
+
+
 void kernel_t::run()
 {
     /* Returns whether `p` can be the target of inference. */
@@ -230,21 +445,45 @@ void kernel_t::run()
 
     for (auto &k2j : m_k2j)
         k2j.write_header();
+    for (auto &k2b : m_k2b)
+        k2b.write_header();
 
     switch (cmd.mode)
     {
     case MODE_INFER:
-        for (const auto &p : m_probs)
+    {
+        auto proc = [&](const problem_t &p)
         {
 			if (do_infer(p))
 			{
-				infer(p.index);
+				infer(p);
 
 				for (auto &k2j : m_k2j)
 					k2j.write_content();
+				for (auto &k2b : m_k2b)
+					k2b.write_content();
+
+				tracer()->flush();
 			}
+        };
+
+        if (m_reader)
+        {
+            // EACH PROBLEM IS RELEASED AFTER ITS RESULT IS WRITTEN.
+            problem_t p;
+            while (m_reader->next(&p))
+            {
+                LOG_DETAIL(format("added a problem [%d] : \"%s\"", p.index, p.name.c_str()));
+                proc(p);
+            }
+        }
+        else
+        {
+            for (const auto &p : m_probs)
+                proc(p);
         }
         break;
+    }
 
     case MODE_LEARN:
         throw exception_t("Lerning mode is disabled in this version.");
@@ -253,6 +492,8 @@ void kernel_t::run()
 
     for (auto &k2j : m_k2j)
         k2j.write_footer();
+    for (auto &k2b : m_k2b)
+        k2b.write_footer();
 
     kb::kb()->finalize();
 }
@@ -261,25 +502,35 @@ void kernel_t::run()
 
 
 void kernel_t::infer(index_t i)
+{
+    infer(m_probs.at(i));
+}
+
+
+void kernel_t::infer(const problem_t &p)
 {
     console_t::auto_indent_t ai;
     if (console()->is(verboseness_e::SIMPLEST))
     {
-        console()->print_fmt("Infer: problem[%d] - \"%s\"", i, m_probs.at(i).name.c_str());
+        console()->print_fmt("Infer: problem[%d] - \"%s\"", p.index, p.name.c_str());
         console()->add_indent();
     }
 
     assert(kb::kb()->is_readable());
 
     timer.reset(new time_watcher_t(param()->gett("timeout")));
-    m_prob = &m_probs.at(i);
+    m_prob = &p;
+
+    // METRICS ARE REPORTED PER PROBLEM.
+    tracer()->reset_metrics();
+    tracer_t::span_t span("infer");
 
     validate_components();
-    run_component(lhs.get(), "generating latent-hypotheses-set ...", ai.indent());
+    run_component(lhs.get(), "lhs", "generating latent-hypotheses-set ...", ai.indent());
 
 
-    run_component(cnv.get(), "converting LHS into an ILP problem ...", ai.indent());
-    run_component(sol.get(), "exploring solutions for the ILP problem ...", ai.indent());
+    run_component(cnv.get(), "cnv", "converting LHS into an ILP problem ...", ai.indent());
+    run_component(sol.get(), "sol", "exploring solutions for the ILP problem ...", ai.indent());
 
     timer->stop();
 }
@@ -305,7 +556,7 @@ void kernel_t::validate_components()
 }
 
 
-void kernel_t::run_component(component_t *c, const string_t &mes, int indent)
+void kernel_t::run_component(component_t *c, const char *name, const string_t &mes, int indent)
 {
     console()->set_indent(indent);
     console_t::auto_indent_t ai2;
@@ -316,6 +567,7 @@ void kernel_t::run_component(component_t *c, const string_t &mes, int indent)
         console()->add_indent();
     }
 
+    tracer_t::span_t span(name);
     c->run();
 }
 
@@ -340,6 +592,9 @@ void setup(const command_t &cmd)
 
     param()->initialize(cmd);
 
+    if (param()->has("trace") or param()->has("metrics"))
+        tracer()->initialize(param()->get("trace"));
+
     filepath_t path(cmd.get_opt("-k", "compiled"));
     kb::knowledge_base_t::initialize(path);
 
@@ -23,6 +23,11 @@ namespace json
 class kernel2json_t;
 }
 
+namespace bin
+{
+class writer_t;
+}
+
 
 /** A class to manage main process. */
 class kernel_t
@@ -33,7 +38,10 @@ public:
 
     static const string_t VERSION;
 
-    /** Reads inputs and compiles KB if necessary. */
+    /**
+    * @brief Reads inputs and compiles KB if necessary.
+    * @details In streaming mode, problems are not read here but in run().
+    */
     void read();
 
     /** Runs main process following its mode. */
@@ -46,8 +54,12 @@ public:
     void infer(index_t i);
 
 
+    /** Returns problems read. This is empty in streaming mode. */
     const std::deque<problem_t>& problems() const { return m_probs; }
 
+    /** Returns whether problems are read one by one during inference. */
+    bool is_streaming() const { return (bool)m_reader; }
+
     /** Returns the problem which you are now targetting on. */
     const problem_t& problem() const;
 
@@ -57,23 +69,38 @@ public:
     std::unique_ptr<ilp_converter_t> cnv;
     std::unique_ptr<ilp_solver_t>    sol;
 
+    /** Workers shared by proof-graphs to find exclusions. Null if `--exclusion-threads` is less than 2. */
+    std::unique_ptr<task_pool_t> exclusion_pool;
+
 
     std::unique_ptr<time_watcher_t> timer;
 
 private:
     kernel_t(const command_t&);
 
+    /**
+    * @brief Reads input files in parallel and compiles KB from them.
+    * @param num_threads The number of threads to parse inputs.
+    * @details The result is the same as reading the files sequentially.
+    */
+    void read_in_parallel(int num_threads);
+
+    /** Infers the problem given. */
+    void infer(const problem_t &p);
+
     void validate_components();
-    void run_component(component_t *c, const string_t &mes, int indent = -1);
+    void run_component(component_t *c, const char *name, const string_t &mes, int indent = -1);
 
     static std::unique_ptr<kernel_t> ms_instance;
 
     std::deque<problem_t> m_probs; /// List of problems.
+    std::unique_ptr<parse::problem_reader_t> m_reader; /// Source of problems in streaming mode.
     const problem_t      *m_prob;  /// The problem now solving.
 
     std::list<problem_t::matcher_t> m_matchers;
 
     std::list<json::kernel2json_t> m_k2j;
+    std::list<bin::writer_t> m_k2b;
 };
 
 inline kernel_t* kernel() { return kernel_t::instance(); }
@@ -66,6 +66,8 @@ void lhs_generator_t::postprocess()
         console()->add_indent();
     }
 
+    LOG_MIDDLE(format("found %d exclusions in %.3f seconds",
+        (int)out->excs.size(), out->exclusion_time()));
     LOG_MIDDLE("canceling invalid nodes ...");
 
     // CANCELS EDGES WHICH CANNOT SATISFY THEIR CONDITIONS
@@ -108,7 +110,7 @@ bool lhs_generator_t::do_target(pg::node_idx_t ni) const
     {
         // 同じ論理式を持つ、より小さいインデックスを持つノードが存在するならターゲットから除外
         const auto &n = out->nodes.at(ni);
-        for (const auto &nj : out->nodes.atom2nodes.get(n))
+        for (const auto &nj : out->nodes.atom2nodes.value(n.aid()))
         {
             if (nj < ni) return false;
         }
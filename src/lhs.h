@@ -98,6 +98,22 @@ public:
         int cmp(const chainer_with_distance_t&) const;
     };
 
+    /**
+    * @brief Set of chainers with distances, which are iterated in order of insertion.
+    * @details
+    *   Candidates inserted from these chainers are tied in distance in many cases,
+    *   so that iterating them in order of hash values makes the result depend on the hash function.
+    */
+    class chain_set_t : public std::vector<chainer_with_distance_t>
+    {
+    public:
+        /** Adds given chainer unless it exists and returns whether it has been added. */
+        bool insert(const chainer_with_distance_t&);
+
+    private:
+        std::unordered_set<chainer_with_distance_t, chainer_with_distance_t::hasher_t> m_set;
+    };
+
     /** Manager of candidates of chaining operations. */
     class chain_manager_t : public std::list<chainer_with_distance_t>
     {
@@ -115,8 +131,7 @@ public:
         inline const chainer_with_distance_t &top() const { return front(); }
         inline       chainer_with_distance_t &top()       { return front(); }
 
-        std::unordered_map<pg::chainer_t,
-            std::unordered_set<chainer_with_distance_t, chainer_with_distance_t::hasher_t>> chains;
+        std::unordered_map<pg::chainer_t, chain_set_t> chains;
         std::unordered_set<pg::chainer_t> processed;
 
     private:
@@ -31,7 +31,7 @@ void astar_generator_t::validate() const
 
 void astar_generator_t::process()
 {
-    out.reset(new pg::proof_graph_t(kernel()->problem()));
+    out.reset(new pg::proof_graph_t(kernel()->problem(), kernel()->exclusion_pool.get()));
 
     for (const auto &ni : range<size_t>(out->nodes.size()))
         apply_unification_to(ni);
@@ -165,19 +165,27 @@ int astar_generator_t::chainer_with_distance_t::cmp(const chainer_with_distance_
 
 size_t astar_generator_t::chainer_with_distance_t::hasher_t::operator()(const chainer_with_distance_t &x) const
 {
-    dav::fnv_1::hash_t<size_t> hasher;
+    dav::word_hash_t hasher;
 
-    hasher.read((uint8_t*)&x.rid(), sizeof(dav::rule_id_t) / sizeof(uint8_t));
+    hasher.read(static_cast<uint64_t>(x.rid()));
     for (const auto &i : x.targets())
-        hasher.read((uint8_t*)&i, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
+        hasher.read(static_cast<uint64_t>(i));
 
-    hasher.read((uint8_t*)&x.s_node, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
-    hasher.read((uint8_t*)&x.g_node, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
+    hasher.read(static_cast<uint32_t>(x.s_node), static_cast<uint32_t>(x.g_node));
 
     return hasher.hash();
 }
 
 
+bool astar_generator_t::chain_set_t::insert(const chainer_with_distance_t &c)
+{
+    if (not m_set.insert(c).second) return false;
+
+    push_back(c);
+    return true;
+}
+
+
 void astar_generator_t::chain_manager_t::initialize()
 {
     clear();
@@ -313,8 +321,7 @@ void astar_generator_t::chain_manager_t::push(const chainer_with_distance_t& r)
 {
     if (processed.count(r) > 0) return;
 
-    auto ret = chains[r].insert(r);
-    if (not ret.second) return; // ALREADY EXISTS
+    if (not chains[r].insert(r)) return; // ALREADY EXISTS
 
     auto shorter_than = [&r](const chainer_with_distance_t &c) -> bool
     {
@@ -24,7 +24,7 @@ void simple_generator_t::validate() const
 void simple_generator_t::process()
 {
     std::unordered_set<pg::chainer_t> processed;
-    out.reset(new pg::proof_graph_t(master()->problem()));
+    out.reset(new pg::proof_graph_t(master()->problem(), master()->exclusion_pool.get()));
 
     auto apply_chaining_to = [&](pg::node_idx_t ni)
     {
@@ -15,49 +15,59 @@ namespace parse
 
 condition_t operator&(const condition_t &c1, const condition_t &c2)
 {
-    return [=](char ch) { return c1(ch) and c2(ch); };
+    condition_t out;
+    for (int i = 0; i < 4; ++i)
+        out.m_bits[i] = c1.m_bits[i] & c2.m_bits[i];
+    return out;
 }
 
 condition_t operator|(const condition_t &c1, const condition_t &c2)
 {
-    return [=](char ch) { return c1(ch) or c2(ch); };
+    condition_t out;
+    for (int i = 0; i < 4; ++i)
+        out.m_bits[i] = c1.m_bits[i] | c2.m_bits[i];
+    return out;
 }
 
 condition_t operator!(const condition_t &c)
 {
-    return [=](char ch) {return not c(ch); };
+    condition_t out;
+    for (int i = 0; i < 4; ++i)
+        out.m_bits[i] = ~c.m_bits[i];
+    return out;
 }
 
 condition_t is(char t)
 {
-    return [=](char ch) { return ch == t; };
+    condition_t out;
+    unsigned char i = static_cast<unsigned char>(t);
+    out.m_bits[i >> 6] |= (uint64_t(1) << (i & 63));
+    return out;
 }
 
 condition_t is(const std::string &ts)
 {
-    return [=](char ch)
-    {
-        for (auto t : ts)
-            if (ch == t) return true;
-        return false;
-    };
+    condition_t out;
+    for (auto t : ts)
+        out = out | is(t);
+    return out;
 }
 
-condition_t lower = [=](char ch) { return (ch >= 'a') and (ch <= 'z'); };
-condition_t upper = [=](char ch) { return (ch >= 'A') and (ch <= 'Z'); };
+condition_t lower = [](char ch) { return (ch >= 'a') and (ch <= 'z'); };
+condition_t upper = [](char ch) { return (ch >= 'A') and (ch <= 'Z'); };
 condition_t alpha = lower | upper;
-condition_t digit = [=](char ch) { return (ch >= '0') and (ch <= '9'); };
+condition_t digit = [](char ch) { return (ch >= '0') and (ch <= '9'); };
 condition_t space = is(" \t\n\r");
 condition_t quotation_mark = is("\'\"");
 condition_t bracket = is("(){}[]<>");
 condition_t newline = is('\n');
 condition_t ascii = alpha | digit | is("_+-*.");
-condition_t bad = [=](char ch) { return (ch == -1) or (ch == 0); };
+condition_t bad = [](char ch) { return (ch == -1) or (ch == 0); };
 condition_t general = not (bad | space | bracket | quotation_mark | is("#^!|=:"));
 
 formatter_t operator&(const formatter_t &f1, const formatter_t &f2)
 {
-    return [=](const std::string &s)
+    return [=](const view_t &s)
 	{
 		return static_cast<format_result_e>(std::min<int>(f1(s), f2(s)));
 	};
@@ -65,7 +75,7 @@ formatter_t operator&(const formatter_t &f1, const formatter_t &f2)
 
 formatter_t operator|(const formatter_t &f1, const formatter_t &f2)
 {
-    return [=](const std::string &s)
+    return [=](const view_t &s)
 	{
 		return static_cast<format_result_e>(std::max<int>(f1(s), f2(s)));
 	};
@@ -74,7 +84,7 @@ formatter_t operator|(const formatter_t &f1, const formatter_t &f2)
 
 formatter_t word(const std::string &w)
 {
-    return [=](const std::string &str)
+    return [=](const view_t &str)
     {
 		if (str.empty()) return FMT_READING;
 
@@ -95,17 +105,19 @@ formatter_t word(const std::string &w)
 
 formatter_t many(const condition_t &c)
 {
-    return [=](const std::string &str)
+    formatter_t out = [=](const view_t &str)
 	{
 		if (str.empty()) return FMT_READING;
 		else return c(str.back()) ? FMT_GOOD : FMT_BAD;
 	};
+    out.m_span.reset(new condition_t(c));
+    return out;
 }
 
 
 formatter_t startswith(const condition_t &c)
 {
-    return [=](const std::string &str)
+    return [=](const view_t &str)
 	{
 		if (str.empty()) return FMT_READING;
 		else return (c(str.front())) ? FMT_GOOD : FMT_BAD;
@@ -115,7 +127,7 @@ formatter_t startswith(const condition_t &c)
 
 formatter_t enclosed(char begin, char last)
 {
-    return [=](const std::string &str)
+    return [=](const view_t &str)
     {
 		if (str.empty()) return FMT_READING;
 
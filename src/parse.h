@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <cstdint>
+#include <cstring>
 #include <list>
 #include <tuple>
 #include <memory>
@@ -25,11 +27,101 @@ enum format_result_e
 
 using stream_ptr_t = std::istream*;
 
-/** Condition which a character should satisfy. */
-using condition_t = std::function<bool(char)>;
 
-/** Condition which a string should satisfy. */
-using formatter_t = std::function<format_result_e(const std::string&)>;
+/** @brief Condition which a character should satisfy, which is held as a bit-table of all characters. */
+class condition_t
+{
+public:
+    condition_t() { std::memset(m_bits, 0, sizeof(m_bits)); }
+
+    /** Makes the table by evaluating given predicate for every character. */
+    template <class F, class = decltype(std::declval<const F&>()('\0'))>
+    condition_t(const F &f)
+    {
+        std::memset(m_bits, 0, sizeof(m_bits));
+        for (int i = 0; i < 256; ++i)
+            if (f(static_cast<char>(i)))
+                m_bits[i >> 6] |= (uint64_t(1) << (i & 63));
+    }
+
+    bool operator()(char ch) const
+    {
+        unsigned char i = static_cast<unsigned char>(ch);
+        return (m_bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    friend condition_t operator&(const condition_t &c1, const condition_t &c2);
+    friend condition_t operator|(const condition_t &c1, const condition_t &c2);
+    friend condition_t operator!(const condition_t &c);
+    friend condition_t is(char t);
+
+private:
+    uint64_t m_bits[4];
+};
+
+
+/**
+* @brief Reference to a part of the input, which is valid until the next reading.
+* @details This is used to avoid copying strings while parsing.
+*/
+class view_t
+{
+public:
+    view_t() : m_ptr(nullptr), m_len(0) {}
+    view_t(const char *ptr, size_t len) : m_ptr(ptr), m_len(len) {}
+
+    const char* data() const { return m_ptr; }
+    size_t length() const { return m_len; }
+    bool empty() const { return m_len == 0; }
+
+    char front() const { return m_ptr[0]; }
+    char back() const { return m_ptr[m_len - 1]; }
+    char operator[](size_t i) const { return m_ptr[i]; }
+
+    /** Returns the index of the first `c` at or after `pos`, or std::string::npos. */
+    size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= m_len) return std::string::npos;
+        const void *p = std::memchr(m_ptr + pos, c, m_len - pos);
+        return p ? (static_cast<const char*>(p) - m_ptr) : std::string::npos;
+    }
+
+    bool operator==(const char *s) const
+    {
+        return std::strlen(s) == m_len and std::memcmp(m_ptr, s, m_len) == 0;
+    }
+    bool operator!=(const char *s) const { return not operator==(s); }
+
+    string_t string() const { return string_t(std::string(m_ptr, m_len)); }
+
+private:
+    const char *m_ptr;
+    size_t m_len;
+};
+
+
+/** @brief Condition which a string should satisfy. */
+class formatter_t
+{
+public:
+    template <class F, class = decltype(std::declval<const F&>()(view_t()))>
+    formatter_t(const F &f) : m_func(f) {}
+
+    format_result_e operator()(const view_t &s) const { return m_func(s); }
+
+    /**
+    * @brief Returns the condition if this formatter accepts
+    *        just the longest run of characters satisfying it, otherwise nullptr.
+    * @details stream_t::read() scans the input without calling this formatter if available.
+    */
+    const condition_t* span() const { return m_span.get(); }
+
+    friend formatter_t many(const condition_t &c);
+
+private:
+    std::function<format_result_e(const view_t&)> m_func;
+    std::shared_ptr<condition_t> m_span;
+};
 
 condition_t operator&(const condition_t &c1, const condition_t &c2);
 condition_t operator|(const condition_t &c1, const condition_t &c2);
@@ -64,7 +156,13 @@ extern formatter_t name;
 extern formatter_t predicate;
 
 
-/** @brief Wrapper class of input-stream. */
+/**
+* @brief Wrapper class of input-stream.
+* @details
+*   Files are mapped onto memory (or read by blocks where mapping is not available)
+*   and other streams are read line by line, so that characters are scanned
+*   in contiguous memory without copying them one by one.
+*/
 class stream_t
 {
 public:
@@ -83,6 +181,17 @@ public:
     */
     stream_t(const filepath_t &path);
 
+    /**
+    * @brief Constructor, which reads characters on memory.
+    * @param[in] ptr The head of characters, which must be alive while this is used.
+    * @param[in] len The number of characters.
+    * @param[in] row The row number of the head, which is used in messages.
+    */
+    stream_t(const char *ptr, size_t len, size_t row);
+
+    stream_t(const stream_t&) = delete;
+    stream_t& operator=(const stream_t&) = delete;
+
     /** Reads one character from input. */
     int get();
 
@@ -90,14 +199,20 @@ public:
     void unget();
 
     char get(const condition_t&);
-	bool peek(const condition_t&) const;
+    bool peek(const condition_t&);
 
     /**
     * @brief Reads string satisfying given format as long as possible.
     * @param[in] f Condition that string read must satisfy.
     * @return String read.
     */
-    string_t read(const formatter_t &f);
+    string_t read(const formatter_t &f) { return scan(f).string(); }
+
+    /**
+    * @brief Same as stream_t::read() but returns a view of the input.
+    * @details The view returned is valid until the next reading.
+    */
+    view_t scan(const formatter_t &f);
 
     /**
     * @brief Skips characters which satisfy given condition.
@@ -108,6 +223,12 @@ public:
     /** Skips spaces and comments. */
     void skip();
 
+    /** Returns false if the end of input has been reached. */
+    bool good() const { return not m_eof; }
+
+    /** Returns true if the end of input has been reached. */
+    bool eof() const { return m_eof; }
+
     /** Gets current row number. */
     size_t row() const { return m_row; }
 
@@ -120,9 +241,6 @@ public:
     /** Gets size of input. */
     size_t filesize() const { return m_filesize; }
 
-    /** Gets pointer to the input. */
-    const std::istream* stream() const { return m_is; }
-
     /**
     * @brief Gets current position in input stream.
     * @details Positions returned will be used by stream_t::restore().
@@ -132,6 +250,9 @@ public:
     /**
     * @brief Sets reading position to `p`.
     * @param[in] p Target position.
+    * @details
+    *   On stream inputs, throws an exception if `p` is more than SIZE_BACKWARD characters
+    *   behind the reading position, because such characters have been discarded.
     * @sa stream_t::position()
     */
     void restore(const stream_pos_t &p);
@@ -144,29 +265,68 @@ public:
     exception_t exception(const string_t &s) const;
 
 private:
-    static const int SIZE_BUFFER = 100;
+    /** The number of characters kept behind the reading position for stream_t::restore(). */
+    static const size_t SIZE_BACKWARD = 1 << 16;
+
+    /** Returns the pointer to the character at `pos`, or nullptr if `pos` is at the end of input. */
+    const char* at(size_t pos)
+    {
+        return (pos < m_end) ? m_data + (pos - m_offset) : fill(pos);
+    }
+
+    /** Reads more characters from the stream until `pos` gets available. */
+    const char* fill(size_t pos);
+
+    /** Updates the row and the column with characters read. */
+    void advance(const view_t &v);
 
     std::unique_ptr<std::istream> m_is_new;
-    std::istream *m_is;
+    std::istream *m_is; /// The stream to read, or nullptr if whole of the input is on memory.
 
-    string_t m_buffer;
+    const char *m_data; /// Characters on memory, whose position in the input starts at m_offset.
+    size_t m_offset, m_end;
+    std::string m_block; /// Characters read from m_is.
 
+    std::unique_ptr<mapped_file_t> m_file; /// The file mapped onto memory, or nullptr.
+
+    bool m_eof;
     size_t m_row, m_column;
     size_t m_readsize;
     size_t m_filesize;
 };
 
 
+/** @brief Part of an input, which consists of whole statements and can be parsed independently. */
+struct chunk_t
+{
+    const char *ptr;
+    size_t length;
+    size_t row; /// The row number of the head in the input.
+};
+
+
 /** @brief Parser for David input files. */
 class input_parser_t
 {
 public:
+    /**
+    * @brief Splits the input on memory into chunks at boundaries of statements.
+    * @param[in] ptr The head of the input.
+    * @param[in] len The length of the input.
+    * @param[in] size The length of each chunk, which is exceeded until the next boundary.
+    * @details
+    *   Each chunk begins at the head of a line following the end of a statement,
+    *   so that messages of errors in it give the same positions as reading the whole input.
+    */
+    static std::vector<chunk_t> split(const char *ptr, size_t len, size_t size);
+
     input_parser_t(std::istream *is);
     input_parser_t(const std::string &path);
+    input_parser_t(const chunk_t &chunk);
     
     void read();
-    bool good() const { return m_stream.stream()->good(); }
-    bool eof() const { return m_stream.stream()->eof(); }
+    bool good() const { return m_stream.good(); }
+    bool eof() const { return m_stream.eof(); }
 
     std::unique_ptr<progress_bar_t> make_progress_bar() const;
     void update_progress_bar(progress_bar_t &pw) const;
@@ -186,6 +346,37 @@ private:
 };
 
 
+/**
+* @brief Reader which yields problems in inputs one by one.
+* @details
+*   Inputs are parsed lazily, so that a problem can be solved before the rest of inputs are read.
+*   Statements other than problems, such as rules, are skipped.
+*/
+class problem_reader_t
+{
+public:
+    /**
+    * @brief Constructor.
+    * @param[in] paths Paths of input files. The standard input is read if this is empty.
+    */
+    problem_reader_t(const std::deque<string_t> &paths);
+
+    /**
+    * @brief Reads the next problem.
+    * @param[out] out Pointer to which the problem read will be written. Its index is given sequentially.
+    * @return False if there is no more problem, otherwise true.
+    */
+    bool next(problem_t *out);
+
+private:
+    std::deque<string_t> m_paths;
+    size_t m_num_opened; /// The number of inputs opened so far.
+    index_t m_num_problems; /// The number of problems read so far.
+
+    std::unique_ptr<input_parser_t> m_parser;
+};
+
+
 /** A class to parse command options on LINUX-like way. */
 class argv_parser_t
 {
@@ -10,6 +10,14 @@ namespace parse
 {
 
 
+namespace
+{
+const formatter_t word_not = word("not ");
+const formatter_t word_false = word("false");
+const formatter_t word_forall = word("forall");
+}
+
+
 input_parser_t::input_parser_t(std::istream *is)
     : m_stream(is)
 {}
@@ -20,6 +28,75 @@ input_parser_t::input_parser_t(const std::string &path)
 {}
 
 
+input_parser_t::input_parser_t(const chunk_t &chunk)
+    : m_stream(chunk.ptr, chunk.length, chunk.row)
+{}
+
+
+std::vector<chunk_t> input_parser_t::split(const char *ptr, size_t len, size_t size)
+{
+    std::vector<chunk_t> out;
+    chunk_t head{ ptr, 0, 1 };
+    chunk_t next{ nullptr, 0, 0 }; // The head of line where the next chunk can begin.
+    size_t row(1);
+    int depth(0);
+    bool is_outside(true); // Whether the current position is between statements.
+
+    for (const char *p = ptr, *end = ptr + len; p < end; ++p)
+    {
+        if (*p == '\n')
+        {
+            ++row;
+            if (is_outside and next.ptr == nullptr)
+                next = chunk_t{ p + 1, 0, row };
+            continue;
+        }
+
+        if (space(*p)) continue;
+
+        // COMMENTS MAY HAVE ANY CHARACTER TILL THE END OF LINE.
+        if (*p == '#')
+        {
+            const char *q = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            p = (q ? q : end) - 1;
+            continue;
+        }
+
+        if (is_outside)
+        {
+            if (next.ptr != nullptr and static_cast<size_t>(next.ptr - head.ptr) >= size)
+            {
+                head.length = next.ptr - head.ptr;
+                out.push_back(head);
+                head = next;
+            }
+            is_outside = false;
+        }
+        next.ptr = nullptr;
+
+        if (quotation_mark(*p))
+        {
+            // BRACKETS IN QUOTATIONS ARE IGNORED.
+            const char *q = p + 1;
+            while (q < end and *q != *p and *q != '\n') ++q;
+            if (q < end and *q == *p) p = q;
+        }
+        else if (*p == '{')
+            ++depth;
+        else if (*p == '}')
+        {
+            if (depth > 0) --depth;
+            if (depth == 0) is_outside = true;
+        }
+    }
+
+    head.length = (ptr + len) - head.ptr;
+    out.push_back(head);
+
+    return out;
+}
+
+
 void input_parser_t::read()
 {
     string_t line;
@@ -74,7 +151,7 @@ void input_parser_t::read()
         m_stream.skip();
 
         // READ NEGATION AS FAILURE
-        if (m_stream.read(word("not ")))
+        if (not m_stream.scan(word_not).empty())
         {
             naf = true;
             m_stream.skip();
@@ -147,7 +224,7 @@ void input_parser_t::read()
         atom_t out(pred, terms, naf);
 
         // ---- READ PARAMETER OF THE ATOM
-        out.param() = read_parameter();
+        out.set_param(read_parameter());
 
         return out;
     };
@@ -164,7 +241,7 @@ void input_parser_t::read()
             throw m_stream.exception("expected \'{\'");
 
         m_stream.skip();
-        bool is_constraint = not m_stream.read(word("false")).empty();
+        bool is_constraint = not m_stream.scan(word_false).empty();
 
         if (is_constraint)
         {
@@ -179,9 +256,9 @@ void input_parser_t::read()
 
         if (not is_constraint)
         {
-            while (m_stream.stream()->good())
+            while (m_stream.good())
             {
-                bool is_forall = not m_stream.read(word("forall")).empty();
+                bool is_forall = not m_stream.scan(word_forall).empty();
                 m_stream.skip();
 
                 atom_t atom = read_atom();
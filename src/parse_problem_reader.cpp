@@ -0,0 +1,56 @@
+#include "./parse.h"
+
+
+namespace dav
+{
+
+namespace parse
+{
+
+
+problem_reader_t::problem_reader_t(const std::deque<string_t> &paths)
+    : m_paths(paths), m_num_opened(0), m_num_problems(0)
+{}
+
+
+bool problem_reader_t::next(problem_t *out)
+{
+    while (true)
+    {
+        while (m_parser and m_parser->good())
+        {
+            m_parser->read();
+
+            if (m_parser->prob())
+            {
+                *out = *m_parser->prob();
+                out->index = m_num_problems++;
+                return true;
+            }
+        }
+
+        // OPENS THE NEXT INPUT.
+        if (m_paths.empty())
+        {
+            if (m_num_opened > 0) return false;
+
+            LOG_ROUGH("Reads stdin");
+            m_parser.reset(new input_parser_t(&std::cin));
+        }
+        else
+        {
+            if (m_num_opened >= m_paths.size()) return false;
+
+            const auto &path = m_paths.at(m_num_opened);
+            LOG_ROUGH(format("Reads input #%d : \"%s\"", m_num_opened, path.c_str()));
+            m_parser.reset(new input_parser_t(path));
+        }
+
+        ++m_num_opened;
+    }
+}
+
+
+}
+
+}
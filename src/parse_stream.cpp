@@ -1,3 +1,5 @@
+#include <fstream>
+
 #include "./parse.h"
 
 namespace dav
@@ -7,7 +9,8 @@ namespace parse
 {
 
 stream_t::stream_t(std::istream *is)
-    : m_is(is), m_row(1), m_column(1), m_readsize(0), m_filesize(0)
+    : m_is(is), m_data(nullptr), m_offset(0), m_end(0),
+      m_eof(not is->good()), m_row(1), m_column(1), m_readsize(0), m_filesize(0)
 {
     if (m_is != &std::cin)
         m_filesize = dav::filesize(*is);
@@ -15,8 +18,22 @@ stream_t::stream_t(std::istream *is)
 
 
 stream_t::stream_t(const filepath_t &path)
-    : m_row(1), m_column(1), m_readsize(0)
+    : m_is(nullptr), m_data(nullptr), m_offset(0), m_end(0),
+      m_eof(false), m_row(1), m_column(1), m_readsize(0), m_filesize(0)
 {
+#ifndef _WIN32
+    // REGULAR FILES ARE MAPPED ONTO MEMORY.
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 and S_ISREG(st.st_mode) and st.st_size > 0)
+    {
+        m_file.reset(new mapped_file_t(path));
+        m_data = m_file->data();
+        m_end = m_filesize = m_file->size();
+        return;
+    }
+#endif
+
+    // OTHERWISE THE FILE IS READ AS A STREAM.
     m_is_new.reset(new std::ifstream(path));
 
     if (m_is_new->good())
@@ -29,34 +46,21 @@ stream_t::stream_t(const filepath_t &path)
 }
 
 
-int stream_t::get()
-{
-    size_t idx = m_readsize % SIZE_BUFFER;
-    if (m_buffer.length() - idx >= SIZE_BUFFER)
-        idx += SIZE_BUFFER;
-
-    assert(idx <= m_buffer.length());
+stream_t::stream_t(const char *ptr, size_t len, size_t row)
+    : m_is(nullptr), m_data(ptr), m_offset(0), m_end(len),
+      m_eof(false), m_row(row), m_column(1), m_readsize(0), m_filesize(len)
+{}
 
-    if (idx < m_buffer.length())
-    {
-        ++m_readsize;
-        return m_buffer.at(idx);
-    }
-    else
-    {
-        char c = m_is->get();
 
-        if (c != std::istream::traits_type::eof())
-        {
-            m_buffer.push_back(c);
-            ++m_readsize;
+int stream_t::get()
+{
+    const char *p = at(m_readsize);
 
-            if (m_buffer.length() >= SIZE_BUFFER * 2)
-                m_buffer = m_buffer.substr(SIZE_BUFFER);
-        }
+    if (p == nullptr)
+        return std::istream::traits_type::eof();
 
-        return c;
-    }
+    ++m_readsize;
+    return *p;
 }
 
 
@@ -68,94 +72,81 @@ void stream_t::unget()
 
 char stream_t::get(const condition_t &f)
 {
-    char c = get();
+    const char *p = at(m_readsize);
 
-    if (c != std::istream::traits_type::eof())
-    {
-        if (f(c))
-        {
-            if (c == '\n')
-            {
-                ++m_row;
-                m_column = 1;
-            }
-            else
-                ++m_column;
+    if (p == nullptr)
+        return -1;
 
-            return c;
-        }
-        else
-        {
-            unget();
-            return 0;
-        }
+    if (not f(*p))
+        return 0;
+
+    ++m_readsize;
+
+    if (*p == '\n')
+    {
+        ++m_row;
+        m_column = 1;
     }
     else
-        return -1;
+        ++m_column;
+
+    return *p;
 }
 
 
-bool stream_t::peek(const condition_t &c) const
+bool stream_t::peek(const condition_t &c)
 {
-    size_t idx = m_readsize % SIZE_BUFFER;
-    if (m_buffer.length() - idx >= SIZE_BUFFER)
-        idx += SIZE_BUFFER;
-
-    assert(idx <= m_buffer.length());
-
-    char ch = (idx < m_buffer.length()) ? m_buffer.at(idx) : static_cast<char>(m_is->peek());
-    return c(ch);
+    const char *p = at(m_readsize);
+    return c(p ? *p : static_cast<char>(std::istream::traits_type::eof()));
 }
 
 
-string_t stream_t::read(const formatter_t &f)
+view_t stream_t::scan(const formatter_t &f)
 {
-    format_result_e past = FMT_READING;
-    string_t out;
-    auto pos = position();
-    char ch = get();
-    int n_endl = 0;
+    size_t begin(m_readsize), len(0), n_bad(0);
+    const char *p;
 
-    while (not bad(ch))
+    if (const condition_t *c = f.span())
+    {
+        // SCANS THE LONGEST RUN OF CHARACTERS SATISFYING THE CONDITION.
+        while ((p = at(begin + len)) != nullptr)
+        {
+            if (bad(*p)) { n_bad = 1; break; }
+            if (not (*c)(*p)) break;
+            ++len;
+        }
+    }
+    else
     {
-        format_result_e res = f(out + ch);
+        format_result_e past = FMT_READING;
 
-        switch (res)
+        // CHARACTERS FROM `begin` ARE CONTIGUOUS ON MEMORY,
+        // SO THAT THE FORMATTER CAN SEE THEM WITHOUT COPYING.
+        while ((p = at(begin + len)) != nullptr)
         {
-        case FMT_BAD:
-            switch (past)
+            if (bad(*p)) { n_bad = 1; break; }
+
+            format_result_e res = f(view_t(p - len, len + 1));
+
+            if (res == FMT_BAD)
             {
-            case FMT_GOOD:
-                unget();
-                break;
-            default:
-                out = "";
-                restore(pos);
+                if (past != FMT_GOOD) len = 0;
                 break;
             }
-            goto END_READ;
 
-        default:
-            out += ch;
-            ch = get();
-            break;
+            past = res;
+            ++len;
         }
-
-        past = res;
     }
 
-END_READ:
+    // A BAD CHARACTER WHICH TERMINATED READING IS CONSUMED.
+    m_readsize = begin + len + n_bad;
 
-    for (const auto &c : out)
-    {
-        if (c == '\n')
-        {
-            ++m_row;
-            m_column = 1;
-        }
-        else
-            ++m_column;
-    }
+    if (len == 0)
+        return view_t();
+
+    view_t out(at(begin), len);
+    advance(out);
 
     return out;
 }
@@ -173,7 +164,7 @@ void stream_t::ignore(const condition_t &f)
 void stream_t::skip()
 {
     do ignore(space);
-    while (read(comment));
+    while (not scan(comment).empty());
 }
 
 
@@ -185,14 +176,13 @@ stream_t::stream_pos_t stream_t::position() const
 
 void stream_t::restore(const stream_pos_t &pos)
 {
-    size_t diff = m_readsize - std::get<2>(pos);
-
-    for (size_t i = 0; i < diff; ++i)
-        unget();
+    // ON STREAM INPUTS, CHARACTERS FAR BEHIND THE READING POSITION HAVE BEEN DISCARDED.
+    if (std::get<2>(pos) < m_offset)
+        throw exception("stream_t cannot restore the position discarded from its buffer");
 
     m_row = std::get<0>(pos);
     m_column = std::get<1>(pos);
-    assert(m_readsize == std::get<2>(pos));
+    m_readsize = std::get<2>(pos);
 }
 
 
@@ -202,6 +192,58 @@ exception_t stream_t::exception(const string_t &str) const
 }
 
 
+const char* stream_t::fill(size_t pos)
+{
+    assert(pos >= m_offset);
+
+    while (m_is != nullptr and pos >= m_end)
+    {
+        // DISCARDS CHARACTERS WHICH WILL NOT BE RESTORED ANY MORE.
+        if (m_readsize > m_offset + SIZE_BACKWARD * 2)
+        {
+            size_t n = m_readsize - m_offset - SIZE_BACKWARD;
+            m_block.erase(0, n);
+            m_offset += n;
+        }
+
+        // READS LINE BY LINE SO AS NOT TO WAIT FOR INPUT WHICH IS NOT NEEDED YET.
+        std::string line;
+        if (std::getline(*m_is, line))
+        {
+            m_block.append(line);
+            if (not m_is->eof())
+                m_block.push_back('\n');
+        }
+        else
+            m_is = nullptr;
+
+        m_data = m_block.data();
+        m_end = m_offset + m_block.size();
+    }
+
+    if (pos < m_end)
+        return m_data + (pos - m_offset);
+
+    m_eof = true;
+    return nullptr;
+}
+
+
+void stream_t::advance(const view_t &v)
+{
+    for (size_t i = 0; i < v.length(); ++i)
+    {
+        if (v[i] == '\n')
+        {
+            ++m_row;
+            m_column = 1;
+        }
+        else
+            ++m_column;
+    }
+}
+
+
 }
 
 }
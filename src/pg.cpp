@@ -39,7 +39,7 @@ node_t::node_t(
     const atom_t &atom, node_type_e type, node_idx_t idx, depth_t depth,
     is_query_side_t from_query)
     : atom_t(atom), m_type(type),
-    m_index(idx), m_depth(depth), m_master(-1),
+    m_index(idx), m_aid(intern_table_t<atom_t>::INVALID_ID), m_depth(depth), m_master(-1),
     m_is_query_side(from_query), m_is_active(true)
 {}
 
@@ -124,6 +124,7 @@ operator_t::operator_t()
 bool operator_t::valid() const
 {
     assert(m_pg);
+    tracer_t::span_t span("pg-validate");
     validator_t v(m_pg, this);
     return v.good();
 }
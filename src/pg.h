@@ -30,6 +30,9 @@ namespace pg
 
 using is_query_side_t = bool;
 
+typedef intern_table_t<atom_t>::id_t atom_id_t; //!< Dense ID of an atom in a proof-graph.
+typedef intern_table_t<conjunction_t>::id_t conjunction_id_t; //!< Dense ID of a conjunction in a proof-graph.
+
 class node_t;
 class edge_t;
 class proof_graph_t;
@@ -72,6 +75,12 @@ public:
     /** Gets the index of this node in a proof-graph. */
     inline const node_idx_t& index() const { return m_index; }
 
+    /** Gets the ID of the atom of this node in proof_graph_t::nodes_t::atom2nodes. */
+    inline const atom_id_t& aid() const { return m_aid; }
+
+    /** Refers the ID of the atom of this node in proof_graph_t::nodes_t::atom2nodes. */
+    inline atom_id_t& aid() { return m_aid; }
+
     /**
     * @brief Gets depth, the number of rules to hypothesize this from input.
     * @details Depth of a node in the input is 0.
@@ -110,6 +119,7 @@ public:
 private:
     node_type_e m_type;
     node_idx_t  m_index;
+    atom_id_t   m_aid;
     hypernode_idx_t m_master;
     depth_t m_depth;
 
@@ -397,7 +407,7 @@ public:
     const is_backward_t& is_backward() const { return m_backward; }
 
     /** Gets conjunction not grounded, that will be the input of this operation. */
-    const conjunction_t atoms_of_input() const { return m_conj_in; }
+    const conjunction_t atoms_of_input() const { return m_side ? m_side->evidence : conjunction_t(); }
 
     /** Gets conjunction not grounded, that will be the output of this operation. */
     const conjunction_t atoms_of_output() const { return m_conj_out; }
@@ -422,7 +432,8 @@ protected:
 
     is_backward_t m_backward;
 
-    conjunction_t m_conj_in, m_conj_out;
+    std::shared_ptr<const rule_side_t> m_side;
+    conjunction_t m_conj_out;
 
     std::shared_ptr<grounder_t> m_grounder;
 };
@@ -447,9 +458,9 @@ template <> struct hash<dav::pg::hypernode_t>
 {
     size_t operator() (const dav::pg::hypernode_t &x) const
     {
-        dav::fnv_1::hash_t<size_t> hasher;
+        dav::word_hash_t hasher;
         for (const auto &n : x)
-            hasher.read((uint8_t*)&n, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
+            hasher.read(static_cast<uint64_t>(n));
         return hasher.hash();
     }
 };
@@ -468,11 +479,11 @@ template <> struct hash<dav::pg::chainer_t>
 {
     size_t operator() (const dav::pg::chainer_t &x) const
     {
-        dav::fnv_1::hash_t<size_t> hasher;
+        dav::word_hash_t hasher;
 
-        hasher.read((uint8_t*)&x.rid(), sizeof(dav::rule_id_t) / sizeof(uint8_t));
+        hasher.read(static_cast<uint64_t>(x.rid()));
         for (const auto &i : x.targets())
-            hasher.read((uint8_t*)&i, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
+            hasher.read(static_cast<uint64_t>(i));
 
         return hasher.hash();
     }
@@ -483,12 +494,13 @@ template <> struct hash<dav::pg::operation_summary_t>
 {
     size_t operator() (const dav::pg::operation_summary_t &x) const
     {
-        dav::fnv_1::hash_t<size_t> hasher;
+        dav::word_hash_t hasher;
 
-        hasher.read((uint8_t*)&std::get<1>(x), sizeof(dav::rule_id_t) / sizeof(uint8_t));
-        hasher.read((uint8_t*)&std::get<2>(x), sizeof(dav::pg::edge_type_e) / sizeof(uint8_t));
+        hasher.read(
+            static_cast<uint32_t>(std::get<1>(x)),
+            static_cast<uint32_t>(std::get<2>(x)));
         for (const auto &i : std::get<0>(x))
-            hasher.read((uint8_t*)&i, sizeof(dav::pg::node_idx_t) / sizeof(uint8_t));
+            hasher.read(static_cast<uint64_t>(i));
 
         return hasher.hash();
     }
@@ -541,15 +553,15 @@ public:
     chain_enumerator_t(const proof_graph_t *g, node_idx_t pivot);
 
     void operator++();
-    bool end() const { return m_ft_iter == m_feats.end(); }
-    bool empty() const { return m_rules.empty(); }
+    bool end() const { return m_ft_iter == m_feats->end(); }
+    bool empty() const { return not m_rules or m_rules->empty(); }
 
     const node_idx_t& pivot() const { return m_pivot; }
     const conjunction_template_t& feature() const { return m_ft_iter->first; }
     const is_backward_t& is_backward() const { return m_ft_iter->second; }
     const std::vector<predicate_id_t>& predicates() const { return feature().pids; }
     const std::list<hypernode_t>& targets() const { return m_targets; }
-    const std::list<rule_id_t>& rules() const { return m_rules; }
+    const std::vector<rule_id_t>& rules() const { return *m_rules; }
 
 private:
     void enumerate();
@@ -557,11 +569,12 @@ private:
     const proof_graph_t *m_graph;
     node_idx_t m_pivot;
 
-    std::set<std::pair<conjunction_template_t, is_backward_t>> m_feats;
-    std::set<std::pair<conjunction_template_t, is_backward_t>>::const_iterator m_ft_iter;
+    /** Features of the predicate of the pivot, which are shared with the cache of KB. */
+    std::shared_ptr<const std::vector<kb::feature_t>> m_feats;
+    std::vector<kb::feature_t>::const_iterator m_ft_iter;
 
     std::list<hypernode_t> m_targets;
-    std::list<rule_id_t> m_rules;
+    std::shared_ptr<const std::vector<rule_id_t>> m_rules;
 };
 
 
@@ -599,6 +612,47 @@ private:
 };
 
 
+/**
+* @brief Index from (predicate, argument position, term) to nodes.
+* @details
+*   This is used to narrow the candidates of property checks in exclusion_finder_t
+*   to nodes whose arguments can be unified with the given terms.
+*   Since nodes are added in ascending order of their indices, every list here is sorted.
+*/
+class argument_index_t
+{
+public:
+    void add(const node_t&);
+
+    /** Gets all nodes of predicate `pid` in ascending order. */
+    const std::vector<node_idx_t>& get(predicate_id_t pid) const;
+
+    /**
+    * @brief Gets nodes of predicate `pid` whose `i`-th argument is unifiable with `t`.
+    * @param[in]  max Upper bound of indices of nodes to get.
+    * @param[out] out Indices of nodes found, in ascending order.
+    */
+    void get(predicate_id_t pid, term_idx_t i, const term_t &t, node_idx_t max, std::vector<node_idx_t> *out) const;
+
+private:
+    /** Nodes indexed by one argument position. */
+    struct slot_t
+    {
+        std::unordered_map<term_t, std::vector<node_idx_t>> constants;
+        std::vector<node_idx_t> variables; /// Nodes whose argument is a variable which is not universally quantified.
+        std::vector<node_idx_t> unifiable; /// Nodes whose argument is not universally quantified.
+    };
+
+    struct entry_t
+    {
+        std::vector<node_idx_t> nodes;
+        std::vector<slot_t> slots;
+    };
+
+    std::unordered_map<predicate_id_t, entry_t> m_entries;
+};
+
+
 /** Class to enumerate exclusions related with the given node. */
 class exclusion_finder_t
 {
@@ -608,6 +662,12 @@ public:
     /** Returns iff any exclusion for the given node is found. */
     void run_for_node(node_idx_t ni) const;
 
+    /**
+    * @brief Does the same as run_for_node(ni), where the negation of the node's predicate is given.
+    * @details This does not look up predicate_library_t for the negation, which needs its lock.
+    */
+    void run_for_node(node_idx_t ni, predicate_id_t pid_neg) const;
+
     /** Returns iff any exclusion for the given edge is found. */
     void run_for_edge(edge_idx_t ei) const;
 
@@ -615,7 +675,7 @@ protected:
     virtual const proof_graph_t* graph() const = 0;
 
     virtual const node_t& get(node_idx_t) const = 0;
-    virtual const hash_set_t<node_idx_t>& pid2nodes(predicate_id_t) const = 0;
+    virtual const argument_index_t& arg2nodes() const = 0;
 
     virtual rule_id_t rid_of(edge_idx_t) const = 0;
     virtual conjunction_t tail_of(edge_idx_t) const = 0;
@@ -634,6 +694,17 @@ protected:
         const conjunction_t &tail1, const conjunction_t &head1,
         const conjunction_t &tail2, const conjunction_t &head2) const = 0;
 
+    /**
+    * @brief Gets nodes of predicate `pid` whose arguments are unifiable with the terms given.
+    * @param conds Pairs of an argument position and a term which the argument must be unifiable with.
+    * @param max   Upper bound of indices of nodes to get.
+    * @return Indices of nodes found, in ascending order.
+    */
+    std::vector<node_idx_t> candidates(
+        predicate_id_t pid,
+        const std::initializer_list<std::pair<term_idx_t, term_t>> &conds,
+        node_idx_t max) const;
+
     const term_cluster_t &m_tc;
 };
 
@@ -642,13 +713,27 @@ protected:
 class exclusion_generator_t : public exclusion_finder_t
 {
 public:
-    exclusion_generator_t(proof_graph_t*);
+    /** An exclusion found and indices of nodes or edges which its matcher targets. */
+    struct product_t
+    {
+        exclusion_t exclusion;
+        bool is_for_edge;
+        std::vector<index_t> targets;
+    };
+    typedef std::vector<product_t> queue_t;
+
+    /**
+    * @param g Proof-graph to find exclusions in.
+    * @param q If given, exclusions found are pushed to `q` instead of being added to `g`.
+    *          Then this only reads `g`, so that several generators can work on it concurrently.
+    */
+    exclusion_generator_t(proof_graph_t *g, queue_t *q = nullptr);
 
 private:
     virtual const proof_graph_t* graph() const override { return m_graph; }
 
     virtual const node_t& get(node_idx_t) const override;
-    virtual const hash_set_t<node_idx_t>& pid2nodes(predicate_id_t) const override;
+    virtual const argument_index_t& arg2nodes() const override;
 
     virtual rule_id_t rid_of(edge_idx_t) const override;
     virtual conjunction_t tail_of(edge_idx_t) const override;
@@ -668,6 +753,7 @@ private:
         const conjunction_t&, const conjunction_t &) const override;
 
     proof_graph_t *m_graph;
+    queue_t *m_queue;
 };
 
 
@@ -678,7 +764,12 @@ class proof_graph_t
 {        
 public:
 	proof_graph_t();
-    proof_graph_t(const problem_t&);
+
+    /**
+    * @param prob The problem whose observations are added to this.
+    * @param pool Workers to find exclusions concurrently, or null to find them sequentially.
+    */
+    proof_graph_t(const problem_t &prob, task_pool_t *pool = nullptr);
 
     proof_graph_t(const proof_graph_t&) = delete;
     proof_graph_t& operator=(const proof_graph_t&) = delete;
@@ -724,6 +815,9 @@ public:
     /** Returns whether `--unify-unobserved` option is activated. */
     bool do_unify_redundant_unobserved_terms() const { return m_do_unify_unobserved; }
 
+    /** Returns the total time taken to find exclusions in this proof-graph. */
+    time_t exclusion_time() const { return m_exclusion_time; }
+
 	/** Class to manage nodes in a proof-graph. */
 	class nodes_t : public std::deque<node_t>
 	{
@@ -758,7 +852,8 @@ public:
 		hash_multimap_t<term_t, node_idx_t>         term2nodes;
 		hash_multimap_t<node_type_e, node_idx_t>    type2nodes;
 		hash_multimap_t<depth_t, node_idx_t>        depth2nodes;
-		hash_multimap_t<atom_t, node_idx_t>         atom2nodes;
+		interned_map_t<atom_t, hash_set_t<node_idx_t>> atom2nodes;
+        argument_index_t                            arg2nodes;
 
         /**
         * Map from a node to elements that are needed to exist when the node exists.
@@ -831,13 +926,13 @@ public:
 	} edges;
 
     /** Manager of exclusions in a proof-graph. */
-    class exclusions_t : public std::unordered_set<exclusion_t>
+    class exclusions_t : public std::deque<exclusion_t>
     {
     public:
         /** Class to judge whether a proof-graph violates an exclusion or not. */
         struct matcher_t
         {
-            matcher_t(const exclusion_t&, const std::initializer_list<index_t>&);
+            matcher_t(const exclusion_t&, const std::vector<index_t>&);
             bool match(const std::unordered_set<index_t>&, const term_cluster_t&) const;
 
             const exclusion_t &exclusion;
@@ -851,13 +946,13 @@ public:
 
         void make_exclusions_from(const chainer_t &ch);
 
-        void add_node_matcher(const exclusion_t&, const std::initializer_list<node_idx_t>&);
-        void add_edge_matcher(const exclusion_t&, const std::initializer_list<edge_idx_t>&);
+        void add_node_matcher(const exclusion_t&, const std::vector<node_idx_t>&);
+        void add_edge_matcher(const exclusion_t&, const std::vector<edge_idx_t>&);
 
-        inline const exclusion_t& at(size_t i) const { return *m_ptrs.at(i); }
+        /** Adds exclusions which exclusion_generator_t has pushed to `q`, in order. */
+        void merge(const exclusion_generator_t::queue_t &q);
 
         hash_multimap_t<rule_id_t, const exclusion_t*> rid2excs;
-        hash_multimap_t<atom_t, const exclusion_t*> pid2excs;
 
         std::deque<matcher_t> matchers;
         hash_multimap_t<node_idx_t, matcher_idx_t> node2matchers;
@@ -865,33 +960,72 @@ public:
 
     private:
         proof_graph_t *m_master;
-        std::deque<const exclusion_t*> m_ptrs;
+
+        /** Map from IDs of conjunctions in proof_graph_t::conjunctions to exclusions which have them. */
+        hash_multimap_t<conjunction_id_t, exclusion_idx_t> m_conj2excs;
     } excs;
 
-    /** Class to manage operators which are reserved. */
+    /**
+    * @brief Class to manage operators which are reserved.
+    * @details
+    *   Keys are IDs of conditions of operators in proof_graph_t::conjunctions.
+    *   Each reservation is indexed by the conditions which it is waiting on,
+    *   so that extract() checks only reservations woken by new nodes since the last call.
+    */
     class reservations_t
-        : public std::unordered_map<conjunction_t, std::list<operator_ptr_t>>
+        : public std::map<conjunction_id_t, std::list<operator_ptr_t>>
     {
     public:
-        reservations_t(proof_graph_t *m) : m_master(m) {}
+        reservations_t(proof_graph_t *m) : m_master(m), m_num_hits(0), m_num_misses(0) {}
 
         void add(operator_ptr_t);
 
+        /**
+        * @brief Wakes reservations which can be satisfied owing to the node added newly.
+        * @details Call this after the node has been registered to the term-cluster.
+        */
+        void notify(node_idx_t);
+
         /** Returns operators which LHS can satisfy its condition and removes them from this. */
         std::list<std::unique_ptr<operator_t>> extract();
 
+        /** Returns the number of reservations which were woken and satisfied their conditions. */
+        size_t num_hits() const { return m_num_hits; }
+
+        /** Returns the number of reservations which were woken but did not satisfy their conditions yet. */
+        size_t num_misses() const { return m_num_misses; }
+
     private:
+        void wake(const std::vector<conjunction_id_t>&);
+
         proof_graph_t *m_master;
+
+        hash_map_t<term_t, std::vector<conjunction_id_t>> m_term2conjs;         /// Reservations waiting on equalities of each term.
+        hash_map_t<predicate_id_t, std::vector<conjunction_id_t>> m_pid2conjs; /// Reservations waiting on atoms of each predicate.
+        std::set<conjunction_id_t> m_woken; /// Reservations to be checked by extract().
+
+        size_t m_num_hits, m_num_misses;
     } reservations;
 
     term_cluster_t term_cluster;
 
+    /** Table which gives each distinct conjunction in exclusions and reservations a dense ID. */
+    intern_table_t<conjunction_t> conjunctions;
+
 private:
     problem_t m_prob;
     std::unordered_set<operation_summary_t> m_operations_applied;
 
     bool m_do_unify_unobserved;
     bool m_do_clean_unused_hash;
+
+    /** Finds exclusions for new nodes and a new edge, and adds them to this. */
+    void generate_exclusions(hypernode_idx_t head, edge_idx_t ei);
+
+    time_t m_exclusion_time;
+
+    /** Workers to find exclusions concurrently, which this does not own. Null if exclusions are found sequentially. */
+    task_pool_t *m_exclusion_pool;
 };
 
 
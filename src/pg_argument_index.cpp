@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <iterator>
+
+#include "./pg.h"
+
+namespace dav
+{
+
+namespace pg
+{
+
+
+void argument_index_t::add(const node_t &n)
+{
+    entry_t &e = m_entries[n.pid()];
+
+    assert(e.nodes.empty() or e.nodes.back() < n.index());
+    e.nodes.push_back(n.index());
+
+    if (e.slots.size() < static_cast<size_t>(n.arity()))
+        e.slots.resize(n.arity());
+
+    for (term_idx_t i = 0; i < n.arity(); ++i)
+    {
+        const term_t &t = n.term(i);
+        slot_t &s = e.slots.at(i);
+
+        if (t.is_universally_quantified())
+            continue;
+
+        if (t.is_constant())
+            s.constants[t].push_back(n.index());
+        else
+            s.variables.push_back(n.index());
+
+        s.unifiable.push_back(n.index());
+    }
+}
+
+
+const std::vector<node_idx_t>& argument_index_t::get(predicate_id_t pid) const
+{
+    static const std::vector<node_idx_t> empty;
+    auto found = m_entries.find(pid);
+    return (found == m_entries.end()) ? empty : found->second.nodes;
+}
+
+
+void argument_index_t::get(
+    predicate_id_t pid, term_idx_t i, const term_t &t, node_idx_t max,
+    std::vector<node_idx_t> *out) const
+{
+    out->clear();
+
+    // UNIVERSALLY QUANTIFIED TERMS ARE NOT UNIFIABLE WITH ANY TERM.
+    if (t.is_universally_quantified()) return;
+
+    auto found = m_entries.find(pid);
+    if (found == m_entries.end() or found->second.slots.size() <= i) return;
+
+    const slot_t &s = found->second.slots.at(i);
+    auto upto = [max](const std::vector<node_idx_t> &v)
+    {
+        return std::upper_bound(v.begin(), v.end(), max);
+    };
+
+    if (t.is_variable())
+        out->assign(s.unifiable.begin(), upto(s.unifiable));
+    else
+    {
+        // A CONSTANT IS UNIFIABLE WITH ITSELF AND WITH VARIABLES.
+        auto found_c = s.constants.find(t);
+        if (found_c == s.constants.end())
+            out->assign(s.variables.begin(), upto(s.variables));
+        else
+        {
+            const auto &cs = found_c->second;
+            std::merge(
+                cs.begin(), upto(cs), s.variables.begin(), upto(s.variables),
+                std::back_inserter(*out));
+        }
+    }
+}
+
+
+}
+
+}
@@ -34,14 +34,10 @@ void chainer_t::construct()
         }
     }
 
-	rule_t &&r = kb::kb()->rules.get(rid());
-    std::unordered_set<atom_t> conds;
-
-	m_conj_out = r.hypothesis(is_backward());
-	m_conj_in  = r.evidence(is_backward());
+    m_side = kb::kb()->rules.side(rid(), is_backward());
 
     // GROUND TERMS
-    m_grounder.reset(new grounder_t(m_targets.conjunction(m_pg), m_conj_in));
+    m_grounder.reset(new grounder_t(m_targets.conjunction(m_pg), m_side->layout));
 
     // OPERATION IS NOT APPLICABLE IF THE GROUNDING WAS FAILED
     if (not m_grounder->good())
@@ -55,50 +51,42 @@ void chainer_t::construct()
     for (const auto &i : targets())
         m_depth = std::max<depth_t>(m_depth, m_pg->nodes.at(i).depth() + 1);
 
-    for (auto it = m_conj_in.begin(); it != m_conj_in.end();)
-    {
-        // MOVE ATOMS NEGATED AS FAILURE IN EVIDENCE SIDE TO HYPOTHESIS SIDE
-        if (it->naf())
-        {
-            m_conj_out.push_back(*it);
-            it = m_conj_in.erase(it);
-        }
+    // NAF-ATOMS IN EVIDENCE SIDE HAVE BEEN MOVED TO HYPOTHESIS SIDE ALREADY.
+    m_conj_out = m_side->hypothesis;
+    assert(m_targets.size() == m_side->evidence.size());
 
-        // INTERPRET EQUALITIES IN EVIDENCE SIDE AS CONDITIONS
-        else if (it->is_equality())
+    // INTERPRET EQUALITIES IN EVIDENCE SIDE AS CONDITIONS
+    std::unordered_set<atom_t> conds;
+    bool do_sort(false);
+
+    for (const auto &eq : m_side->equalities)
+    {
+        // CHECK IF THE ATOM HAS UNBOUND TERMS
+        bool do_have_unbound_term(false);
+        for (const auto &t : eq.terms())
         {
-            // CHECK IF THE ATOM HAS UNBOUND TERMS
-            bool do_have_unbound_term(false);
-            for (const auto &t : it->terms())
+            if (t.is_variable() and m_grounder->substitution().count(t) == 0)
             {
-                if (t.is_variable() and m_grounder->substitution().count(t) == 0)
-                {
-                    do_have_unbound_term = true;
-                    break;
-                }
+                do_have_unbound_term = true;
+                break;
             }
+        }
 
-            if (do_have_unbound_term)
-                m_conj_out.push_back(*it);
-            else
-            {
-                it->substitute(m_grounder->substitution());
-                conds.insert(*it);
-            }
-            it = m_conj_in.erase(it);
+        if (do_have_unbound_term)
+        {
+            m_conj_out.push_back(eq);
+            do_sort = true;
         }
         else
-            ++it;
+        {
+            atom_t a(eq);
+            a.substitute(m_grounder->substitution());
+            conds.insert(a);
+        }
     }
-    assert(m_targets.size() == m_conj_in.size());
 
-    for (auto &a : m_conj_out)
-    {
-        // CONVERT NAF ATOMS INTO TYPICAL NEGATED ATOMS
-        if (a.naf())
-            a = a.negate().negate();
-    }
-    m_conj_out.sort();
+    if (do_sort)
+        m_conj_out.sort();
 
     conds.insert(
         m_grounder->conditions().begin(),
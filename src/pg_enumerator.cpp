@@ -14,10 +14,9 @@ chain_enumerator_t::chain_enumerator_t(const proof_graph_t *g, node_idx_t pivot)
 	assert(m_pivot >= 0);
 
 	predicate_id_t pid = m_graph->nodes.at(m_pivot).pid();
-	const auto &&feats = kb::kb()->features.get(pid);
-	m_feats.insert(feats.begin(), feats.end());
-
-	m_ft_iter = m_feats.begin();
+	// FEATURES ARE SORTED AND UNIQUE, BECAUSE THEY ARE WRITTEN FROM std::set ON COMPILING.
+	m_feats = kb::kb()->features.get(pid);
+	m_ft_iter = m_feats->begin();
 	enumerate();
 
 	// IF THE FIRST ENUMERATION IS FAILED, REPEAT ENUMERATION UNTIL SOMETHING IS FOUND.
@@ -39,6 +38,7 @@ typedef index_t slot_index_t;
 
 void chain_enumerator_t::enumerate()
 {
+	tracer_t::span_t span("pg-enumerate");
 	m_targets.clear();
 
 	if (end()) return;
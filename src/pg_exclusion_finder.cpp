@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <iterator>
+
 #include "./pg.h"
 
 namespace dav
@@ -11,21 +14,41 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
 {
     const node_t &n1 = get(ni);
 
+    if (not n1.is_equality())
+        run_for_node(ni, n1.predicate().negate().pid());
+}
+
+
+void exclusion_finder_t::run_for_node(node_idx_t ni, predicate_id_t pid_neg) const
+{
+    const node_t &n1 = get(ni);
+
     if (n1.is_equality())
         return; // 等価関係に関する制約の列挙は別の処理で扱う
 
     auto pid_pos = n1.pid();
-    auto pid_neg = n1.predicate().negate().pid();
 
     auto *prp = plib()->find_property(pid_pos);
 
-    const std::unordered_set<node_idx_t> *ns_pos = &pid2nodes(pid_pos);
-    const std::unordered_set<node_idx_t> *ns_neg = &pid2nodes(pid_neg);
-
     // EXCLUSION FOR COUNTERPARTS
-    for (const auto &nj : (*ns_neg))
     {
-        if (n1.index() > nj)
+        std::vector<node_idx_t> nodes;
+        if (n1.arity() == 0)
+            nodes = candidates(pid_neg, {}, ni - 1);
+        else
+        {
+            nodes = candidates(pid_neg, { { 0, n1.term(0) } }, ni - 1);
+            for (term_idx_t i = 1; i < n1.arity() and not nodes.empty(); ++i)
+            {
+                auto &&c = candidates(pid_neg, { { i, n1.term(i) } }, ni - 1);
+                std::vector<node_idx_t> x;
+                std::set_intersection(
+                    nodes.begin(), nodes.end(), c.begin(), c.end(), std::back_inserter(x));
+                nodes.swap(x);
+            }
+        }
+
+        for (const auto &nj : nodes)
         {
             const auto &n2 = get(nj);
             conjunction_t conj{ n1, n2 };
@@ -46,33 +69,36 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
 
     auto generate_for_asymmetric = [&](const predicate_property_t::argument_property_t &pr)
     {
-        for (const auto &nj : (*ns_pos))
+        auto &&nodes = candidates(
+            pid_pos, { { pr.idx2, n1.term(pr.idx1) }, { pr.idx1, n1.term(pr.idx2) } }, ni - 1);
+
+        for (const auto &nj : nodes)
         {
-            if (nj < n1.index())
-            {
-                const auto &n2 = get(nj);
-                conjunction_t conj{ n1, n2 };
+            const auto &n2 = get(nj);
+            conjunction_t conj{ n1, n2 };
 
-                if (this->unify_terms(n1.term(pr.idx1), n2.term(pr.idx2), &conj) and
-                    this->unify_terms(n1.term(pr.idx2), n2.term(pr.idx1), &conj))
-                {
-                    make_exclusion_for_node(
-                        conj, EXCLUSION_ASYMMETRIC, { n1.index(), n2.index() });
-                }
+            if (this->unify_terms(n1.term(pr.idx1), n2.term(pr.idx2), &conj) and
+                this->unify_terms(n1.term(pr.idx2), n2.term(pr.idx1), &conj))
+            {
+                make_exclusion_for_node(
+                    conj, EXCLUSION_ASYMMETRIC, { n1.index(), n2.index() });
             }
         }
     };
 
     auto generate_for_transitivity = [&](const predicate_property_t::argument_property_t &pr, const node_t &np1, const node_t &np2)
     {
+        if (not np1.term(pr.idx2).is_unifiable_with(np2.term(pr.idx1))) return;
+
         conjunction_t conj{ np1, np2 };
         if (not this->unify_terms(np1.term(pr.idx2), np2.term(pr.idx1), &conj)) return;
 
         // THE CASE OF p(x,y) ^ p(y,z) ^ !p(x,z)
-        for (const auto &nk : (*ns_neg))
-        {
-            if (nk > ni) continue;
+        auto &&negs = candidates(
+            pid_neg, { { pr.idx1, np1.term(pr.idx1) }, { pr.idx2, np2.term(pr.idx2) } }, ni);
 
+        for (const auto &nk : negs)
+        {
             const auto &nn = get(nk);
             conjunction_t conj2(conj);
             conj2.push_back(nn);
@@ -88,9 +114,12 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
         if (prp->has(PRP_ASYMMETRIC, pr.idx1, pr.idx2))
         {
             // THE CASE OF p(x,y) ^ p(y,z) ^ p(z,x)
-            for (const auto &nk : (*ns_pos))
+            auto &&poss = candidates(
+                pid_pos, { { pr.idx2, np1.term(pr.idx1) }, { pr.idx1, np2.term(pr.idx2) } }, n1.index());
+
+            for (const auto &nk : poss)
             {
-                if (nk == np1.index() or nk == np2.index() or nk > n1.index())
+                if (nk == np1.index() or nk == np2.index())
                     continue;
 
                 const node_t &np3 = get(nk);
@@ -109,18 +138,21 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
     auto generate_for_transitivity_2 = [&](const predicate_property_t::argument_property_t &pr, const node_t &nn)
     {
         // CASE OF p(x,y) ^ p(y,z) ^ !p(x,z)
-        for (const auto &nj : (*ns_pos))
-        {
-            if (nj > nn.index()) continue;
+        auto &&nodes1 = candidates(pid_neg, { { pr.idx1, nn.term(pr.idx1) } }, nn.index());
 
+        for (const auto &nj : nodes1)
+        {
             const node_t &np1 = get(nj);
             conjunction_t conj1{ np1, nn };
             if (not this->unify_terms(np1.term(pr.idx1), nn.term(pr.idx1), &conj1))
                 continue;
 
-            for (const auto &nk : (*ns_pos))
+            auto &&nodes2 = candidates(
+                pid_neg, { { pr.idx1, np1.term(pr.idx2) }, { pr.idx2, nn.term(pr.idx2) } }, nn.index());
+
+            for (const auto &nk : nodes2)
             {
-                if (nk > nn.index() or nk == np1.index()) continue;
+                if (nk == np1.index()) continue;
 
                 const node_t &np2 = get(nk);
                 conjunction_t conj2(conj1);
@@ -138,15 +170,16 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
 
     auto generate_for_right_unique = [&](const predicate_property_t::argument_property_t &pr)
     {
-        for (const auto &nj : (*ns_pos))
-        {
-            if (nj >= n1.index()) continue;
+        auto &&nodes = candidates(pid_pos, { { pr.idx1, n1.term(pr.idx1) } }, ni - 1);
 
+        for (const auto &nj : nodes)
+        {
             const auto &n2 = get(nj);
-            conjunction_t conj{ n1, n2 };
             const term_t &t11(n1.term(pr.idx1)), &t12(n1.term(pr.idx2));
             const term_t &t21(n2.term(pr.idx1)), &t22(n2.term(pr.idx2));
+            if (t12 == t22) continue;
 
+            conjunction_t conj{ n1, n2 };
             if (unify_terms(t11, t21, &conj) and
                 dissociate_terms(t12, t22, &conj))
             {
@@ -158,15 +191,16 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
 
     auto generate_for_left_unique = [&](const predicate_property_t::argument_property_t &pr)
     {
-        for (const auto &nj : (*ns_pos))
-        {
-            if (nj >= n1.index()) continue;
+        auto &&nodes = candidates(pid_pos, { { pr.idx2, n1.term(pr.idx2) } }, ni - 1);
 
+        for (const auto &nj : nodes)
+        {
             const auto &n2 = get(nj);
-            conjunction_t conj{ n1, n2 };
             const term_t &t11(n1.term(pr.idx1)), &t12(n1.term(pr.idx2));
             const term_t &t21(n2.term(pr.idx1)), &t22(n2.term(pr.idx2));
+            if (t11 == t21) continue;
 
+            conjunction_t conj{ n1, n2 };
             if (unify_terms(t12, t22, &conj) and
                 dissociate_terms(t11, t21, &conj))
             {
@@ -211,14 +245,22 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
                 generate_for_asymmetric(pr);
                 break;
             case PRP_TRANSITIVE:
-                for (const auto &nj : (*ns_pos))
+            {
+                // ONLY NODES WHICH CAN BE CHAINED WITH n1 IN EITHER ORDER ARE WORTH TRYING.
+                auto &&prev = candidates(pid_pos, { { pr.idx1, n1.term(pr.idx2) } }, ni - 1);
+                auto &&next = candidates(pid_pos, { { pr.idx2, n1.term(pr.idx1) } }, ni - 1);
+                std::vector<node_idx_t> nodes;
+                std::set_union(
+                    prev.begin(), prev.end(), next.begin(), next.end(), std::back_inserter(nodes));
+
+                for (const auto &nj : nodes)
                 {
-                    if (nj >= ni) continue;
                     const auto &n2 = get(nj);
                     generate_for_transitivity(pr, n1, n2);
                     generate_for_transitivity(pr, n2, n1);
                 }
                 break;
+            }
             case PRP_RIGHT_UNIQUE:
                 generate_for_right_unique(pr);
                 break;
@@ -234,14 +276,12 @@ void exclusion_finder_t::run_for_node(node_idx_t ni) const
             generate_for_forall_quontification(a_fa);
 
     // 列挙漏れを防ぐため、否定述語に対する推移律も考慮する.
-    if (not ns_neg->empty())
+    if (not arg2nodes().get(pid_neg).empty())
     {
         prp = plib()->find_property(pid_neg);
 
         if (prp != nullptr)
         {
-            std::swap(ns_neg, ns_pos);
-
             for (const auto &pr : prp->properties())
             {
                 switch (pr.type)
@@ -285,8 +325,43 @@ void exclusion_finder_t::run_for_edge(edge_idx_t ei1) const
 
 
 
-exclusion_generator_t::exclusion_generator_t(proof_graph_t *g)
-    : exclusion_finder_t(g->term_cluster), m_graph(g)
+std::vector<node_idx_t> exclusion_finder_t::candidates(
+    predicate_id_t pid,
+    const std::initializer_list<std::pair<term_idx_t, term_t>> &conds,
+    node_idx_t max) const
+{
+    std::vector<node_idx_t> out, c, x;
+
+    if (conds.size() == 0)
+    {
+        const auto &all = arg2nodes().get(pid);
+        out.assign(all.begin(), std::upper_bound(all.begin(), all.end(), max));
+        return out;
+    }
+
+    for (auto it = conds.begin(); it != conds.end(); ++it)
+    {
+        if (it == conds.begin())
+            arg2nodes().get(pid, it->first, it->second, max, &out);
+        else
+        {
+            arg2nodes().get(pid, it->first, it->second, max, &c);
+            x.clear();
+            std::set_intersection(
+                out.begin(), out.end(), c.begin(), c.end(), std::back_inserter(x));
+            out.swap(x);
+        }
+
+        if (out.empty()) break;
+    }
+
+    return out;
+}
+
+
+
+exclusion_generator_t::exclusion_generator_t(proof_graph_t *g, queue_t *q)
+    : exclusion_finder_t(g->term_cluster), m_graph(g), m_queue(q)
 {}
 
 
@@ -296,9 +371,9 @@ const node_t& exclusion_generator_t::get(node_idx_t ni) const
 }
 
 
-const hash_set_t<node_idx_t>& exclusion_generator_t::pid2nodes(predicate_id_t pid) const
+const argument_index_t& exclusion_generator_t::arg2nodes() const
 {
-    return m_graph->nodes.pid2nodes.get(pid);
+    return m_graph->nodes.arg2nodes;
 }
 
 
@@ -358,6 +433,12 @@ void exclusion_generator_t::make_exclusion_for_node(
     const conjunction_t &conj, exclusion_type_e type,
     const std::initializer_list<node_idx_t> &nodes) const
 {
+    if (m_queue != nullptr)
+    {
+        m_queue->push_back(product_t{ exclusion_t(conj, type), false, nodes });
+        return;
+    }
+
     exclusion_idx_t ei = m_graph->excs.add(exclusion_t(conj, type));
     m_graph->excs.add_node_matcher(m_graph->excs.at(ei), nodes);
 }
@@ -399,6 +480,12 @@ void exclusion_generator_t::make_exclusion_for_edge(
     conj.uniq();
 
     /* tail1 と tail2 が一致する時, head1 と head2 は同時に真にはなれない. */
+    if (m_queue != nullptr)
+    {
+        m_queue->push_back(product_t{ exclusion_t(conj, EXCLUSION_RULE_CLASS), true, { ei1, ei2 } });
+        return;
+    }
+
     auto exi = m_graph->excs.add(exclusion_t(conj, EXCLUSION_RULE_CLASS));
     m_graph->excs.add_edge_matcher(m_graph->excs.at(exi), { ei1, ei2 });
 }
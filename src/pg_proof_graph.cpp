@@ -12,15 +12,17 @@ namespace pg
 proof_graph_t::proof_graph_t()
     : nodes(this), edges(this), hypernodes(this), excs(this), reservations(this),
     m_do_clean_unused_hash(param()->has("clean-unused")),
-    m_do_unify_unobserved(param()->has("unify-unobserved"))
+    m_do_unify_unobserved(param()->has("unify-unobserved")),
+    m_exclusion_time(0.0), m_exclusion_pool(nullptr)
 {}
 
 
-proof_graph_t::proof_graph_t(const problem_t &prob)
+proof_graph_t::proof_graph_t(const problem_t &prob, task_pool_t *pool)
     : nodes(this), edges(this), hypernodes(this), excs(this),
     reservations(this), m_prob(prob),
     m_do_clean_unused_hash(param()->has("clean-unused")),
-	m_do_unify_unobserved(param()->has("unify-unobserved"))
+	m_do_unify_unobserved(param()->has("unify-unobserved")),
+    m_exclusion_time(0.0), m_exclusion_pool(pool)
 {
     add(m_prob.queries, NODE_OBSERVABLE, 0, true);
 
@@ -54,6 +56,9 @@ hypernode_idx_t proof_graph_t::add(
         if (nodes.at(n).pid() == PID_EQ)
             term_cluster.add(nodes.at(n));
 
+    for (const auto &n : hn)
+        reservations.notify(n);
+
     return idx;
 }
 
@@ -74,7 +79,7 @@ const hypernode_t& proof_graph_t::get_facts() const
 
 bool proof_graph_t::do_contain(const atom_t &a) const
 {
-    return nodes.atom2nodes.count(a) > 0;
+    return nodes.atom2nodes.has_key(a);
 }
 
 
@@ -113,6 +118,7 @@ bool proof_graph_t::can_satisfy(const atom_t &a) const
 
 edge_idx_t proof_graph_t::apply(operator_ptr_t opr)
 {
+    tracer_t::span_t span("pg-apply");
     if (not opr->applicable()) return -1;
     if (not opr->valid()) return -1;
 
@@ -175,15 +181,60 @@ edge_idx_t proof_graph_t::apply(operator_ptr_t opr)
     }
 
     // GENERATE EXCLUSIONS
-    exclusion_generator_t eg(this);
-    for (const auto &ni : hypernodes.get(head))
-        eg.run_for_node(ni);
-    eg.run_for_edge(ei);
+    time_watcher_t tw;
+    generate_exclusions(head, ei);
+    m_exclusion_time += tw.duration();
 
     return ei;
 }
 
 
+void proof_graph_t::generate_exclusions(hypernode_idx_t head, edge_idx_t ei)
+{
+    const auto &hn = hypernodes.get(head);
+
+    if (not m_exclusion_pool or hn.empty())
+    {
+        exclusion_generator_t eg(this);
+        for (const auto &ni : hn)
+            eg.run_for_node(ni);
+        eg.run_for_edge(ei);
+        return;
+    }
+
+    // WORKERS ONLY READ THIS GRAPH AND PUSH EXCLUSIONS TO THEIR OWN QUEUES.
+    std::vector<exclusion_generator_t::queue_t> queues(hn.size() + 1);
+
+    // NEGATED PREDICATES ARE REGISTERED HERE, SO THAT WORKERS DO NOT LOCK predicate_library_t.
+    std::vector<predicate_id_t> negs(hn.size(), PID_INVALID);
+    for (size_t i = 0; i < hn.size(); ++i)
+    {
+        const node_t &n = nodes.at(hn.at(i));
+        if (not n.is_equality())
+            negs[i] = n.predicate().negate().pid();
+    }
+
+    // THE POOL IS SHARED WITH OTHER PROOF-GRAPHS, SO THAT ONLY THE TASKS OF THIS CALL ARE WAITED FOR.
+    task_pool_t::group_t group(m_exclusion_pool);
+
+    for (size_t i = 0; i < hn.size(); ++i)
+    {
+        node_idx_t ni = hn.at(i);
+        predicate_id_t neg = negs.at(i);
+        exclusion_generator_t::queue_t *q = &queues.at(i);
+        group.push([this, ni, neg, q]() { exclusion_generator_t(this, q).run_for_node(ni, neg); });
+    }
+
+    // run_for_edge() READS THE KNOWLEDGE-BASE, SO IT IS DONE ON THIS THREAD.
+    exclusion_generator_t(this, &queues.back()).run_for_edge(ei);
+    group.wait();
+
+    // MERGES THE QUEUES IN THE SAME ORDER AS THE SEQUENTIAL MODE, SO THAT THE OUTPUT IS IDENTICAL.
+    for (const auto &q : queues)
+        excs.merge(q);
+}
+
+
 edge_idx_t proof_graph_t::apply(const chainer_t &c)
 {
     auto out = apply(operator_ptr_t(new chainer_t(c)));
@@ -362,10 +413,14 @@ node_idx_t proof_graph_t::nodes_t::add(
     for (const auto &t : atom.terms())
         term2nodes[t].insert(idx);
 
+    atom_id_t ai = atom2nodes.add(atom);
+    atom2nodes.value(ai).insert(idx);
+    back().aid() = ai;
+
     pid2nodes[atom.pid()].insert(idx);
     type2nodes[type].insert(idx);
     depth2nodes[depth].insert(idx);
-    atom2nodes[atom].insert(idx);
+    arg2nodes.add(back());
     evidence[idx].nodes.explained.insert(idx);
 
     return idx;
@@ -491,19 +546,23 @@ is_query_side_t proof_graph_t::edges_t::is_query_side_at(edge_idx_t i) const
 
 exclusion_idx_t proof_graph_t::exclusions_t::add(exclusion_t e)
 {
-    e.index() = size();
-    auto it = insert(e);
+    conjunction_id_t ci = m_master->conjunctions.add(e);
 
-    if (it.second)
+    // EXCLUSIONS WITH THE SAME CONJUNCTION ARE DISTINGUISHED BY THEIR TYPES AND RULES.
+    for (const auto &i : m_conj2excs.get(ci))
     {
-        m_ptrs.push_back(&(*it.first));
-
-        rid2excs[e.rid()].insert(&(*it.first));
-        for (const auto &a : e)
-            pid2excs[a].insert(&(*it.first));
+        const exclusion_t &x = at(i);
+        if (x.type() == e.type() and x.rid() == e.rid())
+            return i;
     }
 
-    return it.first->index();
+    e.index() = size();
+    push_back(e);
+    m_conj2excs[ci].insert(e.index());
+
+    rid2excs[e.rid()].insert(&back());
+
+    return e.index();
 }
 
 
@@ -569,7 +628,7 @@ void proof_graph_t::exclusions_t::make_exclusions_from(const chainer_t &ch)
 
 
 void proof_graph_t::exclusions_t::add_node_matcher(
-    const exclusion_t &exc, const std::initializer_list<node_idx_t> &nodes)
+    const exclusion_t &exc, const std::vector<node_idx_t> &nodes)
 {
     matcher_t m(exc, nodes);
     matcher_idx_t mi = matchers.size();
@@ -581,7 +640,7 @@ void proof_graph_t::exclusions_t::add_node_matcher(
 
 
 void proof_graph_t::exclusions_t::add_edge_matcher(
-    const exclusion_t &exc, const std::initializer_list<edge_idx_t> &edges)
+    const exclusion_t &exc, const std::vector<edge_idx_t> &edges)
 {
     matcher_t m(exc, edges);
     matcher_idx_t mi = matchers.size();
@@ -592,9 +651,23 @@ void proof_graph_t::exclusions_t::add_edge_matcher(
 }
 
 
+void proof_graph_t::exclusions_t::merge(const exclusion_generator_t::queue_t &q)
+{
+    for (const auto &p : q)
+    {
+        exclusion_idx_t ei = add(p.exclusion);
+
+        if (p.is_for_edge)
+            add_edge_matcher(at(ei), p.targets);
+        else
+            add_node_matcher(at(ei), p.targets);
+    }
+}
+
+
 proof_graph_t::exclusions_t::matcher_t::matcher_t(
-    const exclusion_t &e, const std::initializer_list<index_t> &ns)
-    : exclusion(e), indices(ns)
+    const exclusion_t &e, const std::vector<index_t> &ns)
+    : exclusion(e), indices(ns.begin(), ns.end())
 {}
 
 
@@ -626,37 +699,105 @@ bool proof_graph_t::exclusions_t::matcher_t::match(
 void proof_graph_t::reservations_t::add(operator_ptr_t opr)
 {
     conjunction_t conj(opr->conditions().begin(), opr->conditions().end());
-    auto &list = (*this)[conj];
+    conjunction_id_t ci = m_master->conjunctions.add(conj);
+    auto &list = (*this)[ci];
+
+    // INDEXES THE CONDITIONS ONLY WHEN THEY ARE RESERVED NEWLY.
+    // SATISFIED CONDITIONS ARE NOT INDEXED, BECAUSE THEY NEVER GET UNSATISFIED.
+    if (list.empty())
+    {
+        for (const auto &a : m_master->conjunctions.at(ci))
+        {
+            if (m_master->can_satisfy(a)) continue;
+
+            if (a.pid() == PID_EQ)
+            {
+                m_term2conjs[a.term(0)].push_back(ci);
+                m_term2conjs[a.term(1)].push_back(ci);
+            }
+            else
+                m_pid2conjs[a.pid()].push_back(ci);
+        }
+    }
 
     list.push_back(operator_ptr_t(std::move(opr)));
 }
 
 
+void proof_graph_t::reservations_t::notify(node_idx_t ni)
+{
+    if (empty()) return;
+
+    const node_t &n = m_master->nodes.at(ni);
+
+    if (n.pid() == PID_EQ)
+    {
+        // TERMS WHICH HAVE JOINED THE CLUSTER NEWLY CAN BE UNIFIED WITH ANY TERM IN IT.
+        const auto *cluster = m_master->term_cluster.find(n.term(0));
+        if (cluster == nullptr) return;
+
+        if (cluster->size() < m_term2conjs.size())
+        {
+            for (const auto &t : (*cluster))
+            {
+                auto found = m_term2conjs.find(t);
+                if (found != m_term2conjs.end())
+                    wake(found->second);
+            }
+        }
+        else
+        {
+            for (const auto &p : m_term2conjs)
+                if (cluster->count(p.first) > 0)
+                    wake(p.second);
+        }
+    }
+    else
+    {
+        auto found = m_pid2conjs.find(n.pid());
+        if (found != m_pid2conjs.end())
+            wake(found->second);
+    }
+}
+
+
+void proof_graph_t::reservations_t::wake(const std::vector<conjunction_id_t> &cs)
+{
+    m_woken.insert(cs.begin(), cs.end());
+}
+
+
 std::list<std::unique_ptr<operator_t>> proof_graph_t::reservations_t::extract()
 {
-    const term_cluster_t &tc = m_master->term_cluster;
     std::list<std::unique_ptr<operator_t>> out;
-    std::list<conjunction_t> removed;
 
-    for (auto &p : (*this))
+    // RESERVATIONS ARE CHECKED IN THE ORDER OF IDS, AS THE ORDER OF THIS MAP.
+    for (const auto &ci : m_woken)
     {
+        auto it = find(ci);
+        if (it == end()) continue; // ALREADY EXTRACTED.
+
         bool do_satisfy(true);
-        for (const auto &a : p.first)
+        for (const auto &a : m_master->conjunctions.at(ci))
         {
             if (not m_master->can_satisfy(a))
+            {
                 do_satisfy = false;
+                break;
+            }
         }
 
         if (do_satisfy)
         {
-            for (auto &opr : p.second)
+            for (auto &opr : it->second)
                 out.push_back(std::unique_ptr<operator_t>(std::move(opr)));
-            removed.push_back(p.first);
+            erase(it);
+            ++m_num_hits;
         }
+        else
+            ++m_num_misses;
     }
-
-    for (const auto &c : removed)
-        erase(c);
+    m_woken.clear();
 
     return out;
 }
@@ -7,7 +7,7 @@ namespace dav
 
 
 ilp_solver_t::ilp_solver_t(const kernel_t *m)
-    : component_t(m, param()->gett("timeout-sol", -1.0))
+    : component_t(m, param()->gett("timeout-sol", -1.0)), m_is_cancelled(false)
 #ifdef _OPENWBO_TIME
       , sat_cnv_time(0)
 #endif
@@ -26,11 +26,30 @@ void ilp_solver_t::process()
     assert(prob);
 
     out.clear();
+    m_is_cancelled = false;
     prob->set_const_with_parameter();
     solve(prob);
 }
 
 
+void ilp_solver_t::run_on(std::shared_ptr<ilp::problem_t> prob)
+{
+    timer.reset(new time_watcher_t(m_timeout));
+    out.clear();
+    solve(prob);
+    timer->stop();
+}
+
+
+void ilp_solver_t::cancel()
+{
+    m_is_cancelled = true;
+
+    std::lock_guard<std::mutex> lock(m_mutex_interrupt);
+    interrupt();
+}
+
+
 ilp::constraint_t ilp_solver_t::prohibit(const std::shared_ptr<ilp::solution_t> &sol, int margin) const
 {
     ilp::constraint_t con("margin");
@@ -108,6 +127,7 @@ ilp_solver_library_t::ilp_solver_library_t()
     add("cbc-cpi", new sol::cbc_t::generator_t(true));
     add("cbc-kbest", new sol::cbc_k_best_t::generator_t(false));
     add("cbc-kbest-cpi", new sol::cbc_k_best_t::generator_t(true));
+    add("portfolio", new sol::portfolio_t::generator_t());
 }
 
 
@@ -3,9 +3,12 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <atomic>
 
 #include "./util.h"
 #include "./ilp.h"
+#include "./json.h"
 
 
 #ifdef USE_LPSOLVE
@@ -26,6 +29,7 @@
 #include <coin/OsiClpSolverInterface.hpp>
 class OsiClpSolverInterface;
 class OsiSolverInterface;
+class CbcModel;
 #endif
 
 
@@ -45,17 +49,37 @@ public:
 
     virtual void solve(std::shared_ptr<ilp::problem_t>) = 0;
 
+    /**
+    * @brief Solves the problem given, measuring the time as run() does.
+    * @details Unlike run(), this does not modify the problem, so that several solvers can share it.
+    */
+    void run_on(std::shared_ptr<ilp::problem_t>);
+
+    /**
+    * @brief Requests this solver to stop as soon as possible.
+    * @details This can be called from threads other than one which runs solve().
+    */
+    void cancel();
+
+    bool is_cancelled() const { return m_is_cancelled; }
+
     std::deque<std::shared_ptr<ilp::solution_t>> out; /// The ILP problem output.
 
 protected:
     virtual void process() override;
 
+    /** Interrupts the external solver if it is running. This is called by cancel(). */
+    virtual void interrupt() {}
+
     /** Returns a constraint to prohibit a similar explanation to given one. */
     ilp::constraint_t prohibit(const std::shared_ptr<ilp::solution_t>&, int) const;
 
     time_t time_left() const;
     ilp::solution_type_e optimality_of(const component_t*) const;
 
+    std::atomic<bool> m_is_cancelled;
+    mutable std::mutex m_mutex_interrupt; /// Mutex for the handle of the external solver running.
+
 #ifdef _OPENWBO_TIME
 public:
     time_t sat_cnv_time;
@@ -89,6 +113,59 @@ std::unordered_set<ilp::constraint_idx_t> split_violated_constraints(
     std::unordered_set<ilp::constraint_idx_t> *cons);
 
 
+/**
+* @brief Pool of initialized environments of an external solver.
+* @details
+*   Setting up an environment often costs more than solving a small problem,
+*   so environments are kept with their parameters applied and reused over problems.
+*   Each environment is leased to one thread at a time, so that concurrent solvers can share the pool.
+*/
+template <class T, class D = std::default_delete<T>> class environment_pool_t
+{
+public:
+    typedef std::unique_ptr<T, D> pointer_t;
+
+    environment_pool_t() : m_num_created(0), m_num_reused(0) {}
+
+    /**
+    * @brief Takes an environment from the pool.
+    * @param gen Function to make a new environment, which is called if the pool is empty.
+    */
+    template <class F> pointer_t acquire(F gen)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (not m_envs.empty())
+            {
+                pointer_t out(std::move(m_envs.back()));
+                m_envs.pop_back();
+                ++m_num_reused;
+                return out;
+            }
+        }
+
+        ++m_num_created;
+        return pointer_t(gen());
+    }
+
+    /** Gives back the environment to the pool. Its per-problem state must have been cleared. */
+    void release(pointer_t &&p)
+    {
+        if (not p) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_envs.push_back(std::move(p));
+    }
+
+    size_t num_created() const { return m_num_created; }
+    size_t num_reused() const { return m_num_reused; }
+
+private:
+    std::mutex m_mutex;
+    std::vector<pointer_t> m_envs;
+    std::atomic<size_t> m_num_created, m_num_reused;
+};
+
+
 /** A class of ilp-solver which does nothing. */
 class null_solver_t : public ilp_solver_t
 {
@@ -159,10 +236,13 @@ public:
     bool do_use_cpi() const { return m_do_use_cpi; }
 
 protected:
+    virtual void interrupt() override;
+
     class model_t
     {
     public:
         model_t(const gurobi_t *master, std::shared_ptr<ilp::problem_t> p);
+        ~model_t();
 
         void prepare();
         void optimize(std::deque<std::shared_ptr<ilp::solution_t>>*);
@@ -190,6 +270,12 @@ protected:
     int m_thread_num;
     bool m_do_output_log;
     bool m_do_use_cpi;
+
+#ifdef USE_GUROBI
+    GRBModel *m_running; /// The model being optimized now.
+
+    static environment_pool_t<GRBEnv> ms_envs;
+#endif
 };
 
 
@@ -241,14 +327,23 @@ public:
     bool do_use_cpi() const { return m_do_use_cpi; }
     double gap_limit() const { return m_gap_limit; }
 
-#ifdef USE_SCIP
 protected:
+    virtual void interrupt() override;
+
+#ifdef USE_SCIP
+    struct scip_deleter_t
+    {
+        void operator()(SCIP *p) const { SCIPfree(&p); }
+    };
+
     class model_t
     {
     public:
         model_t(const scip_t*, std::shared_ptr<ilp::problem_t>);
         ~model_t();
 
+        SCIP* scip() const { return m_scip; }
+
         SCIP_RETCODE initialize();
         SCIP_RETCODE add_constraint(const ilp::constraint_t&);
         SCIP_RETCODE solve(std::deque<std::shared_ptr<ilp::solution_t>> *out);
@@ -269,6 +364,12 @@ protected:
 
     bool m_do_use_cpi;
     double m_gap_limit;
+
+#ifdef USE_SCIP
+    SCIP *m_running; /// The SCIP instance solving now.
+
+    static environment_pool_t<SCIP, scip_deleter_t> ms_envs;
+#endif
 };
 
 /** A class of solver which outputs k-best solutions with SCIP. */
@@ -320,12 +421,15 @@ public:
     bool do_use_cpi() const { return m_do_use_cpi; }
     double gap_limit() const { return m_gap_limit; }
 
-#ifdef USE_CBC
 protected:
+    virtual void interrupt() override;
+
+#ifdef USE_CBC
     class model_t
     {
     public:
         model_t(const cbc_t*, std::shared_ptr<ilp::problem_t>);
+        ~model_t();
         void initialize();
         void solve(std::deque<std::shared_ptr<ilp::solution_t>> *out);
         void add_constraint(const ilp::constraint_t&);
@@ -342,6 +446,12 @@ protected:
 
     bool m_do_use_cpi;
     double m_gap_limit;
+
+#ifdef USE_CBC
+    mutable CbcModel *m_running; /// The model solving now.
+
+    static environment_pool_t<OsiClpSolverInterface> ms_envs;
+#endif
 };
 
 
@@ -371,6 +481,69 @@ private:
 };
 
 
+/**
+* @brief A class of solver which runs several solvers concurrently on the same problem.
+* @details
+*   The first solver to prove the optimality of its solution wins, and the others are cancelled.
+*   If no solver can prove it, the best solution among ones found until the timeout is adopted.
+*/
+class portfolio_t : public ilp_solver_t
+{
+public:
+    struct generator_t : public component_generator_t<kernel_t, ilp_solver_t>
+    {
+        virtual ilp_solver_t* operator()(const kernel_t*) const override;
+    };
+
+    /** JSON-decorator to write the result of the race for each solution. */
+    struct race_decorator_t : public json::decorator_t<ilp::solution_t>
+    {
+        race_decorator_t(const portfolio_t *p) : portfolio(p) {}
+        virtual void operator()(const ilp::solution_t&, json::object_writer_t&) const override;
+        const portfolio_t *portfolio;
+    };
+
+    portfolio_t(const kernel_t*);
+
+    virtual void validate() const override;
+    virtual void solve(std::shared_ptr<ilp::problem_t>) override;
+
+    virtual void write_json(json::object_writer_t&) const override;
+    virtual void decorate(json::kernel2json_t&) const override;
+    virtual bool do_keep_validity_on_timeout() const override { return true; }
+
+    /** Returns the key of the solver which won the last race. Empty if no one won. */
+    const string_t& winner() const { return m_winner; }
+
+protected:
+    virtual void interrupt() override;
+
+private:
+    /** A solver taking part in the race. */
+    struct entry_t
+    {
+        entry_t(const string_t &k) : key(k), time(0.0) {}
+
+        string_t key;
+        std::unique_ptr<ilp_solver_t> solver; /// Instance generated for the current race.
+        string_t state; /// State at the end of the race.
+        time_t time;    /// Time taken to finish.
+    };
+
+    /** Returns whether `e` has output some available solution. */
+    bool is_available(const entry_t &e) const;
+
+    /** Returns whether the solution of `x` is better than one of `y`. */
+    bool is_better(const entry_t &x, const entry_t &y) const;
+
+    std::deque<entry_t> m_entries;
+    string_t m_winner;
+    bool m_do_maximize;
+
+    mutable std::mutex m_mutex; /// Mutex for m_winner and the solvers running.
+};
+
+
 }
 
 }
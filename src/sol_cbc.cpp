@@ -20,6 +20,9 @@ namespace sol
 cbc_t::cbc_t(const kernel_t *ptr, bool cpi)
     : ilp_solver_t(ptr), m_do_use_cpi(cpi),
     m_gap_limit(param()->getf("gap-limit"))
+#ifdef USE_CBC
+    , m_running(nullptr)
+#endif
 {}
 
 
@@ -36,11 +39,22 @@ void cbc_t::solve(std::shared_ptr<ilp::problem_t> prob)
 #ifdef USE_CBC
     model_t m(this, prob);
     m.initialize();
+    LOG_DETAIL(format("CBC solver interfaces: %d created, %d reused",
+        (int)ms_envs.num_created(), (int)ms_envs.num_reused()));
     m.solve(&out);
 #endif
 }
 
 
+void cbc_t::interrupt()
+{
+#ifdef USE_CBC
+    if (m_running != nullptr)
+        m_running->sayEventHappened();
+#endif
+}
+
+
 void cbc_t::write_json(json::object_writer_t &wr) const
 {
     wr.write_field<string_t>("name", "cbc");
@@ -52,14 +66,28 @@ void cbc_t::write_json(json::object_writer_t &wr) const
 
 #ifdef USE_CBC
 
+environment_pool_t<OsiClpSolverInterface> cbc_t::ms_envs;
+
+
 cbc_t::model_t::model_t(const cbc_t *m, std::shared_ptr<ilp::problem_t> p)
     : m_master(m), m_prob(p)
 {}
 
 
+cbc_t::model_t::~model_t()
+{
+    if (m_solver)
+    {
+        // CLEARS THE PROBLEM AND THE WARM-START INFORMATION BEFORE THE NEXT USE.
+        m_solver->reset();
+        ms_envs.release(std::move(m_solver));
+    }
+}
+
+
 void cbc_t::model_t::initialize()
 {
-    m_solver.reset(new OsiClpSolverInterface());
+    m_solver = ms_envs.acquire([]() { return new OsiClpSolverInterface(); });
 
     // SETS OBJECTIVE FUNCTIONS.
     m_prob->do_maximize() ? m_solver->setObjSense(-1) : m_solver->setObjSense(1);
@@ -73,6 +101,7 @@ void cbc_t::model_t::initialize()
     }
 
     // ADDS CONSTRAINTS.
+    time_watcher_t tw;
     for (const auto &c : m_prob->cons)
     {
         if (m_master->do_use_cpi() and c.lazy())
@@ -80,6 +109,8 @@ void cbc_t::model_t::initialize()
         else
             add_constraint(c, m_solver.get());
     }
+    LOG_DETAIL(format("loaded %d constraints (%d nonzeros) into the model in %.3f seconds",
+        (int)m_prob->cons.size(), (int)m_prob->cons.matrix().nonzeros(), tw.duration()));
 
     // ADDS CONSTRAINTS FOR CONSTANTS.
     CoinBuild build;
@@ -108,9 +139,17 @@ void cbc_t::model_t::solve(std::deque<std::shared_ptr<ilp::solution_t>> *out)
         model.setAllowableFractionGap(m_master->gap_limit());
     model.initialSolve();
 
+    {
+        std::lock_guard<std::mutex> lock(m_master->m_mutex_interrupt);
+        m_master->m_running = &model;
+    }
+
     for (int epoch = 1; ; ++epoch)
     {
-        model.branchAndBound();
+        tracer_t::span_t span("sol-epoch");
+
+        if (not m_master->is_cancelled())
+            model.branchAndBound();
 
         // NOT FOUND ANY SOLUTION
         if (model.bestSolution() == NULL)
@@ -134,11 +173,11 @@ void cbc_t::model_t::solve(std::deque<std::shared_ptr<ilp::solution_t>> *out)
             LOG_DETAIL(format("violated %d lazy-constraints", violated.size()));
 
             // FOUND SOME SOLUTION
-            if (violated.empty() or m_master->has_timed_out())
+            if (violated.empty() or m_master->has_timed_out() or m_master->is_cancelled())
             {
                 ilp::solution_type_e type = ilp::SOL_OPTIMAL;
 
-                if (m_master->has_timed_out())
+                if (m_master->has_timed_out() or m_master->is_cancelled())
                 {
                     type =
                         m_master->do_keep_validity_on_timeout() ?
@@ -167,6 +206,9 @@ void cbc_t::model_t::solve(std::deque<std::shared_ptr<ilp::solution_t>> *out)
             }
         }
     }
+
+    std::lock_guard<std::mutex> lock(m_master->m_mutex_interrupt);
+    m_master->m_running = nullptr;
 }
 
 void cbc_t::model_t::add_constraint(const ilp::constraint_t &con)
@@ -179,14 +221,8 @@ void cbc_t::model_t::add_constraint(const ilp::constraint_t &con)
 
 void cbc_t::model_t::add_constraint(const ilp::constraint_t &con, OsiSolverInterface *solver)
 {
-    std::vector<int> column;
-    std::vector<double> element;
-
-    for (const auto &t : con.terms())
-    {
-        column.push_back(t.first);
-        element.push_back(t.second);
-    }
+    auto &&terms = con.terms();
+    std::vector<int> column(terms.variables(), terms.variables() + terms.size());
 
     double rowLower = -COIN_DBL_MAX;
     double rowUpper = COIN_DBL_MAX;
@@ -209,7 +245,7 @@ void cbc_t::model_t::add_constraint(const ilp::constraint_t &con, OsiSolverInter
     }
 
     CoinBuild build;
-    build.addRow(column.size(), &column[0], &element[0], rowLower, rowUpper);
+    build.addRow(column.size(), column.data(), terms.coefficients(), rowLower, rowUpper);
     solver->addRows(build);
 }
 
@@ -15,11 +15,19 @@ namespace sol
 {
 
 
+#ifdef USE_GUROBI
+environment_pool_t<GRBEnv> gurobi_t::ms_envs;
+#endif
+
+
 gurobi_t::gurobi_t(const kernel_t *ptr, bool cpi)
     : ilp_solver_t(ptr),
     m_thread_num(param()->thread_num()),
     m_do_output_log(param()->has("print-gurobi-log")),
     m_do_use_cpi(cpi)
+#ifdef USE_GUROBI
+    , m_running(nullptr)
+#endif
 {}
 
 
@@ -38,7 +46,27 @@ void gurobi_t::solve(std::shared_ptr<ilp::problem_t> prob)
     model_t m(this, prob);
 
     m.prepare();
-    m.optimize(&out);
+    LOG_DETAIL(format("Gurobi environments: %d created, %d reused",
+        (int)ms_envs.num_created(), (int)ms_envs.num_reused()));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_interrupt);
+        m_running = m.model.get();
+    }
+
+    if (not is_cancelled())
+        m.optimize(&out);
+
+    std::lock_guard<std::mutex> lock(m_mutex_interrupt);
+    m_running = nullptr;
+#endif
+}
+
+
+void gurobi_t::interrupt()
+{
+#ifdef USE_GUROBI
+    if (m_running != nullptr)
+        m_running->terminate();
 #endif
 }
 
@@ -59,15 +87,34 @@ gurobi_t::model_t::model_t(const gurobi_t *master, std::shared_ptr<ilp::problem_
 {}
 
 
+gurobi_t::model_t::~model_t()
+{
+#ifdef USE_GUROBI
+    // THE MODEL HAS ITS OWN COPY OF THE ENVIRONMENT, SO THE POOLED ONE KEEPS NO STATE OF THIS PROBLEM.
+    this->model.reset();
+    ms_envs.release(std::move(this->env));
+#endif
+}
+
+
 void gurobi_t::model_t::prepare()
 {
 #ifdef USE_GUROBI
-    this->env.reset(new GRBEnv());
+    const gurobi_t *g = m_gurobi;
+    this->env = ms_envs.acquire([g]()
+    {
+        GRBEnv *env = new GRBEnv();
+        env->set(GRB_IntParam_OutputFlag, (g->do_print_log() ? 1 : 0));
+        if (g->thread_num() > 1)
+            env->set(GRB_IntParam_Threads, g->thread_num());
+        return env;
+    });
     this->model.reset(new GRBModel(*this->env));
 
     for (const auto &v : this->prob->vars) add(v);
     this->model->update();
     
+    time_watcher_t tw;
     for (const auto &c : this->prob->cons)
     {
         if (m_gurobi->do_use_cpi() and c.lazy())
@@ -76,15 +123,12 @@ void gurobi_t::model_t::prepare()
             add(c);
     }
     this->model->update();
+    LOG_DETAIL(format("loaded %d constraints (%d nonzeros) into the model in %.3f seconds",
+        (int)this->prob->cons.size(), (int)this->prob->cons.matrix().nonzeros(), tw.duration()));
     
     this->model->set(
         GRB_IntAttr_ModelSense,
         (this->prob->do_maximize() ? GRB_MAXIMIZE : GRB_MINIMIZE));
-    this->model->getEnv().set(
-        GRB_IntParam_OutputFlag, (m_gurobi->do_print_log() ? 1 : 0));
-
-        if (m_gurobi->thread_num() > 1)
-            (this->model->getEnv().set(GRB_IntParam_Threads, m_gurobi->thread_num()));
 
         time_t t = m_gurobi->time_left();
         if (t > 0)
@@ -101,6 +145,7 @@ void gurobi_t::model_t::optimize(std::deque<std::shared_ptr<ilp::solution_t>> *o
 
     while (true)
     {
+        tracer_t::span_t span("sol-epoch");
         console_t::auto_indent_t ai;
         if (is_cpi_mode and console()->is(verboseness_e::ROUGH))
         {
@@ -149,7 +194,7 @@ void gurobi_t::model_t::optimize(std::deque<std::shared_ptr<ilp::solution_t>> *o
 
             LOG_DETAIL(format("violated %d lazy-constraints", violated.size()));
 
-            if (master()->has_timed_out() or violated.empty())
+            if (master()->has_timed_out() or master()->is_cancelled() or violated.empty())
             {
                 out->push_back(sol);
                 break;
@@ -30,6 +30,16 @@ void lp_handler(::lprec *lp, void *userhandle, char *buf)
             console()->print(s);
 }
 
+
+#ifdef _WIN32
+int __WINAPI lp_abort_handler(::lprec *lp, void *userhandle)
+#else
+int lp_abort_handler(::lprec *lp, void *userhandle)
+#endif
+{
+    return static_cast<const ilp_solver_t*>(userhandle)->is_cancelled() ? TRUE : FALSE;
+}
+
 #endif
 
 
@@ -109,6 +119,9 @@ void lp_solve_t::initialize(const ilp::problem_t *prob, ::lprec **rec) const
     if (m_do_output_log)
         ::put_logfunc(*rec, lp_handler, NULL);
 
+    // LETS cancel() ABORT THE SOLVER.
+    ::put_abortfunc(*rec, lp_abort_handler, const_cast<lp_solve_t*>(this));
+
     // SETS ALL VARIABLES TO INTEGER.
     for (size_t i = 1; i < vars.size(); ++i)
     {
@@ -117,8 +130,11 @@ void lp_solve_t::initialize(const ilp::problem_t *prob, ::lprec **rec) const
     }
 
     // ADDS CONSTRAINTS.
+    time_watcher_t tw;
     for (size_t i = 0; i < prob->cons.size(); ++i)
         add_constraint(prob, i, rec);
+    LOG_DETAIL(format("loaded %d constraints (%d nonzeros) into the model in %.3f seconds",
+        (int)prob->cons.size(), (int)prob->cons.matrix().nonzeros(), tw.duration()));
 
     // ADDS CONSTRAINTS FOR CONSTANTS.
     for (const auto &v : prob->vars)
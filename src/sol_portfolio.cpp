@@ -0,0 +1,212 @@
+#include <thread>
+
+#include "./kernel.h"
+#include "./sol.h"
+#include "./json.h"
+
+namespace dav
+{
+
+namespace sol
+{
+
+
+portfolio_t::portfolio_t(const kernel_t *m)
+    : ilp_solver_t(m), m_do_maximize(false)
+{
+    for (const auto &key : string_t(param()->get("portfolio", "gurobi,scip,cbc")).split(","))
+        if (not key.empty())
+            m_entries.push_back(entry_t(key));
+}
+
+
+void portfolio_t::validate() const
+{
+    if (m_entries.empty())
+        throw exception_t("Portfolio solver: no solver is specified with \"--portfolio\".");
+
+    for (const auto &e : m_entries)
+    {
+        if (e.key == "portfolio")
+            throw exception_t("Portfolio solver: cannot take part in the portfolio itself.");
+
+        // K-BEST SOLVERS ADD CONSTRAINTS TO THE PROBLEM, WHICH IS SHARED IN THE RACE.
+        if (e.key.endswith("kbest"))
+            throw exception_t(format(
+                "Portfolio solver: \"%s\" cannot share the problem with others.", e.key.c_str()));
+
+        std::unique_ptr<ilp_solver_t> solver(sol_lib()->generate(e.key, master()));
+        solver->validate();
+    }
+}
+
+
+void portfolio_t::solve(std::shared_ptr<ilp::problem_t> prob)
+{
+    m_winner.clear();
+    m_do_maximize = prob->do_maximize();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &e : m_entries)
+        {
+            e.solver.reset(sol_lib()->generate(e.key, master()));
+            e.state.clear();
+            e.time = 0.0;
+
+            // THE CANCELLATION MAY COME BEFORE THE SOLVERS ARE GENERATED.
+            if (is_cancelled())
+                e.solver->cancel();
+        }
+    }
+
+    auto run = [this, prob](entry_t *e)
+    {
+        try
+        {
+            e->solver->run_on(prob);
+            e->time = e->solver->timer->duration();
+        }
+        catch (const std::exception &ex)
+        {
+            e->state = format("failed: %s", ex.what());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bool is_proven =
+            not e->solver->has_timed_out() and
+            not e->solver->is_cancelled() and
+            is_available(*e) and
+            e->solver->out.front()->type() == ilp::SOL_OPTIMAL;
+
+        if (is_proven and m_winner.empty())
+        {
+            m_winner = e->key;
+            for (auto &e2 : m_entries)
+                if (&e2 != e) e2.solver->cancel();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto &e : m_entries)
+        threads.push_back(std::thread(run, &e));
+    for (auto &th : threads)
+        th.join();
+
+    // IF NO SOLVER HAS PROVEN THE OPTIMALITY, ADOPTS THE BEST ONE.
+    entry_t *best(nullptr);
+    for (auto &e : m_entries)
+    {
+        if (not e.state.empty()) continue;
+
+        if (m_winner.empty())
+        {
+            if (e.solver->out.empty()) continue;
+            if (best == nullptr or is_better(e, *best)) best = &e;
+        }
+        else if (e.key == m_winner)
+            best = &e;
+    }
+
+    for (auto &e : m_entries)
+    {
+        if (not e.state.empty()) continue;
+        if (&e == best)
+            e.state = m_winner.empty() ? "adopted" : "won";
+        else
+            e.state = e.solver->is_cancelled() ? "cancelled" : "finished";
+    }
+
+    if (best != nullptr)
+    {
+        out = std::move(best->solver->out);
+        LOG_MIDDLE(format("portfolio: adopted the solution of \"%s\" (%.3f seconds, %s)",
+            best->key.c_str(), best->time, best->state.c_str()));
+    }
+    else
+    {
+        ilp::value_assignment_t values(prob->vars.size(), 0.0);
+        out.push_back(std::make_shared<ilp::solution_t>(prob, values, ilp::SOL_NOT_AVAILABLE));
+        LOG_MIDDLE("portfolio: no solver has output any solution");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &e : m_entries)
+        e.solver.reset();
+}
+
+
+void portfolio_t::write_json(json::object_writer_t &wr) const
+{
+    std::vector<string_t> keys;
+    for (const auto &e : m_entries)
+        keys.push_back(e.key);
+
+    wr.write_field<string_t>("name", "portfolio");
+    wr.write_array_field<string_t>("members", keys.begin(), keys.end(), true);
+    ilp_solver_t::write_json(wr);
+}
+
+
+void portfolio_t::decorate(json::kernel2json_t &k2j) const
+{
+    k2j.sol2js->add_decorator(new race_decorator_t(this));
+}
+
+
+void portfolio_t::interrupt()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &e : m_entries)
+        if (e.solver) e.solver->cancel();
+}
+
+
+bool portfolio_t::is_available(const entry_t &e) const
+{
+    return
+        not e.solver->out.empty() and
+        e.solver->out.front()->type() != ilp::SOL_NOT_AVAILABLE;
+}
+
+
+bool portfolio_t::is_better(const entry_t &x, const entry_t &y) const
+{
+    bool ax = is_available(x), ay = is_available(y);
+    if (ax != ay) return ax;
+    if (not ax) return false;
+
+    double ox = x.solver->out.front()->objective_value();
+    double oy = y.solver->out.front()->objective_value();
+    return m_do_maximize ? (ox > oy) : (ox < oy);
+}
+
+
+void portfolio_t::race_decorator_t::operator()(
+    const ilp::solution_t&, json::object_writer_t &wr) const
+{
+    auto &&wr2 = wr.make_object_field_writer("portfolio", false);
+    wr2.write_field<string_t>("winner", portfolio->m_winner);
+
+    wr2.begin_object_array_field("members");
+    for (const auto &e : portfolio->m_entries)
+    {
+        auto &&wr3 = wr2.make_object_array_element_writer(true);
+        wr3.write_field<string_t>("key", e.key);
+        wr3.write_field<string_t>("state", e.state);
+        wr3.write_field<time_t>("time", e.time);
+    }
+    wr2.end_object_array_field();
+}
+
+
+ilp_solver_t* portfolio_t::generator_t::operator()(const kernel_t *m) const
+{
+    return new sol::portfolio_t(m);
+}
+
+
+}
+
+}
@@ -66,6 +66,9 @@ scip_t::scip_t(const kernel_t *ptr, bool cpi)
     : ilp_solver_t(ptr),
     m_do_use_cpi(cpi),
     m_gap_limit(param()->getf("gap-limit", -1.0))
+#ifdef USE_SCIP
+    , m_running(nullptr)
+#endif
 {}
 
 
@@ -73,7 +76,7 @@ scip_t::scip_t(const kernel_t *ptr, bool cpi)
 void scip_t::validate() const
 {
 #ifndef USE_SCIP
-    throw exception_t("SCIP is not avaialble.");
+    throw exception_t("SCIP is not available.");
 #endif
 }
 
@@ -91,7 +94,28 @@ void scip_t::solve(std::shared_ptr<ilp::problem_t> prob)
     };
 
     exe(m.initialize());
-    exe(m.solve(&out));
+    LOG_DETAIL(format("SCIP instances: %d created, %d reused",
+        (int)ms_envs.num_created(), (int)ms_envs.num_reused()));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_interrupt);
+        m_running = m.scip();
+    }
+
+    SCIP_RETCODE ret = is_cancelled() ? SCIP_OKAY : m.solve(&out);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_interrupt);
+        m_running = nullptr;
+    }
+    exe(ret);
+#endif
+}
+
+
+void scip_t::interrupt()
+{
+#ifdef USE_SCIP
+    if (m_running != nullptr)
+        SCIPinterruptSolve(m_running);
 #endif
 }
 
@@ -107,6 +131,9 @@ void scip_t::write_json(json::object_writer_t &wr) const
 
 #ifdef USE_SCIP
 
+environment_pool_t<SCIP, scip_t::scip_deleter_t> scip_t::ms_envs;
+
+
 scip_t::model_t::model_t(const scip_t *m, std::shared_ptr<ilp::problem_t> p)
     : m_master(m), m_prob(p), m_scip(nullptr)
 {}
@@ -122,18 +149,35 @@ scip_t::model_t::~model_t()
         for (auto &c : m_cons_list)
             SCIPreleaseCons(m_scip, &c);
 
-        SCIPfree(&m_scip);
+        // FREES THE PROBLEM ONLY, SO THAT THE INSTANCE CAN BE REUSED FOR THE NEXT PROBLEM.
+        if (SCIPfreeProb(m_scip) == SCIP_OKAY)
+            ms_envs.release(environment_pool_t<SCIP, scip_deleter_t>::pointer_t(m_scip));
+        else
+            SCIPfree(&m_scip);
     }
 }
 
 
 SCIP_RETCODE scip_t::model_t::initialize()
 {
-    SCIP_CALL(SCIPcreate(&m_scip));
-    SCIP_CALL(SCIPincludeDefaultPlugins(m_scip));
+    // TAKES AN INSTANCE WHOSE PLUGINS HAVE BEEN INCLUDED ALREADY.
+    m_scip = ms_envs.acquire([]() -> SCIP*
+    {
+        SCIP *scip(nullptr);
+        if (SCIPcreate(&scip) != SCIP_OKAY) return nullptr;
+        if (SCIPincludeDefaultPlugins(scip) != SCIP_OKAY)
+        {
+            SCIPfree(&scip);
+            return nullptr;
+        }
+
+        // SET LOG LEVEL
+        SCIPsetMessagehdlrQuiet(scip, true);
+        return scip;
+    }).release();
 
-    // SET LOG LEVEL
-    SCIPsetMessagehdlrQuiet(m_scip, true);
+    if (m_scip == nullptr)
+        return SCIP_ERROR;
 
     // CREATE EMPTY PROBLEM
     SCIP_CALL(SCIPcreateProbBasic(m_scip, "david"));
@@ -166,6 +210,7 @@ SCIP_RETCODE scip_t::model_t::initialize()
         SCIP_CALL(SCIPaddVar(m_scip, v));
 
     // ADDS CONSTRAINTS
+    time_watcher_t tw;
     for (const auto &c : m_prob->cons)
     {
         if (m_master->do_use_cpi() and c.lazy())
@@ -176,9 +221,13 @@ SCIP_RETCODE scip_t::model_t::initialize()
             if (ret <= 0) return ret; // ERROR!
         }
     }
+    LOG_DETAIL(format("loaded %d constraints (%d nonzeros) into the model in %.3f seconds",
+        (int)m_prob->cons.size(), (int)m_prob->cons.matrix().nonzeros(), tw.duration()));
 
     if (m_master->gap_limit() >= 0.0)
         SCIP_CALL(SCIPsetRealParam(m_scip, "limits/gap", m_master->gap_limit()));
+    else
+        SCIP_CALL(SCIPresetParam(m_scip, "limits/gap"));
 
     return SCIP_OKAY;
 }
@@ -210,6 +259,7 @@ SCIP_RETCODE scip_t::model_t::solve(std::deque<std::shared_ptr<ilp::solution_t>>
     bool do_use_cpi = (not m_lazy_cons.empty());
     for (int epoch = 1; ; ++epoch)
     {
+        tracer_t::span_t span("sol-epoch");
         console_t::auto_indent_t ai;
         if (do_use_cpi and console()->is(verboseness_e::ROUGH))
         {
@@ -243,7 +293,7 @@ SCIP_RETCODE scip_t::model_t::solve(std::deque<std::shared_ptr<ilp::solution_t>>
             LOG_DETAIL(format("violated %d lazy-constraints", violated.size()));
 
             // VIOLATED SOME CONSTRAINTS
-            if (not violated.empty() and not m_master->has_timed_out())
+            if (not violated.empty() and not m_master->has_timed_out() and not m_master->is_cancelled())
             {
                 SCIP_CALL(SCIPfreeTransform(m_scip));
                 for (const auto &ci : violated)
@@ -298,19 +348,17 @@ SCIP_RETCODE scip_t::model_t::add_constraint(const ilp::constraint_t &con)
         break;
     }
 
+    auto &&terms = con.terms();
     std::vector<SCIP_VAR*> vars;
-    std::vector<double> varCoefs;
+    vars.reserve(terms.size());
 
-    for(const auto &t : con.terms())
-    {
-        vars.push_back(m_vars_list.at(t.first));
-        varCoefs.push_back(t.second);
-    }
+    for (size_t i = 0; i < terms.size(); ++i)
+        vars.push_back(m_vars_list.at(terms.variables()[i]));
 
     SCIP_CONS* scipCons = NULL;
     SCIP_CALL(SCIPcreateConsLinear(
         m_scip, &scipCons, con.name().c_str(),
-        con.terms().size(), &vars[0], &varCoefs[0], rowLower, rowUpper,
+        terms.size(), vars.data(), const_cast<double*>(terms.coefficients()), rowLower, rowUpper,
         true,      // 'initial' parameter.
         true,      // 'separate' parameter.
         true,      // 'enforce' parameter.
@@ -164,12 +164,10 @@ void progress_bar_t::set(int n)
 
 void progress_bar_t::get(int *now, int *all) const
 {
-    if (m_thread)
-    {
-        std::lock_guard<std::mutex> lg(ms_mutex);
-        (*now) = m_now;
-        (*all) = m_all;
-    }
+    // THE THREAD MAY CALL THIS BEFORE m_thread IS SET, SO m_thread MUST NOT BE CHECKED HERE.
+    std::lock_guard<std::mutex> lg(ms_mutex);
+    (*now) = m_now;
+    (*all) = m_all;
 }
 
 
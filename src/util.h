@@ -25,6 +25,7 @@
 #include <vector>
 #include <deque>
 #include <list>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -33,6 +34,7 @@
 #include <exception>
 #include <thread>
 #include <condition_variable>
+#include <atomic>
 #include <queue>
 #include <climits>
 #include <algorithm>
@@ -336,7 +338,9 @@ public:
 
     static string_hash_t get_newest_unknown_hash();
 
-    string_hash_t() : m_hash(0) {}
+    string_hash_t()
+        : m_hash(0), m_is_constant(false), m_is_unknown(false),
+        m_is_hard_term(false), m_is_forall(false), m_is_number(false) {}
     string_hash_t(unsigned h);
     string_hash_t(const string_hash_t& h);
     string_hash_t(const std::string& s);
@@ -873,6 +877,236 @@ class exit_loop_t : public std::exception
 {};
 
 
+/**
+* @brief Pool of worker threads which execute tasks with work-stealing.
+* @details
+*   Each worker has its own deque of tasks.
+*   A worker pops tasks from the back of its own deque and,
+*   when it becomes empty, steals tasks from the front of the others' deques.
+*   Tasks pushed by a worker are added to the worker's own deque,
+*   so a task can split its work into sub-tasks cheaply.
+*/
+class task_pool_t
+{
+public:
+    typedef std::function<void()> task_t;
+
+    /**
+    * @brief Constructor, which launches worker threads.
+    * @param num The number of worker threads. Values less than 1 are regarded as 1.
+    */
+    task_pool_t(int num);
+
+    /** Destructor, which waits for all of the tasks and then stops workers. */
+    ~task_pool_t();
+
+    task_pool_t(const task_pool_t&) = delete;
+    task_pool_t& operator=(const task_pool_t&) = delete;
+
+    /** Adds a new task to the pool. */
+    void push(task_t task);
+
+    /**
+    * @brief Blocks until all of the tasks pushed so far have finished.
+    * @details
+    *   If some task threw an exception, this method rethrows the first one.
+    *   Do not call this method from tasks in this pool.
+    */
+    void wait();
+
+    /**
+    * @brief Set of tasks in a pool, which can be waited for apart from the other tasks.
+    * @details
+    *   When a pool is shared by several callers, each caller should push its tasks
+    *   through its own group, so that it does not wait for tasks of the others.
+    */
+    class group_t
+    {
+    public:
+        group_t(task_pool_t *pool) : m_pool(pool), m_num_pending(0) {}
+
+        /** Destructor, which waits for the tasks of this group. */
+        ~group_t();
+
+        group_t(const group_t&) = delete;
+        group_t& operator=(const group_t&) = delete;
+
+        /** Adds a new task to the pool as a member of this group. */
+        void push(task_t task);
+
+        /**
+        * @brief Blocks until all of the tasks in this group have finished.
+        * @details
+        *   If some task in this group threw an exception, this method rethrows the first one.
+        *   Do not call this method from tasks in the pool.
+        */
+        void wait();
+
+    private:
+        task_pool_t *m_pool;
+        size_t m_num_pending; /// The number of tasks in this group which have not finished.
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv_done;
+        std::exception_ptr m_exception;
+    };
+
+    /** Gets the number of worker threads. */
+    int thread_num() const { return static_cast<int>(m_threads.size()); }
+
+    /** Gets the index of the worker executing the current thread, or -1 if it is not a worker of this pool. */
+    int worker_index() const;
+
+private:
+    struct queue_t
+    {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    void work(int idx);
+    bool pop(int idx, task_t *out);
+    bool steal(int idx, task_t *out);
+
+    std::vector<std::unique_ptr<queue_t>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::atomic<size_t> m_num_queued;  /// The number of tasks waiting in queues.
+    std::atomic<size_t> m_num_pending; /// The number of tasks which have not finished.
+    std::atomic<size_t> m_num_pushed;  /// Counter to distribute tasks pushed from outside of workers.
+    bool m_is_terminating;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv_task, m_cv_done;
+    std::exception_ptr m_exception;
+};
+
+
+/**
+* @brief Recorder of hierarchical spans of processing, which is used to profile David in production.
+* @details
+*   Each thread records spans into its own buffer, so that threads do not contend on recording.
+*   Spans are aggregated into metrics (counts, total times and histograms of durations) per name.
+*   Events of spans can be also kept and exported in the Chrome trace-event format,
+*   in which spans on the same thread are shown hierarchically.
+*   Nothing is recorded until initialize() is called, in which case spans cost only a branch.
+*/
+class tracer_t
+{
+public:
+    typedef std::chrono::steady_clock clock_t;
+
+    /** Statistics of spans with the same name. */
+    struct metric_t
+    {
+        /** The number of buckets of histograms. */
+        static const int NUM_BUCKETS = 32;
+
+        metric_t();
+
+        void add(double usec);
+        void merge(const metric_t &x);
+
+        size_t count;
+        double total; /// The sum of durations in microseconds.
+        double max;   /// The maximum duration in microseconds.
+
+        /** The i-th bucket counts spans whose durations in microseconds are in [2^(i-1), 2^i). */
+        size_t histogram[NUM_BUCKETS];
+    };
+
+    /** RAII object which records a span from its construction to its destruction. */
+    class span_t
+    {
+    public:
+        /** @param name The name of the span, which must be a string literal. */
+        span_t(const char *name)
+            : m_name(ms_is_enabled ? name : nullptr)
+        {
+            if (m_name) m_begin = clock_t::now();
+        }
+
+        ~span_t()
+        {
+            if (m_name) instance()->record(m_name, m_begin, clock_t::now());
+        }
+
+        span_t(const span_t&) = delete;
+        span_t& operator=(const span_t&) = delete;
+
+    private:
+        const char *m_name;
+        clock_t::time_point m_begin;
+    };
+
+    static tracer_t* instance();
+
+    /**
+    * @brief Enables recording.
+    * @param path Path of the file to which events are written. Events are not kept if this is empty.
+    */
+    void initialize(const filepath_t &path);
+
+    /** Returns whether recording is enabled. */
+    static bool is_enabled() { return ms_is_enabled; }
+
+    /** Records a span. Use span_t instead of calling this directly. */
+    void record(const char *name, clock_t::time_point begin, clock_t::time_point end);
+
+    /** Gets metrics of spans recorded since the last call of reset_metrics(). */
+    std::map<std::string, metric_t> metrics() const;
+
+    /** Discards metrics recorded so far. This must not be called while other threads are recording. */
+    void reset_metrics();
+
+    /** Writes events recorded so far to the file and discards them. */
+    void flush();
+
+    ~tracer_t();
+
+private:
+    struct event_t
+    {
+        const char *name;
+        int64_t begin, duration; /// In microseconds.
+    };
+
+    struct buffer_t
+    {
+        int tid;
+        mutable std::mutex mutex;
+        std::unordered_map<const char*, metric_t> metrics;
+        std::vector<event_t> events;
+    };
+
+    /** Holder of the buffer of a thread, which releases the buffer when the thread exits. */
+    struct holder_t
+    {
+        ~holder_t();
+        buffer_t *buffer = nullptr;
+    };
+
+    tracer_t();
+
+    buffer_t* local_buffer();
+
+    static std::unique_ptr<tracer_t> ms_instance;
+    static bool ms_is_enabled;
+    static thread_local holder_t ms_holder;
+
+    clock_t::time_point m_begin;
+    std::unique_ptr<std::ostream> m_os; /// The file to which events are written, or nullptr.
+    bool m_is_first_event;
+
+    mutable std::mutex m_mutex;
+    std::deque<std::unique_ptr<buffer_t>> m_buffers;
+    std::deque<buffer_t*> m_free_buffers; /// Buffers whose threads have exited, which are reused.
+};
+
+/** Gets Singleton instance of tracer_t. */
+inline tracer_t* tracer() { return tracer_t::instance(); }
+
+
 /**
 * Base class of David's components.
 * (i.e. LHS-Generator, ILP-Convertor, ILP-Solver)
@@ -1021,6 +1255,12 @@ public:
     /** Closes all of file streams which this instance has. */
     virtual void finalize();
 
+    /**
+    * @brief Makes prepare_query() read the database on given memory instead of the file.
+    * @details The memory, such as a section of a mapped image, must outlive READ mode. It is forgotten on finalize().
+    */
+    void assign(const char *data, size_t size) { m_data = data; m_data_size = size; }
+
     /**
     * @brief Adds new key-value pair. This method must be called in WRITE mode.
     * @param[in] key Pointer to key.
@@ -1039,6 +1279,32 @@ public:
     */
     const void* get(const void *key, size_t ksize, size_t *vsize) const;
 
+    /**
+    * @brief Links the database of a delta segment, whose values are also found by get_each().
+    * @details This must be called in READ mode, and `delta` must be readable while this is readable.
+    */
+    void add_delta(const cdb_data_t *delta) { m_deltas.push_back(delta); }
+
+    /**
+    * @brief Calls `f(value, vsize)` for each value for key in this and its delta segments, in the order of segments.
+    * @return The number of values found.
+    */
+    template <class F> size_t get_each(const void *key, size_t ksize, F f) const
+    {
+        size_t n(0), vsize(0);
+
+        if (const void *v = get(key, ksize, &vsize))
+        {
+            f(v, vsize);
+            ++n;
+        }
+
+        for (const auto *d : m_deltas)
+            n += d->get_each(key, ksize, f);
+
+        return n;
+    }
+
     /** Gets the total number of key-value pairs in the database. */
     size_t size() const;
 
@@ -1057,10 +1323,43 @@ private:
     std::ifstream  *m_fin;
     cdbpp::builder *m_builder;
     cdbpp::cdbpp   *m_finder;
+
+    const char *m_data; /// The database on memory given by assign(), or nullptr.
+    size_t m_data_size;
+
+    std::vector<const cdb_data_t*> m_deltas;
 };
 
 
 
+/**
+* @brief Read-only image of a whole file on memory.
+* @details Regular files are mapped onto memory. Other files, such as pipes, are read into a buffer.
+*/
+class mapped_file_t
+{
+public:
+    /**
+    * @brief Constructor, which throws an exception if the file cannot be opened.
+    * @param[in] is_sequential Whether the file will be read sequentially, which is advised to the kernel.
+    */
+    mapped_file_t(const filepath_t &path, bool is_sequential = true);
+    ~mapped_file_t();
+
+    mapped_file_t(const mapped_file_t&) = delete;
+    mapped_file_t& operator=(const mapped_file_t&) = delete;
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    void *m_map; /// The head of the memory mapped, or nullptr.
+    const char *m_data;
+    size_t m_size;
+    std::string m_buffer;
+};
+
+
 /**
 * @brief Class to convert binary data into an instance of some class.
 * @details This will throw an exception if byte size read exceeds the maximum length.
@@ -1353,6 +1652,367 @@ public:
 };
 
 
+/**
+* @brief Append-only array whose elements can be read without lock while another thread appends.
+* @details
+*   Elements are stored in chunks whose sizes are doubled one after another,
+*   and chunks are never moved, so that references to elements are always valid.
+*   Appending must be serialized by users, but reading needs no lock.
+*/
+template <class T> class concurrent_array_t
+{
+public:
+    /** Constructor, which makes `n` elements of the default value. */
+    explicit concurrent_array_t(size_t n = 0) : m_size(0)
+    {
+        for (auto &c : m_chunks) c = nullptr;
+        for (size_t i = 0; i < n; ++i) push_back(T());
+    }
+
+    ~concurrent_array_t() { clear(); }
+
+    concurrent_array_t(const concurrent_array_t&) = delete;
+    concurrent_array_t& operator=(const concurrent_array_t&) = delete;
+
+    /** Appends `x`, which is visible to readers once size() includes it. */
+    void push_back(const T &x)
+    {
+        size_t i = m_size.load(std::memory_order_relaxed);
+        size_t k = chunk_of(i);
+        T *c = m_chunks[k].load(std::memory_order_relaxed);
+
+        if (c == nullptr)
+        {
+            c = new T[FIRST_CHUNK_SIZE << k];
+            m_chunks[k].store(c, std::memory_order_release);
+        }
+
+        c[i - chunk_begin(k)] = x;
+        m_size.store(i + 1, std::memory_order_release);
+    }
+
+    inline const T& operator[](size_t i) const
+    {
+        size_t k = chunk_of(i);
+        return m_chunks[k].load(std::memory_order_acquire)[i - chunk_begin(k)];
+    }
+
+    inline T& operator[](size_t i)
+    {
+        size_t k = chunk_of(i);
+        return m_chunks[k].load(std::memory_order_acquire)[i - chunk_begin(k)];
+    }
+
+    inline size_t size() const { return m_size.load(std::memory_order_acquire); }
+    inline bool empty() const { return size() == 0; }
+
+    /** Removes all elements. This must not be called while other threads read this. */
+    void clear()
+    {
+        for (auto &c : m_chunks)
+        {
+            delete[] c.load(std::memory_order_relaxed);
+            c = nullptr;
+        }
+        m_size = 0;
+    }
+
+private:
+    static const size_t FIRST_CHUNK_SIZE = 64;
+    static const size_t NUM_CHUNKS = 48;
+
+    /** Returns the index of the chunk which has the i-th element. */
+    static size_t chunk_of(size_t i)
+    {
+        size_t k = 0;
+        for (size_t n = i / FIRST_CHUNK_SIZE + 1; n > 1; n >>= 1) ++k;
+        return k;
+    }
+
+    /** Returns the index of the first element of the k-th chunk. */
+    static size_t chunk_begin(size_t k) { return FIRST_CHUNK_SIZE * ((size_t(1) << k) - 1); }
+
+    std::atomic<T*> m_chunks[NUM_CHUNKS];
+    std::atomic<size_t> m_size;
+};
+
+
+/**
+* @brief Table to intern values, which gives each distinct value a dense ID.
+* @details
+*   IDs are assigned in order of addition, starting from 0.
+*   Values are hashed and compared only on add() and find(),
+*   so that the others can deal with them as integers.
+*/
+template <class T, class Hash = std::hash<T> > class intern_table_t
+{
+public:
+    typedef uint32_t id_t;
+    static const id_t INVALID_ID = static_cast<id_t>(-1);
+
+    typedef typename std::deque<T>::const_iterator const_iterator;
+
+    /** Gets the ID of `x`, with assigning a new ID if `x` is new. */
+    id_t add(const T &x)
+    {
+        auto found = m_ids.find(std::cref(x));
+        if (found != m_ids.end()) return found->second;
+
+        id_t id = static_cast<id_t>(m_values.size());
+        m_values.push_back(x);
+        m_ids.insert(std::make_pair(std::cref(m_values.back()), id));
+        return id;
+    }
+
+    /** Gets the ID of `x` if exists, otherwise INVALID_ID. */
+    id_t find(const T &x) const
+    {
+        auto found = m_ids.find(std::cref(x));
+        return (found != m_ids.end()) ? found->second : INVALID_ID;
+    }
+
+    /** Gets the value whose ID is `i`. */
+    inline const T& at(id_t i) const { return m_values.at(i); }
+
+    inline size_t size() const { return m_values.size(); }
+    inline bool empty() const { return m_values.empty(); }
+
+    inline const_iterator begin() const { return m_values.begin(); }
+    inline const_iterator end() const { return m_values.end(); }
+
+    void clear()
+    {
+        m_ids.clear();
+        m_values.clear();
+    }
+
+private:
+    std::deque<T> m_values; /// Values in order of IDs. Elements of std::deque are never moved.
+    std::unordered_map<std::reference_wrapper<const T>, id_t, Hash, std::equal_to<T>> m_ids;
+};
+
+template <class T, class Hash>
+const typename intern_table_t<T, Hash>::id_t intern_table_t<T, Hash>::INVALID_ID;
+
+
+/**
+* @brief Map whose keys are interned with intern_table_t.
+* @details
+*   Values are stored in a vector indexed by IDs of keys,
+*   so that the map can be looked up with integers once the ID of a key is known.
+*   Iteration follows the order of IDs, namely the order in which keys were added.
+*/
+template <class Key, class Value, class Hash = std::hash<Key> > class interned_map_t
+{
+public:
+    typedef typename intern_table_t<Key, Hash>::id_t id_t;
+    static const id_t INVALID_ID = intern_table_t<Key, Hash>::INVALID_ID;
+
+    /** Iterator which yields pairs of a key and its value. */
+    class const_iterator
+    {
+    public:
+        typedef std::pair<const Key&, const Value&> value_type;
+
+        const_iterator(const interned_map_t *m, id_t i) : m_map(m), m_id(i) {}
+
+        value_type operator*() const { return value_type(m_map->key(m_id), m_map->value(m_id)); }
+        const_iterator& operator++() { ++m_id; return *this; }
+
+        bool operator==(const const_iterator &x) const { return m_id == x.m_id; }
+        bool operator!=(const const_iterator &x) const { return m_id != x.m_id; }
+
+        /** Gets the ID of the key which this points. */
+        id_t id() const { return m_id; }
+
+    private:
+        const interned_map_t *m_map;
+        id_t m_id;
+    };
+
+    interned_map_t() : m_default(_hash_map::get_default<Value>()) {}
+
+    /** Gets the ID of `key`, with adding `key` with the default value if `key` is new. */
+    id_t add(const Key &key)
+    {
+        id_t i = m_keys.add(key);
+        if (i == m_values.size())
+            m_values.push_back(m_default);
+        return i;
+    }
+
+    /** Gets the ID of `key` if exists, otherwise INVALID_ID. */
+    inline id_t find(const Key &key) const { return m_keys.find(key); }
+
+    /** Refers the value of `key`, with adding `key` if `key` is new. */
+    inline Value& operator[](const Key &key) { return m_values[add(key)]; }
+
+    /** Gets the value of `key` if exists, otherwise the default value. */
+    const Value& get(const Key &key) const
+    {
+        id_t i = find(key);
+        return (i == INVALID_ID) ? m_default : m_values[i];
+    }
+
+    inline bool has_key(const Key &key) const { return find(key) != INVALID_ID; }
+
+    /** Gets the key whose ID is `i`. */
+    inline const Key& key(id_t i) const { return m_keys.at(i); }
+
+    /** Gets the value of the key whose ID is `i`. */
+    inline const Value& value(id_t i) const { return m_values.at(i); }
+    inline       Value& value(id_t i) { return m_values.at(i); }
+
+    inline size_t size() const { return m_values.size(); }
+    inline bool empty() const { return m_values.empty(); }
+
+    inline const_iterator begin() const { return const_iterator(this, 0); }
+    inline const_iterator end() const { return const_iterator(this, static_cast<id_t>(size())); }
+
+    void clear()
+    {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    void set_default(const Value &def) { m_default = def; }
+
+private:
+    intern_table_t<Key, Hash> m_keys;
+    std::vector<Value> m_values;
+    Value m_default;
+};
+
+template <class Key, class Value, class Hash>
+const typename interned_map_t<Key, Value, Hash>::id_t interned_map_t<Key, Value, Hash>::INVALID_ID;
+
+
+/** Statistics of a cache. */
+struct cache_stats_t
+{
+    size_t capacity; //!< The maximum of the total cost.
+    size_t cost;     //!< The total cost of values cached.
+    size_t entries;  //!< The number of values cached.
+    size_t hits;     //!< The number of lookups which found values.
+    size_t misses;   //!< The number of lookups which did not find values.
+
+    /** Returns the ratio of hits to all lookups. */
+    double hit_rate() const { return (hits + misses > 0) ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+};
+
+
+/**
+* @brief Cache of immutable values, whose total cost is bounded.
+* @details
+*   Each value is given its cost, such as its bytesize, on insertion,
+*   and the least recently used values are evicted while the total cost exceeds the capacity.
+*   All methods are thread-safe. Values are shared via shared pointers,
+*   so that values which have been gotten are still valid after eviction.
+*/
+template <class Key, class Value, class Hash = std::hash<Key> > class lru_cache_t
+{
+public:
+    typedef std::shared_ptr<const Value> value_ptr_t;
+
+    lru_cache_t(size_t capacity = 0) : m_capacity(capacity), m_cost(0), m_num_hits(0), m_num_misses(0) {}
+
+    lru_cache_t(const lru_cache_t&) = delete;
+    lru_cache_t& operator=(const lru_cache_t&) = delete;
+
+    /** Gets the value of `key` if cached, otherwise nullptr. */
+    value_ptr_t get(const Key &key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_map.find(key);
+
+        if (found == m_map.end())
+        {
+            ++m_num_misses;
+            return value_ptr_t();
+        }
+
+        ++m_num_hits;
+        m_list.splice(m_list.begin(), m_list, found->second);
+        return found->second->value;
+    }
+
+    /**
+    * @brief Inserts `value` as the value of `key`.
+    * @return The value cached, which differs from `value` if another thread has inserted a value of `key`.
+    * @details Values whose cost exceeds the capacity are not cached.
+    */
+    value_ptr_t put(const Key &key, const value_ptr_t &value, size_t cost)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_map.find(key);
+
+        if (found != m_map.end())
+            return found->second->value;
+
+        if (cost > m_capacity)
+            return value;
+
+        m_list.push_front(entry_t{ key, value, cost });
+        m_map[key] = m_list.begin();
+        m_cost += cost;
+        evict();
+
+        return value;
+    }
+
+    /** Changes the capacity, evicting values if needed. */
+    void set_capacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_capacity = capacity;
+        evict();
+    }
+
+    /** Removes all values and resets statistics. */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_list.clear();
+        m_map.clear();
+        m_cost = m_num_hits = m_num_misses = 0;
+    }
+
+    cache_stats_t stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return cache_stats_t{ m_capacity, m_cost, m_map.size(), m_num_hits, m_num_misses };
+    }
+
+private:
+    struct entry_t
+    {
+        Key key;
+        value_ptr_t value;
+        size_t cost;
+    };
+
+    /** Evicts the least recently used values while the total cost exceeds the capacity. */
+    void evict()
+    {
+        while (m_cost > m_capacity)
+        {
+            m_cost -= m_list.back().cost;
+            m_map.erase(m_list.back().key);
+            m_list.pop_back();
+        }
+    }
+
+    mutable std::mutex m_mutex;
+
+    /** Entries in the order of recent use. */
+    std::list<entry_t> m_list;
+    std::unordered_map<Key, typename std::list<entry_t>::iterator, Hash> m_map;
+
+    size_t m_capacity, m_cost;
+    size_t m_num_hits, m_num_misses;
+};
+
+
 /** Limitation of a some value, such as size and distance. */
 template <class T> class limit_t
 {
@@ -1542,6 +2202,64 @@ private:
 } // end of fnv_1
 
 
+/**
+* @brief Hasher which reads data as 64-bit words, in the manner of wyhash.
+* @details
+*   Each word is mixed into the state with the folded 128-bit product of two words,
+*   so that it costs one multiplication per word while fnv_1::hash_t costs one per byte.
+*   Hash values do not depend on the process, so that iteration over hash containers is reproducible.
+*/
+class word_hash_t
+{
+public:
+    word_hash_t() : m_hash(SECRET_0), m_length(0) {}
+
+    /** @brief Reads a word. */
+    inline void read(uint64_t x)
+    {
+        m_hash = mix(m_hash ^ SECRET_1, x ^ SECRET_2);
+        ++m_length;
+    }
+
+    /** @brief Reads a pair of 32-bit values as a word. */
+    inline void read(uint32_t x, uint32_t y)
+    {
+        read((static_cast<uint64_t>(x) << 32) | static_cast<uint64_t>(y));
+    }
+
+    /** @brief Gets the hash of data which this has read so far. */
+    inline size_t hash() const noexcept
+    {
+        return static_cast<size_t>(mix(m_hash ^ SECRET_3, m_length ^ SECRET_0));
+    }
+
+    /** @brief Returns the upper and the lower halves of the 128-bit product of `a` and `b`, XORed. */
+    static inline uint64_t mix(uint64_t a, uint64_t b) noexcept
+    {
+#ifdef __SIZEOF_INT128__
+        __uint128_t r = static_cast<__uint128_t>(a) * b;
+        return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+        uint64_t ha = a >> 32, la = a & 0xffffffffULL, hb = b >> 32, lb = b & 0xffffffffULL;
+        uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+        uint64_t mid = (ll >> 32) + (hl & 0xffffffffULL) + (lh & 0xffffffffULL);
+        uint64_t lo = (mid << 32) | (ll & 0xffffffffULL);
+        uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+        return lo ^ hi;
+#endif
+    }
+
+private:
+    static const uint64_t SECRET_0 = 0xa0761d6478bd642fULL;
+    static const uint64_t SECRET_1 = 0xe7037ed1a0b428dbULL;
+    static const uint64_t SECRET_2 = 0x8ebc6af09c88c6e3ULL;
+    static const uint64_t SECRET_3 = 0x589965cc75374cc3ULL;
+
+    uint64_t m_hash;
+    uint64_t m_length;
+};
+
+
 /* -------- Functions -------- */
 
 
@@ -6,7 +6,7 @@ namespace dav
 
 cdb_data_t::cdb_data_t(std::string _filename)
 	: m_filename(_filename), m_fout(NULL), m_fin(NULL),
-	m_builder(NULL), m_finder(NULL)
+	m_builder(NULL), m_finder(NULL), m_data(NULL), m_data_size(0)
 {}
 
 
@@ -38,6 +38,16 @@ void cdb_data_t::prepare_query()
 {
 	if (is_writable()) finalize();
 
+	if (not is_readable() and m_data != NULL)
+	{
+		// THE DATABASE ON MEMORY IS USED AS IT IS, WITHOUT COPYING.
+		m_finder = new cdbpp::cdbpp(m_data, m_data_size, false);
+
+		if (not m_finder->is_open())
+			throw exception_t(
+				format("cdb_data_t cannot open the image of \"%s\"", m_filename.c_str()));
+	}
+
 	if (not is_readable())
 	{
 		m_fin = new std::ifstream(
@@ -81,6 +91,10 @@ void cdb_data_t::finalize()
 		delete m_fin;
 		m_fin = NULL;
 	}
+
+	m_data = NULL;
+	m_data_size = 0;
+	m_deltas.clear();
 }
 
 
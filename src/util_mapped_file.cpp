@@ -0,0 +1,68 @@
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "./util.h"
+
+
+namespace dav
+{
+
+
+mapped_file_t::mapped_file_t(const filepath_t &path, bool is_sequential)
+    : m_map(nullptr), m_data(nullptr), m_size(0)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        throw exception_t(format("mapped_file_t cannot open \"%s\"", path.c_str()));
+
+    struct stat st;
+    bool is_regular = (fstat(fd, &st) == 0 and S_ISREG(st.st_mode));
+
+    if (is_regular and st.st_size > 0)
+    {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (p != MAP_FAILED)
+        {
+            if (is_sequential)
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+            m_map = p;
+            m_data = static_cast<const char*>(p);
+            m_size = st.st_size;
+        }
+    }
+
+    close(fd);
+    if (m_map != nullptr or (is_regular and st.st_size == 0)) return;
+#endif
+
+    // OTHERWISE THE WHOLE OF THE FILE IS READ INTO THE BUFFER.
+    std::ifstream fin(path, std::ios::binary);
+
+    if (not fin)
+        throw exception_t(format("mapped_file_t cannot open \"%s\"", path.c_str()));
+
+    m_buffer.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+
+mapped_file_t::~mapped_file_t()
+{
+#ifndef _WIN32
+    if (m_map != nullptr)
+        munmap(m_map, m_size);
+#endif
+}
+
+
+}
@@ -11,6 +11,21 @@ std::deque<string_t> string_hash_t::ms_strs;
 unsigned string_hash_t::ms_issued_variable_count = 0;
 
 
+namespace
+{
+/** Returns whether std::stoi can convert given string, without throwing exceptions. */
+bool can_be_parsed_as_int(const std::string &str)
+{
+	auto it = str.begin();
+
+	while (it != str.end() and std::isspace(static_cast<unsigned char>(*it))) ++it;
+	if (it != str.end() and (*it == '+' or *it == '-')) ++it;
+
+	return it != str.end() and std::isdigit(static_cast<unsigned char>(*it));
+}
+}
+
+
 string_hash_t string_hash_t::get_unknown_hash()
 {
     return get_unknown_hash(++ms_issued_variable_count);
@@ -116,7 +131,8 @@ string_hash_t::string_hash_t(const string_hash_t& h)
 	m_is_constant(h.is_constant()),
 	m_is_unknown(h.is_unknown()),
 	m_is_hard_term(h.is_hard_term()),
-	m_is_forall(h.is_universally_quantified())
+	m_is_forall(h.is_universally_quantified()),
+	m_is_number(h.m_is_number)
 {
 #ifdef _DEBUG
     m_string = h.string();
@@ -180,8 +196,13 @@ string_hash_t& string_hash_t::operator = (const std::string &s)
 
 string_hash_t& string_hash_t::operator = (const string_hash_t &h)
 {
+    // FLAGS ARE COPIED, SINCE THEY ARE DETERMINED ONLY BY THE STRING.
     m_hash = h.m_hash;
-    set_flags(string());
+    m_is_constant = h.m_is_constant;
+    m_is_unknown = h.m_is_unknown;
+    m_is_hard_term = h.m_is_hard_term;
+    m_is_forall = h.m_is_forall;
+    m_is_number = h.m_is_number;
 
 #ifdef _DEBUG
     m_string = h.string();
@@ -204,6 +225,10 @@ bool string_hash_t::parse_as_numerical_variable(int *margin, string_hash_t *base
 	if (i == std::string::npos or i <= 0)
 		return false;
 
+	// THROWING AN EXCEPTION IS TOO COSTLY FOR A TERM WHICH IS NOT NUMERICAL.
+	if (not can_be_parsed_as_int(str.substr(i)))
+		return false;
+
 	try
 	{
 		int m = std::stoi(str.substr(i));
@@ -223,6 +248,10 @@ bool string_hash_t::parse_as_numerical_variable(int *margin, string_hash_t *base
 
 bool string_hash_t::parse_as_numerical_constant(int *value) const
 {
+	// THROWING AN EXCEPTION IS TOO COSTLY FOR A TERM WHICH IS NOT NUMERICAL.
+	if (not can_be_parsed_as_int(string()))
+		return false;
+
 	try
 	{
 		int i = std::stoi(string());
@@ -245,6 +274,7 @@ void string_hash_t::set_flags(const std::string &str)
 	m_is_unknown = false;
     m_is_hard_term = false;
     m_is_forall = false;
+    m_is_number = false;
 
     if (not str.empty())
     {
@@ -0,0 +1,207 @@
+#include "./util.h"
+
+
+namespace dav
+{
+
+
+namespace
+{
+/** The pool which the current thread works for. */
+thread_local const task_pool_t *g_current_pool = nullptr;
+
+/** The index of the current thread in the pool. */
+thread_local int g_current_index = -1;
+}
+
+
+task_pool_t::task_pool_t(int num)
+    : m_num_queued(0), m_num_pending(0), m_num_pushed(0), m_is_terminating(false)
+{
+    num = std::max(num, 1);
+
+    for (int i = 0; i < num; ++i)
+        m_queues.push_back(std::unique_ptr<queue_t>(new queue_t()));
+
+    for (int i = 0; i < num; ++i)
+        m_threads.push_back(std::thread([this, i] { work(i); }));
+}
+
+
+task_pool_t::~task_pool_t()
+{
+    try { wait(); }
+    catch (...) {}
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_terminating = true;
+    }
+    m_cv_task.notify_all();
+
+    for (auto &th : m_threads)
+        th.join();
+}
+
+
+void task_pool_t::push(task_t task)
+{
+    int idx = worker_index();
+    if (idx < 0)
+        idx = static_cast<int>(m_num_pushed++ % m_queues.size());
+
+    ++m_num_pending;
+    {
+        // m_num_queued IS INCREASED BEFORE ANYONE CAN POP THE TASK.
+        std::lock_guard<std::mutex> lock_q(m_queues[idx]->mutex);
+        m_queues[idx]->tasks.push_back(std::move(task));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_num_queued;
+    }
+    m_cv_task.notify_one();
+}
+
+
+void task_pool_t::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this] { return m_num_pending == 0; });
+
+    if (m_exception)
+    {
+        std::exception_ptr e = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+
+task_pool_t::group_t::~group_t()
+{
+    try { wait(); }
+    catch (...) {}
+}
+
+
+void task_pool_t::group_t::push(task_t task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_num_pending;
+    }
+
+    // EXCEPTIONS ARE KEPT IN THIS GROUP, SO THAT THEY DO NOT REACH OTHER USERS OF THE POOL.
+    m_pool->push([this, task]()
+    {
+        std::exception_ptr e;
+
+        try { task(); }
+        catch (...) { e = std::current_exception(); }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (e and not m_exception)
+            m_exception = e;
+        if (--m_num_pending == 0)
+            m_cv_done.notify_all();
+    });
+}
+
+
+void task_pool_t::group_t::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this] { return m_num_pending == 0; });
+
+    if (m_exception)
+    {
+        std::exception_ptr e = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+
+int task_pool_t::worker_index() const
+{
+    return (g_current_pool == this) ? g_current_index : -1;
+}
+
+
+void task_pool_t::work(int idx)
+{
+    g_current_pool = this;
+    g_current_index = idx;
+
+    while (true)
+    {
+        task_t task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_task.wait(lock, [this] { return m_num_queued > 0 or m_is_terminating; });
+            if (m_num_queued == 0 and m_is_terminating)
+                break;
+        }
+
+        if (not pop(idx, &task) and not steal(idx, &task))
+            continue; // ANOTHER WORKER TOOK IT
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (not m_exception)
+                m_exception = std::current_exception();
+        }
+
+        if (--m_num_pending == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cv_done.notify_all();
+        }
+    }
+}
+
+
+bool task_pool_t::pop(int idx, task_t *out)
+{
+    queue_t &q = *m_queues[idx];
+    std::lock_guard<std::mutex> lock(q.mutex);
+
+    if (q.tasks.empty()) return false;
+
+    *out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    --m_num_queued;
+
+    return true;
+}
+
+
+bool task_pool_t::steal(int idx, task_t *out)
+{
+    int n = static_cast<int>(m_queues.size());
+
+    for (int i = 1; i < n; ++i)
+    {
+        queue_t &q = *m_queues[(idx + i) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+
+        if (q.tasks.empty()) continue;
+
+        *out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        --m_num_queued;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+}
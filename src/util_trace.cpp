@@ -0,0 +1,196 @@
+#include <fstream>
+
+#include "./util.h"
+
+
+namespace dav
+{
+
+
+std::unique_ptr<tracer_t> tracer_t::ms_instance;
+bool tracer_t::ms_is_enabled = false;
+thread_local tracer_t::holder_t tracer_t::ms_holder;
+
+
+tracer_t::metric_t::metric_t()
+    : count(0), total(0.0), max(0.0)
+{
+    std::fill(histogram, histogram + NUM_BUCKETS, 0);
+}
+
+
+void tracer_t::metric_t::add(double usec)
+{
+    ++count;
+    total += usec;
+    max = std::max(max, usec);
+
+    int i = 0;
+    for (double x = usec; x >= 1.0 and i < NUM_BUCKETS - 1; x /= 2.0)
+        ++i;
+    ++histogram[i];
+}
+
+
+void tracer_t::metric_t::merge(const metric_t &x)
+{
+    count += x.count;
+    total += x.total;
+    max = std::max(max, x.max);
+
+    for (int i = 0; i < NUM_BUCKETS; ++i)
+        histogram[i] += x.histogram[i];
+}
+
+
+tracer_t::holder_t::~holder_t()
+{
+    // THE BUFFER IS KEPT WITH ITS RECORDS, SO THAT THEY ARE NOT LOST.
+    if (buffer != nullptr and ms_instance)
+    {
+        std::lock_guard<std::mutex> lock(ms_instance->m_mutex);
+        ms_instance->m_free_buffers.push_back(buffer);
+    }
+}
+
+
+tracer_t* tracer_t::instance()
+{
+    if (not ms_instance)
+        ms_instance.reset(new tracer_t());
+
+    return ms_instance.get();
+}
+
+
+tracer_t::tracer_t()
+    : m_begin(clock_t::now()), m_is_first_event(true)
+{}
+
+
+tracer_t::~tracer_t()
+{
+    ms_is_enabled = false;
+
+    if (m_os)
+    {
+        flush();
+        (*m_os) << "\n]\n";
+    }
+}
+
+
+void tracer_t::initialize(const filepath_t &path)
+{
+    if (not path.empty())
+    {
+        m_os.reset(new std::ofstream(path.c_str()));
+
+        if (m_os->fail())
+            throw exception_t(format("tracer_t cannot open \"%s\"", path.c_str()));
+
+        (*m_os) << "[";
+    }
+
+    m_begin = clock_t::now();
+    ms_is_enabled = true;
+}
+
+
+void tracer_t::record(const char *name, clock_t::time_point begin, clock_t::time_point end)
+{
+    buffer_t *buf = local_buffer();
+    int64_t b = std::chrono::duration_cast<std::chrono::microseconds>(begin - m_begin).count();
+    int64_t d = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+
+    // THE LOCK IS CONTENDED ONLY WHILE THE BUFFER IS BEING COLLECTED.
+    std::lock_guard<std::mutex> lock(buf->mutex);
+    buf->metrics[name].add(d / 1000.0);
+
+    if (m_os)
+        buf->events.push_back(event_t{ name, b, d / 1000 });
+}
+
+
+std::map<std::string, tracer_t::metric_t> tracer_t::metrics() const
+{
+    std::map<std::string, metric_t> out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const auto &buf : m_buffers)
+    {
+        std::lock_guard<std::mutex> lock_b(buf->mutex);
+        for (const auto &p : buf->metrics)
+            out[p.first].merge(p.second);
+    }
+
+    return out;
+}
+
+
+void tracer_t::reset_metrics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto &buf : m_buffers)
+    {
+        std::lock_guard<std::mutex> lock_b(buf->mutex);
+        buf->metrics.clear();
+    }
+}
+
+
+void tracer_t::flush()
+{
+    if (not m_os) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<event_t> events;
+
+    for (auto &buf : m_buffers)
+    {
+        {
+            std::lock_guard<std::mutex> lock_b(buf->mutex);
+            events.swap(buf->events);
+        }
+
+        for (const auto &e : events)
+        {
+            (*m_os)
+                << (m_is_first_event ? "\n" : ",\n")
+                << "{\"name\":\"" << e.name << "\",\"cat\":\"david\",\"ph\":\"X\""
+                << ",\"ts\":" << e.begin << ",\"dur\":" << e.duration
+                << ",\"pid\":0,\"tid\":" << buf->tid << "}";
+            m_is_first_event = false;
+        }
+        events.clear();
+    }
+
+    m_os->flush();
+}
+
+
+tracer_t::buffer_t* tracer_t::local_buffer()
+{
+    if (ms_holder.buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_free_buffers.empty())
+        {
+            m_buffers.push_back(std::unique_ptr<buffer_t>(new buffer_t()));
+            m_buffers.back()->tid = static_cast<int>(m_buffers.size() - 1);
+            ms_holder.buffer = m_buffers.back().get();
+        }
+        else
+        {
+            ms_holder.buffer = m_free_buffers.front();
+            m_free_buffers.pop_front();
+        }
+    }
+
+    return ms_holder.buffer;
+}
+
+
+}
@@ -0,0 +1,293 @@
+#! /usr/bin/python
+# -*- coding: utf-8 -*-
+
+## @file
+## @brief End-to-end benchmark driver for David.
+##
+## This generates synthetic inputs with benchgen.py, compiles them,
+## runs inference with each combination of components,
+## and writes a JSON report of time, memory and sizes per stage.
+## Given a baseline report, it also flags regressions.
+
+from __future__ import print_function
+import sys, os, re, json, time, argparse, subprocess
+import benchgen
+
+
+## Parameters of benchgen.py for each scenario.
+SCENARIOS = {
+    'default' : {},
+    'wide'    : {'depth': 1, 'fan_out': 6, 'predicates': 300},
+    'deep'    : {'depth': 4, 'fan_out': 2, 'observations': 2, 'problems': 5},
+    'dense'   : {'property_density': 0.6, 'exclusions': 60, 'exclusion_size': 5, 'cluster_size': 4.0},
+    }
+
+LHS = ['astar', 'naive']
+CNV = ['weighted', 'etcetera', 'ceaea']
+SOL = ['null', 'lpsolve', 'gurobi', 'scip', 'cbc']
+
+## Differences smaller than these are never regarded as regressions.
+MIN_TIME_DIFF = 0.01   # In seconds.
+MIN_MEMORY_DIFF = 1.0  # In MiB.
+
+
+def log(mes):
+    sys.stderr.write('%s %s\n' % (time.strftime('%x %X]'), mes))
+
+
+## Executes a command and returns whether it succeeded, its wall-clock time and its peak memory in MiB.
+def execute(cmd, out_path, log_path):
+    begin = time.time()
+    with open(out_path, 'w') as fout, open(log_path, 'w') as ferr:
+        p = subprocess.Popen(cmd, stdout=fout, stderr=ferr)
+        pid, status, usage = os.wait4(p.pid, 0)
+        p.returncode = status
+
+    ok = os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
+    return ok, time.time() - begin, usage.ru_maxrss / 1024.0
+
+
+def median(xs):
+    xs = sorted(xs)
+    n = len(xs)
+    return xs[n // 2] if n % 2 else (xs[n // 2 - 1] + xs[n // 2]) / 2.0
+
+
+def last_line(path):
+    with open(path) as fin:
+        lines = [l.strip() for l in fin.read().replace('\r', '\n').split('\n') if l.strip()]
+    return lines[-1] if lines else ''
+
+
+## Reads blocks of given keys in an output of David, such as `"size" : { ... }`.
+## Outputs are read line by line, because they can be too large to be loaded at once.
+def read_blocks(path, keys):
+    re_begin = re.compile(r'^"(%s)" : \{$' % '|'.join(re.escape(k) for k in keys))
+    re_item = re.compile(r'^"(.+?)" : ([\-0-9.eE+]+),?$')
+
+    with open(path) as fin:
+        block = None
+        for line in fin:
+            line = line.strip()
+            if block is None:
+                m = re_begin.match(line)
+                if m:
+                    key, block = m.group(1), {}
+            elif line.startswith('}'):
+                yield key, block
+                block = None
+            else:
+                m = re_item.match(line)
+                if m:
+                    block[m.group(1)] = float(m.group(2))
+
+
+## Returns the solvers which the binary of David reports as unavailable in its help.
+def unavailable_solvers(david):
+    p = subprocess.Popen([david, '-h'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    out = p.communicate()[0].decode('utf-8', 'replace')
+    return set(re.findall(r'^\t(\S+): unavailable$', out, re.M))
+
+
+## Sums up the results of inference in given outputs of David.
+def summarize(mini_path, ilp_path):
+    out = {
+        'problems' : 0,
+        'time' : {'lhs': 0.0, 'cnv': 0.0, 'sol': 0.0, 'all': 0.0},
+        'nodes' : 0, 'edges' : 0, 'variables' : 0, 'constraints' : 0 }
+
+    # THE SIZES OF PROOF-GRAPHS AND ILP PROBLEMS ARE TAKEN FROM THE FIRST SOLUTION OF EACH PROBLEM.
+    is_counted = True
+    for key, block in read_blocks(mini_path, ['elapsed-time', 'size']):
+        if key == 'elapsed-time':
+            out['problems'] += 1
+            for k in out['time']:
+                out['time'][k] += block.get(k, 0.0)
+            is_counted = False
+        elif not is_counted:
+            out['nodes'] += int(block.get('node', 0))
+            out['edges'] += int(block.get('edge', 0))
+            is_counted = True
+
+    is_counted = True
+    for key, block in read_blocks(ilp_path, ['elapsed-time', 'size']):
+        if key == 'elapsed-time':
+            is_counted = False
+        elif not is_counted:
+            out['variables'] += int(block.get('variables', 0))
+            out['constraints'] += int(block.get('constraints', 0))
+            is_counted = True
+
+    return out
+
+
+## Runs the benchmark and returns its report.
+def run(args):
+    report = {
+        'david' : args.david,
+        'date' : time.strftime('%Y-%m-%d %H:%M:%S'),
+        'repeat' : args.repeat,
+        'scenarios' : {} }
+
+    unavailable = unavailable_solvers(args.david)
+    for sol in args.sol:
+        if sol in unavailable:
+            log('%s is not available in this build.' % sol)
+
+    for name in args.scenarios:
+        params = dict(SCENARIOS[name])
+        wd = os.path.join(args.workdir, name)
+        if not os.path.exists(wd):
+            os.makedirs(wd)
+
+        kb_path, obs_path = os.path.join(wd, 'kb.dav'), os.path.join(wd, 'obs.dav')
+        benchgen.generate(kb_path, obs_path, **params)
+        sc = {'params' : benchgen.Generator(**params).params, 'runs' : {}}
+        report['scenarios'][name] = sc
+
+        # ---- COMPILE
+        log('%s: compiling KB ...' % name)
+        times, memories = [], []
+        for i in range(args.repeat):
+            cmd = [args.david, 'compile', '-k', os.path.join(wd, 'kb', 'kb'), kb_path]
+            ok, t, m = execute(cmd, os.devnull, os.path.join(wd, 'compile.log'))
+            if not ok:
+                raise RuntimeError('failed to compile: %s' % last_line(os.path.join(wd, 'compile.log')))
+            times.append(t)
+            memories.append(m)
+        sc['compile'] = {'time' : median(times), 'memory' : max(memories)}
+
+        # ---- INFER
+        for lhs in args.lhs:
+            for cnv in args.cnv:
+                for sol in args.sol:
+                    if sol in unavailable: continue
+
+                    key = '%s,%s,%s' % (lhs, cnv, sol)
+                    log('%s: %s ...' % (name, key))
+
+                    mini_path = os.path.join(wd, 'mini.json')
+                    ilp_path = os.path.join(wd, 'ilp.json')
+                    log_path = os.path.join(wd, 'infer.log')
+                    # THE OUTPUT IN MINI FORMAT IS WRITTEN TO STDOUT.
+                    cmd = [args.david, 'infer', '-c', key, '-k', os.path.join(wd, 'kb', 'kb'),
+                           '-T', args.timeout, '-o', 'ilp:' + ilp_path]
+                    cmd += args.options.split() + [obs_path]
+
+                    results = []
+                    for i in range(args.repeat):
+                        ok, t, m = execute(cmd, mini_path, log_path)
+                        if not ok: break
+                        r = summarize(mini_path, ilp_path)
+                        r['time']['wall'] = t
+                        r['memory'] = m
+                        results.append(r)
+
+                    if not ok:
+                        sc['runs'][key] = {'status' : 'failed', 'error' : last_line(log_path)}
+                        continue
+
+                    out = results[0]
+                    out['status'] = 'ok'
+                    out['memory'] = max(r['memory'] for r in results)
+                    for k in out['time']:
+                        out['time'][k] = median([r['time'][k] for r in results])
+                    sc['runs'][key] = out
+
+    return report
+
+
+## Compares a report with its baseline and returns lists of regressions and changes.
+def compare(report, base, threshold):
+    regressions, changes = [], []
+
+    def check(path, new, old, min_diff):
+        if new > old * (1.0 + threshold) and new - old > min_diff:
+            regressions.append('%s: %g -> %g (%+.1f%%)' % (
+                path, old, new, 100.0 * (new - old) / old if old > 0 else float('inf')))
+
+    for name, sc in sorted(report['scenarios'].items()):
+        bsc = base['scenarios'].get(name)
+        if bsc is None: continue
+
+        if sc['params'] != bsc['params']:
+            changes.append('%s: parameters differ from the baseline' % name)
+            continue
+
+        check('%s/compile/time' % name, sc['compile']['time'], bsc['compile']['time'], MIN_TIME_DIFF)
+        check('%s/compile/memory' % name, sc['compile']['memory'], bsc['compile']['memory'], MIN_MEMORY_DIFF)
+
+        for key, r in sorted(sc['runs'].items()):
+            b = bsc['runs'].get(key)
+            path = '%s/%s' % (name, key)
+            if b is None: continue
+
+            if r['status'] != b['status']:
+                changes.append('%s: status %s -> %s' % (path, b['status'], r['status']))
+            if r['status'] != 'ok' or b['status'] != 'ok':
+                continue
+
+            for k in sorted(r['time']):
+                check('%s/time/%s' % (path, k), r['time'][k], b['time'][k], MIN_TIME_DIFF)
+            check('%s/memory' % path, r['memory'], b['memory'], MIN_MEMORY_DIFF)
+
+            # SIZES CHANGE ONLY WHEN THE BEHAVIOR OF INFERENCE CHANGES.
+            for k in ['problems', 'nodes', 'edges', 'variables', 'constraints']:
+                if r[k] != b[k]:
+                    changes.append('%s/%s: %d -> %d' % (path, k, b[k], r[k]))
+
+    return regressions, changes
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmarks David on synthetic inputs.')
+    parser.add_argument('--david', default='bin/david', help='path of the binary of David')
+    parser.add_argument('--workdir', default='bench-work', help='directory for generated files')
+    parser.add_argument('--scenarios', default=','.join(sorted(SCENARIOS)), help='comma-separated scenarios')
+    parser.add_argument('--lhs', default=','.join(LHS), help='comma-separated LHS generators')
+    parser.add_argument('--cnv', default=','.join(CNV), help='comma-separated ILP converters')
+    parser.add_argument('--sol', default=','.join(SOL), help='comma-separated ILP solvers, unavailable ones are skipped')
+    parser.add_argument('--repeat', type=int, default=1, help='the number of runs, whose median is reported')
+    parser.add_argument('--timeout', default='60', help='timeout of each run, passed to -T')
+    parser.add_argument('--options', default='', help='other options passed to David')
+    parser.add_argument('-o', '--output', default='-', help='path of the report to write')
+    parser.add_argument('-i', '--input', help='reads the report from this path instead of running the benchmark')
+    parser.add_argument('-b', '--baseline', help='path of the report to compare with')
+    parser.add_argument('--threshold', type=float, default=0.2, help='relative increase regarded as a regression')
+    args = parser.parse_args()
+
+    for k in ['scenarios', 'lhs', 'cnv', 'sol']:
+        setattr(args, k, [x for x in getattr(args, k).split(',') if x])
+    for name in args.scenarios:
+        if name not in SCENARIOS:
+            parser.error('unknown scenario: %s' % name)
+
+    if args.input:
+        with open(args.input) as fin:
+            report = json.load(fin)
+    else:
+        report = run(args)
+        text = json.dumps(report, indent=2, sort_keys=True)
+        if args.output == '-':
+            print(text)
+        else:
+            with open(args.output, 'w') as fout:
+                fout.write(text + '\n')
+
+    if args.baseline:
+        with open(args.baseline) as fin:
+            base = json.load(fin)
+        regressions, changes = compare(report, base, args.threshold)
+
+        for s in changes:
+            log('CHANGED: %s' % s)
+        for s in regressions:
+            log('REGRESSION: %s' % s)
+        log('%d regressions, %d changes' % (len(regressions), len(changes)))
+
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,164 @@
+#! /usr/bin/python
+# -*- coding: utf-8 -*-
+
+## @file
+## @brief Generator of synthetic knowledge-bases and observations for benchmarking.
+##
+## The output is determined only by the parameters and the seed,
+## so that different builds of David can be compared on the same inputs.
+
+import argparse, random
+
+
+## Parameters of generation and their default values.
+DEFAULTS = {
+    'seed'             : 0,
+    'predicates'       : 200,  # The number of predicates.
+    'arity'            : 2,    # The maximum arity of predicates.
+    'depth'            : 2,    # The number of layers of rules.
+    'fan_out'          : 3,    # The number of rules which explain each predicate.
+    'body_size'        : 2,    # The maximum number of atoms in the body of each rule.
+    'property_density' : 0.2,  # The ratio of predicates which have properties.
+    'exclusions'       : 20,   # The number of mutual-exclusions.
+    'exclusion_size'   : 3,    # The number of atoms in each mutual-exclusion.
+    'problems'         : 10,   # The number of observations.
+    'observations'     : 6,    # The number of observed atoms in each observation.
+    'cluster_size'     : 2.0,  # The average number of observed atoms which share each argument.
+    }
+
+PROPERTIES_BINARY = ['right-unique', 'left-unique', 'symmetric', 'asymmetric', 'irreflexive', 'transitive']
+
+
+## Class to generate a knowledge-base and observations from parameters.
+class Generator:
+    def __init__(self, **kwargs):
+        self.params = dict(DEFAULTS)
+        for k, v in kwargs.items():
+            if k not in DEFAULTS:
+                raise KeyError('unknown parameter: %s' % k)
+            self.params[k] = v
+
+        p = self.params
+        self.random = random.Random(p['seed'])
+
+        # PREDICATES ARE DIVIDED INTO LAYERS.
+        # RULES EXPLAIN PREDICATES IN LAYER i WITH PREDICATES IN LAYER i+1,
+        # AND OBSERVATIONS CONSIST OF PREDICATES IN LAYER 0.
+        num_layers = p['depth'] + 1
+        self.arities = [self.random.randint(1, p['arity']) for i in range(p['predicates'])]
+        self.layers = [[] for i in range(num_layers)]
+        for i in range(p['predicates']):
+            self.layers[i % num_layers].append(i)
+
+    def name(self, i):
+        return 'p%d' % i
+
+    def atom(self, i, args):
+        return '%s(%s)' % (self.name(i), ', '.join(args))
+
+    ## Returns lines of the knowledge-base.
+    def kb(self):
+        p, rnd = self.params, self.random
+        out = ['# Generated by benchgen.py with %s' % self.describe(), '']
+
+        num = 0
+        for layer in range(p['depth']):
+            lower = self.layers[layer + 1]
+            if not lower: break
+
+            for i in self.layers[layer]:
+                head_args = ['x%d' % k for k in range(self.arities[i])]
+
+                for r in range(p['fan_out']):
+                    body = []
+                    fresh = 0
+                    for b in range(rnd.randint(1, p['body_size'])):
+                        j = rnd.choice(lower)
+                        args = []
+                        for k in range(self.arities[j]):
+                            if rnd.random() < 0.7:
+                                args.append(rnd.choice(head_args))
+                            else:
+                                args.append('y%d' % fresh)
+                                fresh += 1
+                        body.append(self.atom(j, args))
+
+                    out.append('rule r%d { %s => %s }' % (
+                        num, ' ^ '.join(body), self.atom(i, head_args)))
+                    num += 1
+
+        out.append('')
+        for e in range(p['exclusions']):
+            arity = rnd.randint(1, p['arity'])
+            cands = [i for i in range(p['predicates']) if self.arities[i] == arity]
+            if len(cands) < 2: continue
+
+            size = min(p['exclusion_size'], len(cands))
+            args = ['x%d' % k for k in range(arity)]
+            atoms = [self.atom(i, args) for i in sorted(rnd.sample(cands, size))]
+            out.append('mutual-exclusion { %s }' % ' v '.join(atoms))
+
+        out.append('')
+        for i in range(p['predicates']):
+            if self.arities[i] < 2 or rnd.random() >= p['property_density']:
+                continue
+            prop = rnd.choice(PROPERTIES_BINARY)
+            out.append('property %s/%d { %s:1:2 }' % (self.name(i), self.arities[i], prop))
+
+        return out
+
+    ## Returns lines of observations.
+    def problems(self):
+        p, rnd = self.params, self.random
+        out = ['# Generated by benchgen.py with %s' % self.describe(), '']
+        observable = self.layers[0]
+
+        for n in range(p['problems']):
+            preds = [rnd.choice(observable) for i in range(p['observations'])]
+
+            # THE NUMBER OF ARGUMENTS IS DETERMINED SO THAT
+            # EACH ARGUMENT IS SHARED BY `cluster_size` ATOMS ON AVERAGE.
+            num_slots = sum(self.arities[i] for i in preds)
+            num_args = max(1, int(round(num_slots / float(p['cluster_size']))))
+            args = [('X%d' % k if rnd.random() < 0.5 else 'x%d' % k) for k in range(num_args)]
+
+            atoms = []
+            for i in preds:
+                atoms.append(self.atom(i, [rnd.choice(args) for k in range(self.arities[i])]))
+
+            out.append('problem q%d {' % n)
+            out.append('    observe { %s }' % ' ^ '.join(atoms))
+            out.append('}')
+
+        return out
+
+    def describe(self):
+        return ', '.join('%s=%s' % (k, self.params[k]) for k in sorted(self.params))
+
+
+## Writes a knowledge-base and observations to given paths.
+def generate(kb_path, obs_path, **kwargs):
+    gen = Generator(**kwargs)
+
+    with open(kb_path, 'w') as fout:
+        fout.write('\n'.join(gen.kb()) + '\n')
+    with open(obs_path, 'w') as fout:
+        fout.write('\n'.join(gen.problems()) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generates a synthetic knowledge-base and observations deterministically.')
+    parser.add_argument('kb', help='path of the knowledge-base to write')
+    parser.add_argument('obs', help='path of the observations to write')
+
+    for k, v in sorted(DEFAULTS.items()):
+        parser.add_argument('--' + k.replace('_', '-'), type=type(v), default=v, dest=k)
+
+    args = vars(parser.parse_args())
+    kb, obs = args.pop('kb'), args.pop('obs')
+    generate(kb, obs, **args)
+
+
+if __name__ == '__main__':
+    main()
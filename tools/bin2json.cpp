@@ -0,0 +1,39 @@
+/* Converts a binary output of David (-o bin:PATH) into JSON for debugging.
+ *
+ * USAGE:
+ *   $ make bin2json
+ *   $ bin/bin2json [INPUT] > OUTPUT.json
+ *
+ * If INPUT is omitted, the binary is read from stdin. */
+
+#include "../src/bin.h"
+#include "../src/json.h"
+
+
+int main(int argc, char* argv[])
+{
+    using namespace dav;
+
+    try
+    {
+        std::ifstream fin;
+        if (argc > 1)
+        {
+            fin.open(argv[1], std::ios::in | std::ios::binary);
+            if (fin.fail())
+                throw exception_t(format("cannot open \"%s\"", argv[1]));
+        }
+
+        bin::reader_t reader(fin.is_open() ? &fin : &std::cin);
+        json::file_stream_t out("-");
+        bin::convert_to_json(&reader, &out);
+        out << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "bin2json: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,397 @@
+/* Microbenchmarks of primitives of first-order logic, which are hot in inference.
+ *
+ * USAGE:
+ *   $ make microbench
+ *   $ bin/microbench [SECONDS-PER-BENCHMARK] [FILTER] [MAX-THREADS]
+ *
+ * Each benchmark runs a primitive over inputs generated with a fixed seed,
+ * whose distribution resembles KBs and proof-graphs (small arities, short conjunctions,
+ * and terms shared among atoms), and reports nanoseconds and heap allocations per operation.
+ * Benchmarks named "distribution" report how values of hash functions spread over buckets instead.
+ * The benchmark "johnson_t" reports circuits found per second on a fixed random graph
+ * with each number of threads from 1 to MAX-THREADS, which is the number of hardware threads on default.
+ * If FILTER is given, only benchmarks whose names contain it are run. */
+
+#include <new>
+#include <random>
+
+#include "../src/pg.h"
+#include "../src/cycle.h"
+
+
+namespace
+{
+/** The number of calls of operator new, which is counted to report allocations per operation. */
+size_t g_num_allocs = 0;
+
+/** Sink of results, which prevents the compiler from optimizing away benchmarks. */
+volatile size_t g_sink = 0;
+}
+
+
+void* operator new(size_t n)
+{
+    ++g_num_allocs;
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+
+namespace
+{
+using namespace dav;
+
+
+/** Generator of random inputs. */
+class inputs_t
+{
+public:
+    static const int NUM_PREDICATES = 200;
+    static const int NUM_TERMS = 50;
+
+    inputs_t() : m_rand(0)
+    {
+        for (int i = 0; i < NUM_PREDICATES; ++i)
+        {
+            arity_t arity = 1 + m_rand() % 3;
+            m_preds.push_back(predicate_t(format("p%d", i), arity).pid());
+        }
+
+        // A HALF OF TERMS ARE CONSTANTS, AND THE OTHERS ARE VARIABLES.
+        for (int i = 0; i < NUM_TERMS; ++i)
+            m_terms.push_back(term_t(format((i % 2) ? "x%d" : "C%d", i)));
+    }
+
+    term_t term() { return m_terms.at(m_rand() % m_terms.size()); }
+
+    atom_t atom(predicate_id_t pid)
+    {
+        std::vector<term_t> args;
+        for (arity_t i = 0; i < plib()->id2pred(pid).arity(); ++i)
+            args.push_back(term());
+        return atom_t(pid, args, false);
+    }
+
+    atom_t atom() { return atom(m_preds.at(m_rand() % m_preds.size())); }
+
+    /** Returns a conjunction of 1 ~ 4 atoms, like a side of a rule. */
+    conjunction_t conjunction()
+    {
+        conjunction_t out;
+        for (int n = 1 + m_rand() % 4; n > 0; --n)
+            out.push_back(atom());
+        out.sort();
+        return out;
+    }
+
+    /** Returns a conjunction with the same predicates as `c` but with other arguments. */
+    conjunction_t variant(const conjunction_t &c)
+    {
+        conjunction_t out;
+        for (const auto &a : c)
+            out.push_back(atom(a.pid()));
+        return out;
+    }
+
+    /** Returns a hypernode of 1 ~ 4 nodes, whose indices are small like those in a proof-graph. */
+    pg::hypernode_t hypernode()
+    {
+        pg::hypernode_t out;
+        for (int n = 1 + m_rand() % 4; n > 0; --n)
+            out.push_back(m_rand() % 1000);
+        return out;
+    }
+
+    /**
+     * Returns a directed graph made of `num_sccs` components of `size` vertices,
+     * each of which has a ring through all its vertices and `degree - 1` random edges per vertex.
+     * The components are strongly connected, and edges between them make no circuit.
+     */
+    std::unordered_map<pg::node_idx_t, std::unordered_map<pg::node_idx_t, pg::edge_idx_t>>
+        graph(int num_sccs, int size, int degree)
+    {
+        std::unordered_map<pg::node_idx_t, std::unordered_map<pg::node_idx_t, pg::edge_idx_t>> out;
+        pg::edge_idx_t e = 0;
+
+        for (int c = 0; c < num_sccs; ++c)
+        {
+            int base = c * size;
+            for (int v = 0; v < size; ++v)
+            {
+                out[base + v][base + (v + 1) % size] = e++;
+                for (int d = 1; d < degree; ++d)
+                    out[base + v][base + m_rand() % size] = e++;
+            }
+            if (c > 0)
+                out[base - size][base] = e++;
+        }
+        return out;
+    }
+
+    std::mt19937& rand() { return m_rand; }
+
+private:
+    std::mt19937 m_rand;
+    std::vector<predicate_id_t> m_preds;
+    std::vector<term_t> m_terms;
+};
+
+
+/** Runs `op(i)` repeatedly for `seconds` and prints the cost per call. */
+template <class Op> void run(const char *name, const char *filter, double seconds, size_t num_inputs, Op op)
+{
+    if (filter != nullptr and std::strstr(name, filter) == nullptr)
+        return;
+
+    typedef std::chrono::steady_clock clock_t;
+
+    // WARMING UP, WHICH ALSO FILLS CACHES OF STRINGS AND PREDICATES.
+    for (size_t i = 0; i < num_inputs; ++i)
+        op(i);
+
+    size_t num_ops(0), num_allocs(g_num_allocs);
+    auto begin = clock_t::now();
+    double elapsed(0.0);
+
+    while (elapsed < seconds)
+    {
+        for (size_t i = 0; i < num_inputs; ++i)
+            op(i);
+        num_ops += num_inputs;
+        elapsed = std::chrono::duration<double>(clock_t::now() - begin).count();
+    }
+    num_allocs = g_num_allocs - num_allocs;
+
+    std::printf("%-32s %12.1f ns/op %10.2f allocs/op %12zu ops\n",
+        name, elapsed * 1.0e9 / num_ops, static_cast<double>(num_allocs) / num_ops, num_ops);
+}
+
+
+/**
+ * Runs johnson_t::find_all_circuits() on `graph` repeatedly for `seconds`
+ * with each number of threads from 1 to `max_threads`, and prints circuits found per second.
+ */
+void johnson(
+    const char *filter, double seconds, int max_threads,
+    const std::unordered_map<pg::node_idx_t, std::unordered_map<pg::node_idx_t, pg::edge_idx_t>> &graph)
+{
+    if (filter != nullptr and std::strstr("johnson_t", filter) == nullptr)
+        return;
+
+    typedef std::chrono::steady_clock clock_t;
+    double base(0.0);
+
+    for (int n = 1; n <= max_threads; ++n)
+    {
+        cycle::johnson_t j;
+        j.set_multithread(n > 1);
+        j.set_thread_num(n);
+
+        size_t num_circuits(0), num_calls(0);
+        auto begin = clock_t::now();
+        double elapsed(0.0);
+
+        while (elapsed < seconds)
+        {
+            auto input = graph;
+            int max_circuits = -1;
+            std::unique_ptr<std::list<std::unordered_set<pg::node_idx_t>>> circuits(
+                j.find_all_circuits(input, &max_circuits));
+
+            num_circuits += circuits->size();
+            ++num_calls;
+            elapsed = std::chrono::duration<double>(clock_t::now() - begin).count();
+        }
+
+        double rate = num_circuits / elapsed;
+        if (n == 1) base = rate;
+
+        std::printf("%-32s %12.1f circuits/sec %6.2fx %4d threads %8zu calls\n",
+            format("johnson_t(threads=%d)", n).c_str(), rate, rate / base, n, num_calls);
+    }
+}
+
+
+/**
+ * Prints the number of collisions among hash values of distinct elements in `xs`
+ * and chi-squared per degree of freedom of the numbers of elements in buckets,
+ * where buckets are chosen by modulo of a prime as in libstdc++ and by lower bits.
+ * Chi-squared per degree of freedom is around 1.0 if hash values are uniform.
+ */
+template <class T> void distribution(const char *name, const char *filter, const std::vector<T> &xs)
+{
+    if (filter != nullptr and std::strstr(name, filter) == nullptr)
+        return;
+
+    const size_t PRIME = 1021, MASK = 1023;
+    std::unordered_set<T> values(xs.begin(), xs.end());
+    std::unordered_set<size_t> hashes;
+    std::vector<size_t> by_prime(PRIME, 0), by_mask(MASK + 1, 0);
+
+    for (const auto &x : values)
+    {
+        size_t h = std::hash<T>()(x);
+        hashes.insert(h);
+        ++by_prime[h % PRIME];
+        ++by_mask[h & MASK];
+    }
+
+    auto chi2 = [&](const std::vector<size_t> &buckets)
+    {
+        double expected = static_cast<double>(values.size()) / buckets.size(), out(0.0);
+        for (auto n : buckets)
+            out += (n - expected) * (n - expected) / expected;
+        return out / (buckets.size() - 1);
+    };
+
+    std::printf("%-32s %12zu values %8zu collisions %8.3f chi2/df (prime) %8.3f chi2/df (bits)\n",
+        name, values.size(), values.size() - hashes.size(), chi2(by_prime), chi2(by_mask));
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t N = 4096;
+    double seconds = (argc > 1) ? std::atof(argv[1]) : 0.5;
+    const char *filter = (argc > 2) ? argv[2] : nullptr;
+    int max_threads = (argc > 3) ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+
+    try
+    {
+        predicate_library_t::initialize("");
+        inputs_t in;
+
+        std::vector<term_t> terms1, terms2;
+        std::vector<atom_t> atoms1, atoms2;
+        std::vector<conjunction_t> conjs, evds;
+        std::vector<conjunction_template_t> tmpls1, tmpls2;
+        std::vector<pg::hypernode_t> hns;
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            terms1.push_back(in.term());
+            terms2.push_back(in.term());
+
+            atoms1.push_back(in.atom());
+            atoms2.push_back((in.rand()() % 2) ? in.atom(atoms1.back().pid()) : in.atom());
+
+            conjs.push_back(in.conjunction());
+            evds.push_back(in.variant(conjs.back()));
+
+            tmpls1.push_back(conjunction_template_t(conjs.back()));
+            hns.push_back(in.hypernode());
+        }
+        for (size_t i = 0; i < N; ++i)
+            tmpls2.push_back((i % 2) ? tmpls1.at(i) : tmpls1.at((i * 7 + 1) % N));
+
+        // TERM-CLUSTER OF UNIFICATIONS IN A PROOF-GRAPH.
+        term_cluster_t tc;
+        for (int i = 0; i < inputs_t::NUM_TERMS / 2; ++i)
+        {
+            term_t t1(in.term()), t2(in.term());
+            if (t1.is_unifiable_with(t2))
+                tc.add(t1, t2);
+        }
+
+        conjunction_t out;
+
+        run("unify_terms", filter, seconds, N, [&](size_t i)
+        {
+            out.clear();
+            g_sink += unify_terms(terms1[i], terms2[i], &out);
+        });
+
+        run("unify_atoms", filter, seconds, N, [&](size_t i)
+        {
+            out.clear();
+            if (atoms1[i].pid() == atoms2[i].pid())
+                g_sink += unify_atoms(atoms1[i], atoms2[i], &out);
+        });
+
+        run("term_cluster_t::unify_atoms", filter, seconds, N, [&](size_t i)
+        {
+            out.clear();
+            if (atoms1[i].pid() == atoms2[i].pid())
+                g_sink += tc.unify_atoms(atoms1[i], atoms2[i], &out);
+        });
+
+        run("term_cluster_t::substitute", filter, seconds, N, [&](size_t i)
+        {
+            g_sink += tc.substitute(atoms1[i]).terms().size();
+        });
+
+        run("grounder_t", filter, seconds, N, [&](size_t i)
+        {
+            grounder_t g(evds[i], conjs[i]);
+            g_sink += g.good();
+        });
+
+        std::vector<grounder_t::layout_t> layouts;
+        for (const auto &c : conjs)
+            layouts.push_back(grounder_t::layout_t(c));
+
+        run("grounder_t(layout)", filter, seconds, N, [&](size_t i)
+        {
+            grounder_t g(evds[i], layouts[i]);
+            g_sink += g.good();
+        });
+
+        run("conjunction_template_t(conj)", filter, seconds, N, [&](size_t i)
+        {
+            conjunction_template_t t(conjs[i]);
+            g_sink += t.pids.size();
+        });
+
+        run("conjunction_template_t::cmp", filter, seconds, N, [&](size_t i)
+        {
+            g_sink += (tmpls1[i] < tmpls2[i]);
+        });
+
+        run("std::hash<atom_t>", filter, seconds, N, [&](size_t i)
+        {
+            g_sink += std::hash<atom_t>()(atoms1[i]);
+        });
+
+        run("std::hash<conjunction_t>", filter, seconds, N, [&](size_t i)
+        {
+            g_sink += std::hash<conjunction_t>()(conjs[i]);
+        });
+
+        run("std::hash<pg::hypernode_t>", filter, seconds, N, [&](size_t i)
+        {
+            g_sink += std::hash<pg::hypernode_t>()(hns[i]);
+        });
+
+        run("atom_t::cmp", filter, seconds, N, [&](size_t i)
+        {
+            g_sink += (atoms1[i] < atoms2[i]);
+        });
+
+        // ATOMS AND CONJUNCTIONS OF ALL INPUTS ARE USED, SO THAT THERE ARE ENOUGH DISTINCT VALUES.
+        std::vector<atom_t> atoms(atoms1);
+        atoms.insert(atoms.end(), atoms2.begin(), atoms2.end());
+        std::vector<conjunction_t> cs(conjs);
+        cs.insert(cs.end(), evds.begin(), evds.end());
+
+        distribution("distribution of atom_t", filter, atoms);
+        distribution("distribution of conjunction_t", filter, cs);
+        distribution("distribution of pg::hypernode_t", filter, hns);
+
+        // COMPONENTS ARE MORE THAN THREADS, SO THAT WORKS OF THE ENUMERATION CAN BE STOLEN.
+        johnson(filter, seconds, std::max(1, max_threads), in.graph(16, 12, 3));
+    }
+    catch (const exception_t &e)
+    {
+        std::cerr << "microbench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}